@@ -68,6 +68,11 @@ class QString;
 class ControlForm;
 class SteererMainWindow;
 class CommsThreadEvent;
+class TimelineEvent;
+class SessionRecorder;
+class SessionReader;
+class SessionReplayer;
+class MarshalArena;
 
 /** Holds information on an application that the steering client is
     attached to */
@@ -79,11 +84,14 @@ public:
 
   Application(QWidget *mParent, const char *, int aSimHandle,
 	      bool aIsLocal,
-	      QMutex *aMutex);
+	      QMutex *aMutex, bool aIsReplay = false);
   ~Application();
 
   void customEvent(QEvent *);
   void processNextMessage(CommsThreadEvent *aEvent);
+  /// Log the actions the comms thread has sent from this
+  /// application's steering timeline or rules
+  void processTimelineEvent(TimelineEvent *aEvent);
   /// Enable all the command buttons for this application
   void enableCmdButtons();
 
@@ -92,6 +100,24 @@ public:
   bool isLocal(){return mIsLocal;}
   /// Getter method for handle of application
   int  getHandle();
+  /// Getter method for the form holding this application's tables
+  ControlForm *getControlForm();
+  /// Getter method for the recorder of this session (NULL if the
+  /// session isn't being recorded)
+  SessionRecorder *getRecorder();
+  /// Getter method for the buffers used to pass data to and from the
+  /// steering library for this application
+  MarshalArena *getArena(){return mArena;}
+  /// Whether this is a replay of a recorded session rather than a
+  /// live application
+  bool isReplay(){return mIsReplay;}
+  /// Whether the application has detached or stopped (or been asked
+  /// to), i.e. won't be sending much more data
+  bool isFinished(){return mFinishedFlag;}
+  /// Start replaying a recorded session (takes over the reader)
+  /// @param aSpeed Multiple of real time to replay at, zero for as
+  /// fast as possible
+  void startReplay(SessionReader *aReader, double aSpeed);
   /// Set the string holding the current application status
   void setCurrentStatus(QString &msg);
   /// Get the string holding the current application status
@@ -117,14 +143,19 @@ public:
   void setIOTableVisible(bool flag);
   /** Toggle the visibility of the ChkTypes table */
   void setChkTableVisible(bool flag);
+  /** Set the most times per second the tables and plots are redrawn */
+  void setDisplayRefreshRate(int aRate);
 
 private:
   void detachFromApplication();
   void disableForDetach(const bool aUnRegister = true);
   void disableForDetachOnError();
+  void setFinished();
   /** Sends the single, supplied command to the application
       @returns REG_SUCCESS or REG_FAILURE */
   int  emitSingleCmd(int aCmdId);
+  /// Set up the buttons for a paused (or resumed) application
+  void showPaused(const bool aPaused);
 
 protected slots:
   void emitDetachCmdSlot();
@@ -136,6 +167,9 @@ protected slots:
 
 signals:
   void closeApplicationSignal(int aSimHandle);
+  /// Emitted once, when the application detaches or stops (or the
+  /// user asks it to)
+  void finishedSignal(Application *aApp);
 
 
 private:
@@ -149,12 +183,22 @@ private:
   bool		mPauseSupported;
   bool		mResumeSupported;
   bool		mDetachedFlag;
+  /// Set when finishedSignal is emitted
+  bool		mFinishedFlag;
   /** Whether application is local or remote */
   bool          mIsLocal;
   QString       mStatusTxt;
   ControlForm	*mControlForm;
   Q3GroupBox	*mControlBox;
   SteererMainWindow *mSteerer;
+  /// Records status data and commands, if recording is switched on
+  SessionRecorder *mRecorder;
+  /// Whether this is a replay of a recorded session
+  bool          mIsReplay;
+  /// Drives the replay, if this is one
+  SessionReplayer *mReplayer;
+  /// Reusable buffers for calls to the steering library
+  MarshalArena  *mArena;
 
   bool mChkTableVisible;
   bool mIOTableVisible;
@@ -0,0 +1,106 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file broadcastform.h
+    @brief Header file for the BroadcastForm class */
+
+#ifndef __BROADCAST_FORM_H__
+#define __BROADCAST_FORM_H__
+
+#include <qdialog.h>
+#include <qstringlist.h>
+
+#include "parameter.h"
+
+class Q3ListBox;
+class QComboBox;
+class QLineEdit;
+class QTextEdit;
+class QPushButton;
+
+/// Dialog for choosing a set of values for steered parameters (a
+/// preset) and the attached applications to send them all to
+class BroadcastForm: public QDialog
+{
+  Q_OBJECT
+
+public:
+  /// @param aAppNames Names of the applications that can be steered
+  /// @param aLabels Labels of their steered parameters
+  BroadcastForm(const QStringList &aAppNames, const QStringList &aLabels,
+		QWidget *parent = 0, const char *name = "broadcastform",
+		bool modal = TRUE, Qt::WFlags f = 0 );
+  ~BroadcastForm();
+
+  /// Indices (into aAppNames) of the applications chosen
+  QList<int> getSelectedApps() const;
+  /// The values to send
+  const ParameterPreset &getPreset() const;
+
+protected slots:
+  /// Add the label and value chosen to the preset
+  void addValueSlot();
+  /// Replace the preset with one read from file
+  void loadPresetSlot();
+  void broadcastSlot();
+
+private:
+  /// Parse lines of "<label> <value>" into mPreset
+  /// @return The first bad line, or null if there are none
+  QString parsePreset(const QString &aText);
+
+  Q3ListBox	*mAppListBox;
+  QComboBox	*mLabelCombo;
+  QLineEdit	*mValueEdit;
+  QTextEdit	*mPresetEdit;
+  QPushButton	*mAddButton;
+  QPushButton	*mLoadButton;
+  QPushButton	*mBroadcastButton;
+  QPushButton	*mCancelButton;
+
+  ParameterPreset mPreset;
+};
+
+#endif
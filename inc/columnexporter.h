@@ -0,0 +1,162 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file columnexporter.h
+    @brief Header file for the ColumnExporter class */
+
+#ifndef __COLUMN_EXPORTER_H__
+#define __COLUMN_EXPORTER_H__
+
+#include <qlist.h>
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qvector.h>
+
+class QIODevice;
+
+/// Writes columns of doubles to a file, either as text (one row per
+/// line) or in a raw binary columnar format.  Data are streamed out
+/// in fixed-size chunks so nothing the size of the file is ever held
+/// in memory.
+///
+/// The binary format is an ASCII header, padded with spaces to a
+/// multiple of 8 bytes:
+/// <pre>
+/// RGSTEER-COLUMNS 1
+/// endian little
+/// type float64
+/// rows N
+/// columns M
+/// column <label of column 0>
+/// ...
+/// column <label of column M-1>
+/// end
+/// </pre>
+/// followed by M columns, one after the other, of N little-endian
+/// IEEE doubles each.
+///
+/// The compressed binary format has two more lines in its header,
+/// "compression zlib" and "chunkrows K", after "columns M".  Each
+/// column is split into chunks of K rows that are compressed with
+/// qCompress() and padded to 8 bytes, all the chunks of column 0 coming
+/// first.  After the data comes an index with an entry for each chunk
+/// of rows: float64 first and last values in column 0 (usually the
+/// sequence number) and then, for each column, int64 offset and int64
+/// size of the compressed data.  The file ends with "CHUNKIDX" and the
+/// int64 offset of the index, so a reader can decompress just the
+/// chunks it needs.
+///
+/// A column need not have a value in every row of a block - any it
+/// lacks are written as NaN ("nan" in text files).
+class ColumnExporter
+{
+public:
+  enum Format {kTEXT_FORMAT, kBINARY_FORMAT, kCOMPRESSED_FORMAT};
+
+  ColumnExporter();
+  virtual ~ColumnExporter();
+
+  /// Set the comment written at the top of text files
+  void setComment(const QString &aComment);
+  /// Set the labels of the columns
+  void setLabels(const QStringList &aLabels);
+  /// Append rows to the columns
+  /// @param aColumns Pointer to the data of each column, in the same
+  ///   order as the labels
+  /// @param aNumRows Number of rows available from every column
+  void addBlock(const QVector<const double *> &aColumns, int aNumRows);
+  /// Append rows to the columns where column j only has values for
+  /// aLengths[j] rows starting at row aFirstRows[j] of the block (so
+  /// aColumns[j][0] is the value in row aFirstRows[j]).
+  void addBlock(const QVector<const double *> &aColumns, int aNumRows,
+		const QVector<int> &aFirstRows, const QVector<int> &aLengths);
+  /// Total number of rows to be written
+  qint64 numRows() const;
+
+  /// Write everything to the device
+  /// @returns false on error or if the export was cancelled
+  bool write(QIODevice *aDevice, Format aFormat);
+
+  /// Work out which format is wanted from a file's name
+  static Format formatForFile(const QString &aFileName);
+
+protected:
+  /// Called after each chunk has been written
+  /// @param aDone Number of values written so far
+  /// @param aTotal Number of values to write
+  /// @returns false to abandon the export
+  virtual bool reportProgress(qint64 aDone, qint64 aTotal);
+
+private:
+  bool writeText(QIODevice *aDevice);
+  bool writeBinary(QIODevice *aDevice);
+  bool writeCompressed(QIODevice *aDevice);
+  /// Header of the binary formats (padded to 8 bytes)
+  QByteArray binaryHeader(bool aCompressed, int aChunkRows) const;
+
+  /// A run of rows that are contiguous in memory for every column
+  struct Block
+  {
+    QVector<const double *> mColumns;
+    int mNumRows;
+    /// First row of the block each column has a value for
+    QVector<int> mFirstRows;
+    /// Number of rows each column has values for
+    QVector<int> mLengths;
+  };
+  /// Copy rows [aRow, aRow+aNum) of column aCol of a block into aDest,
+  /// filling any gaps with NaN
+  static void gather(const Block &aBlock, int aCol, int aRow, int aNum,
+		     double *aDest);
+  /// As gather() but for rows [aRow, aRow+aNum) of the whole export
+  void gatherRows(int aCol, qint64 aRow, int aNum, double *aDest) const;
+
+  QString     mComment;
+  QStringList mLabels;
+  QList<Block> mBlocks;
+  qint64      mNumRows;
+};
+
+#endif
@@ -56,8 +56,13 @@
 //Added by qt3to4:
 #include <QCustomEvent>
 #include <QMutex>
+#include <qhash.h>
+#include <qstringlist.h>
 
 class SteererMainWindow;
+class SteeringTimeline;
+class SteeringRules;
+class Application;
 
 class CommsThread : public QThread
 {
@@ -71,12 +76,30 @@ public:
     bool getUseAutoPollFlag() const;
     void stop();
     void handleSignal();
+    /// Run aTimeline for the application with handle aSimHandle,
+    /// deleting any timeline it had.  The thread owns aTimeline; a
+    /// null one just removes the old timeline.
+    void setTimeline(int aSimHandle, SteeringTimeline *aTimeline);
+    /// The state of the application's timeline (null if it has none)
+    QString describeTimeline(int aSimHandle);
+    /// Apply aRules to the application with handle aSimHandle,
+    /// deleting any rules it had.  The thread owns aRules; null just
+    /// removes the old rules.
+    void setRules(int aSimHandle, SteeringRules *aRules);
+    /// The state of the application's rules (null if it has none)
+    QString describeRules(int aSimHandle);
 
 protected:
     virtual void run();
 
 private:
     void setKeepRunning(const bool aFlag);
+    /// Send whatever's due in the application's timeline now that
+    /// it's reached sequence number aSeqNum
+    void runTimeline(int aSimHandle, int aSeqNum, Application *aApp);
+    /// Apply the application's rules to the status message with
+    /// sequence number aSeqNum
+    void runRules(int aSimHandle, int aSeqNum, Application *aApp);
 
 private:
     SteererMainWindow	*mSteerer;
@@ -90,6 +113,13 @@ private:
     int                 mPollAdjustInterval;
     int                 mMinPollAdjustInterval;
     QMutex             *mMutexPtr;
+    /// Steering timelines, by sim handle
+    QHash<int, SteeringTimeline*> mTimelines;
+    /// Steering rules, by sim handle
+    QHash<int, SteeringRules*> mRules;
+    /// Protects mTimelines and mRules (and what they hold) from the
+    /// GUI thread
+    QMutex              mAutoSteerMutex;
 };
 
 
@@ -104,6 +134,10 @@ public:
   void storeCommands(int aNum, int *aArray);
   int  getNumCmds() const;
   int *getCmdsPtr();
+  /** Store the sequence number of the status message that
+      generated this event */
+  void setSeqNum(int aSeqNum);
+  int  getSeqNum() const;
 
 private:
   /** The type of the message that generated this event */
@@ -114,6 +148,30 @@ private:
   /** Array holding the commands in the control message that generated
       this event */
   int mCommands[REG_MAX_NUM_STR_CMDS];
+  /** The application's sequence number when it sent the status
+      message that generated this event (-1 if not a status message) */
+  int mSeqNum;
+
+};
+
+/// Posted to an Application when the comms thread has steered it on
+/// its own, from a steering timeline or steering rules
+class TimelineEvent : public QCustomEvent
+{
+
+public:
+  TimelineEvent();
+  ~TimelineEvent();
+
+  /** A line per action sent (or rule that couldn't be applied), with
+      the sequence number it was sent at */
+  QStringList &log();
+  /** The REG_STR_* commands that were sent */
+  QList<int> &commands();
+
+private:
+  QStringList mLog;
+  QList<int>  mCommands;
 
 };
 
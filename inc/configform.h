@@ -61,24 +61,31 @@ class ConfigForm: public QDialog
   Q_OBJECT
 
 public:
-  ConfigForm(int aCurrentIntervalValue, QWidget *parent = 0, const char *name = "configform",
+  ConfigForm(int aCurrentIntervalValue, int aCurrentRefreshRate,
+	     QWidget *parent = 0, const char *name = "configform",
 	     bool modal = TRUE, Qt::WFlags f = 0 );
   ~ConfigForm();
 
   int getIntervalValue() const;
+  /// The display refresh rate entered (refreshes per second, zero
+  /// for every status message)
+  int getRefreshRate() const;
 
 protected slots:
   void applySlot();
 
 private:
   int		mIntervalValue;
+  int		mRefreshRate;
 
   QLineEdit	*mLineEdit;
+  QLineEdit	*mRefreshLineEdit;
   QPushButton	*mApplyButton;
   QPushButton	*mCancelButton;
 
   float mMinVal_Sec;
   float mMaxVal_Sec;
+  int   mMaxRefreshRate;
 
 };
 
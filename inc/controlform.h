@@ -60,13 +60,19 @@
 #include <q3vbox.h>
 #include <qwidget.h>
 #include <qmutex.h>
+#include <qstringlist.h>
 //Added by qt3to4:
 #include <Q3HBoxLayout>
 #include <Q3PtrList>
 
 #include "historyplot.h"
+#include "parameter.h"
+#include "ReG_Steer_Steerside.h"
 
 class QPushButton;
+class QLineEdit;
+class QCheckBox;
+class QTimer;
 class QString;
 class Q3HBoxLayout;
 
@@ -77,6 +83,8 @@ class SteeredParameterTable;
 class IOTypeTable;
 class TableLabel;
 class SteererMainWindow;
+class ExportThread;
+class SteeringCommandBuilder;
 
 /// The widget that displays all information on a single application.
 /// We have one of these for each application being steered - they
@@ -99,6 +107,12 @@ public:
   void updateParameters(const bool isStatusMsg);
   /// Update the IOType or ChkTypes for this application
   void updateIOTypes(bool aChkPtType = false);
+  /// Update the parameter tables with values from a recorded session
+  /// as if they had arrived in a status message
+  void replayParameters(const Param_details_struct *aMonDetails,
+			const int aNumMon,
+			const Param_details_struct *aSteeredDetails,
+			const int aNumSteered);
   /// Called when application receives a parameter log message (i.e.
   /// log information for before the steering client attached)
   void updateParameterLog();
@@ -132,6 +146,39 @@ public:
   SteeredParameterTable *getSteeredParamTable();
   void newHistoryPlot(Parameter *xParamPtr, Parameter *yParamPtr,
 		      QString xLabel, QString yLabel);
+  /// Look up a monitored or steered parameter by its label
+  Parameter *findParameterFromLabel(const QString &aLabel);
+  /// Get the labels of all of the monitored and steered parameters
+  QStringList getParameterLabels();
+  /// Send the values of aPreset that this application's steered
+  /// parameters will take, in one Emit_control.  A line is appended
+  /// to aRejected for each value not sent.
+  /// @return The number of values sent, or -1 if sending failed (in
+  /// which case the application is detached)
+  int broadcastValues(const ParameterPreset &aPreset, QStringList &aRejected);
+  /// Write the histories of all of the parameters to file, a row per
+  /// sequence number, over a range of sequence numbers chosen by the
+  /// user
+  void exportParameters();
+
+  /// Set the most times per second that the tables and plots are
+  /// redrawn.  Values still arrive (and are logged) at the rate the
+  /// application sends them.
+  /// @param aRate Refreshes per second, or zero to redraw for every
+  /// status message
+  void setDisplayRefreshRate(int aRate);
+  /// Set whether this form is on show (i.e. on the current tab).
+  /// While it isn't, the tables are left alone - the parameters and
+  /// their histories are still updated - and they catch up in one go
+  /// when it's shown again.  Plots are separate windows so are
+  /// refreshed regardless.
+  void setDisplayActive(bool aActive);
+  /// Number of times the tables have been refreshed
+  int getRefreshCount() const {return mRefreshCount;}
+  /// Number of refreshes of the tables skipped while hidden
+  int getSkippedRefreshCount() const {return mSkippedRefreshCount;}
+  /// Total time (ms) spent refreshing the tables
+  int getRefreshMSecs() const {return mRefreshMSecs;}
 
   /// Method to show or hide the checkpoint table and associated label
   /// and buttons.
@@ -149,7 +196,15 @@ public:
 private:
   void updateParameters(const bool aSteeredFlag,
 			const bool isStatusMsg);
+  /// Update the steered or monitored parameter table with the given
+  /// parameter details
+  void applyParameters(const bool aSteeredFlag,
+		       const Param_details_struct *aParamDetails,
+		       const int aNumParams, const bool isStatusMsg);
   void disableButtons();
+  /// Note that the parameters have changed - the display is
+  /// refreshed now or at the next tick of mRefreshTimer
+  void parametersChanged(const bool isStatusMsg);
 
 protected slots:
   void enableParamButtonsSlot();
@@ -160,6 +215,12 @@ protected slots:
   void setCreateButtonStateSlot(const bool aEnable);
   void setConsumeButtonStateSlot(const bool aEnable);
   void setEmitButtonStateSlot(const bool aEnable);
+  /// Called when the export started by exportParameters() finishes
+  void exportFinishedSlot();
+  /// Show the changes to the parameters since the last refresh
+  void refreshDisplaySlot();
+  /// Apply the text in the filter box to the parameter tables
+  void filterChangedSlot();
 
 public slots:
   /// Slot called when the user quits a parameter history plot
@@ -214,8 +275,42 @@ private:
   /// Pointer to the label for the ParameterTable containing monitored params
   TableLabel            *mMonTableLabel;
 
+  /// Box for filtering the parameter tables by label
+  QLineEdit             *mFilterEdit;
+  /// Whether the filter is a regular expression (else a substring)
+  QCheckBox             *mFilterRegExpBox;
+
   /// Pointer to mutex protecting calls to ReG steer lib
   QMutex                *mMutexPtr;
+  /// Thread writing the file for exportParameters(), if any
+  ExportThread          *mExportThread;
+  /// Builds up what the tables send to the application so each
+  /// action goes out in one Emit_control
+  SteeringCommandBuilder *mCommandBuilder;
+
+  /// Clock for redrawing the parameter tables and plots - only
+  /// running if the refresh rate is limited
+  QTimer                *mRefreshTimer;
+  /// Whether the tables have changes that haven't been shown yet
+  bool                   mRefreshPending;
+  /// Whether the plots have yet to be told of the latest changes
+  bool                   mPlotsPending;
+  /// Whether there has been new data since the last refresh was
+  /// skipped, so that each batch is only counted as skipped once
+  bool                   mUnskippedData;
+  /// Whether this form is on show - see setDisplayActive()
+  bool                   mDisplayActive;
+  /// Whether the IOTypes (0) and ChkTypes (1) were changed while the
+  /// form was hidden
+  bool                   mIOTypesPending[2];
+  /// Display counters - see getRefreshCount() etc.
+  int                    mRefreshCount;
+  int                    mSkippedRefreshCount;
+  int                    mRefreshMSecs;
+  /// Number of status messages since the last refresh
+  int                    mSamplesSinceRefresh;
+  /// Number of messages shown in the table labels at the last refresh
+  int                    mSamplesShown;
 
 public:
   /// List of the history plots associated with this application
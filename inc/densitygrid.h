@@ -0,0 +1,115 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file densitygrid.h
+    @brief Header file for the DensityGrid class */
+
+#ifndef __DENSITY_GRID_H__
+#define __DENSITY_GRID_H__
+
+#include <qvector.h>
+#include <qwt_raster_data.h>
+#include <qwt_color_map.h>
+
+/// A fixed-size 2D histogram of (x, y) samples for drawing dense
+/// parameter-vs-parameter plots as a heatmap with a
+/// QwtPlotSpectrogram.  Samples are binned as they arrive.  When a
+/// sample falls outside the current extent the grid doubles in size
+/// along that axis by merging pairs of neighbouring bins, so counts
+/// are never re-binned approximately and the raw data needn't be
+/// revisited.  The cost of drawing depends only on the size of the
+/// grid.
+class DensityGrid : public QwtRasterData
+{
+public:
+  DensityGrid(int aNumBinsX = 256, int aNumBinsY = 256);
+  virtual ~DensityGrid();
+
+  /// Required by QwtRasterData - the bins are implicitly shared so
+  /// this is cheap until more samples are added
+  virtual QwtRasterData *copy() const;
+  /// Required by QwtRasterData - log10(1 + count) of the bin
+  /// containing (x, y)
+  virtual double value(double x, double y) const;
+  /// Required by QwtRasterData - the range of value()
+  virtual QwtDoubleInterval range() const;
+  /// The grid's own resolution is all that's worth rendering
+  virtual QSize rasterHint(const QwtDoubleRect &aRect) const;
+
+  /// Throw away all of the binned samples
+  void clear();
+  /// Bin aNum more samples
+  /// @param aX Pointer to the abscissae of the samples
+  /// @param aY Pointer to the ordinates of the samples
+  /// @param aNum Number of samples
+  void addPoints(const double *aX, const double *aY, int aNum);
+  /// Number of samples binned since the last clear()
+  int count() const;
+
+  /// The colour map used to draw density plots and their colour bars
+  static QwtLinearColorMap colourMap();
+
+private:
+  /// Double the extent along x (aAxis = 0) or y (aAxis = 1) towards
+  /// higher (aUp = true) or lower values, merging bins pairwise
+  void merge(int aAxis, bool aUp);
+  /// Grow the grid until it contains the given rectangle
+  void include(double aXMin, double aXMax, double aYMin, double aYMax);
+
+  int mNumBinsX;
+  int mNumBinsY;
+  /// Lower corner and bin widths of the grid
+  double mX0, mY0, mDx, mDy;
+  /// Whether or not the extent has been set from the first samples
+  bool mHaveExtent;
+  /// Counts, stored row (y) by row
+  QVector<unsigned int> mBins;
+  /// Largest count in any one bin
+  unsigned int mMaxCount;
+  /// Number of samples binned
+  int mNumPoints;
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file ensembleplot.h
+    @brief Header file for the EnsemblePlot class */
+
+#ifndef __ENSEMBLE_PLOT_H__
+#define __ENSEMBLE_PLOT_H__
+
+#include "q3frame.h"
+#include <Q3PtrList>
+#include <QCloseEvent>
+#include <qcolor.h>
+#include <qvector.h>
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+
+#include "ensemblestats.h"
+#include "sharedabscissa.h"
+
+class Application;
+class ParameterHistory;
+class QMenuBar;
+class Q3PopupMenu;
+
+/// One application's contribution to an EnsemblePlot
+struct EnsembleMember
+{
+  /// The application - only used to identify the member
+  Application *mApp;
+  /// History of the application's SEQUENCE_NUM
+  ParameterHistory *mSeqHist;
+  /// History of the parameter being plotted
+  ParameterHistory *mValHist;
+  /// How many samples have been passed on to the statistics
+  int mConsumed;
+  /// Curve showing this member's data
+  QwtPlotCurve *mCurve;
+  /// Decimation of this member's sequence numbers
+  SharedAbscissa mAbscissa;
+  /// Decimated data handed to mCurve
+  QVector<double> mX, mY;
+};
+
+/** Overlays one parameter (matched by label) from several
+ *  applications, aligned by sequence number, together with the
+ *  ensemble mean and a percentile band.
+ */
+class EnsemblePlot : public Q3Frame
+{
+  Q_OBJECT
+
+public:
+  /** Constructor
+   *  @param aLabel Label of the parameter being plotted
+   *  @param aNumMembers Number of applications that will be added
+   */
+  EnsemblePlot(const QString &aLabel, int aNumMembers);
+  ~EnsemblePlot();
+
+  /** Add an application to the ensemble - must be called no more than
+   *  the number of times given to the constructor
+   *  @param aApp The application
+   *  @param aName Name to show in the window
+   *  @param aSeqHist History of the application's SEQUENCE_NUM
+   *  @param aValHist History of the parameter being plotted */
+  void addMember(Application *aApp, const QString &aName,
+		 ParameterHistory *aSeqHist, ParameterHistory *aValHist);
+  /** Stop using an application's data (e.g. because it is being
+   *  closed).  What it has already contributed is kept. */
+  void removeApplication(Application *aApp);
+
+protected:
+  void closeEvent(QCloseEvent *e);
+
+public slots:
+  /// Slot signalled by the ControlForm of any member when it has new data
+  void updateSlot();
+  void fileQuit();
+  void toggleMembersSlot();
+  /// Slot signalled by a member that has detached or stopped - the
+  /// statistics stop waiting for it
+  void retireApplicationSlot(Application *aApp);
+
+protected slots:
+  /// Does the work for updateSlot once per batch of updates
+  void redrawSlot();
+
+signals:
+  void ensemblePlotClosedSignal(EnsemblePlot *ptr);
+
+private:
+  /// Pass any new samples from each member on to the statistics
+  void consumeSamples();
+
+  QMenuBar    *mMenuBar;
+  Q3PopupMenu *mFileMenu;
+  Q3PopupMenu *mGraphMenu;
+  int          mShowMembersId;
+  QwtPlot     *mPlotter;
+  /// Label of the parameter being plotted
+  QString      mLabel;
+  Q3PtrList<EnsembleMember> mMemberList;
+  EnsembleStats mStats;
+  /// Curves for the statistics
+  QwtPlotCurve *mMeanCurve;
+  QwtPlotCurve *mLowerCurve;
+  QwtPlotCurve *mUpperCurve;
+  /// Decimation of the statistics' sequence numbers
+  SharedAbscissa mStatsAbscissa;
+  QVector<double> mStatsX, mStatsY;
+  /// Whether or not to draw each member's curve as well as the bands
+  bool mShowMembers;
+  /// Whether a redraw has been scheduled
+  bool mRedrawPending;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file ensemblestats.h
+    @brief Header file for the EnsembleStats class */
+
+#ifndef __ENSEMBLE_STATS_H__
+#define __ENSEMBLE_STATS_H__
+
+#include <qmap.h>
+#include <qvector.h>
+
+/// Incrementally computes the mean and a pair of percentiles of one
+/// quantity across an ensemble of applications, step by step.
+/// Samples are held per sequence number until every member still
+/// reporting has moved past that step, or until the ensemble has
+/// reported a set number of later steps (so one member that has
+/// stalled doesn't hold up the rest); the step's statistics are then
+/// computed once and its samples thrown away, so the work done per
+/// update depends only on the number of new samples.
+class EnsembleStats
+{
+public:
+  /// @param aNumMembers Number of applications in the ensemble
+  /// @param aLowerPct Percentile for the lower edge of the band (0-100)
+  /// @param aUpperPct Percentile for the upper edge of the band (0-100)
+  /// @param aMaxLag Most steps held waiting for slow members - older
+  /// steps are finalised with whatever has been reported for them
+  EnsembleStats(int aNumMembers, double aLowerPct, double aUpperPct,
+		int aMaxLag);
+  ~EnsembleStats();
+
+  /// Record the value reported by member aMember at step aSeq.  Steps
+  /// must arrive in increasing order for any one member.
+  void addSample(int aMember, double aSeq, double aValue);
+  /// Stop waiting for a member that won't report any more
+  void retireMember(int aMember);
+  /// Compute the statistics for every step that all of the active
+  /// members that have reported anything have passed, and for any
+  /// step more than the maximum lag behind the latest
+  /// @returns the number of steps finalised
+  int finalise();
+
+  double lowerPercentile() const;
+  double upperPercentile() const;
+  /// Sequence numbers of the finalised steps
+  const QVector<double> &seq() const;
+  /// Mean of each finalised step
+  const QVector<double> &mean() const;
+  /// Lower percentile of each finalised step
+  const QVector<double> &lower() const;
+  /// Upper percentile of each finalised step
+  const QVector<double> &upper() const;
+
+private:
+  /// Work out the statistics of one step
+  void reduceStep(double aSeq, const QVector<double> &aValues);
+  /// The aPct'th percentile of the first aNum elements of aData
+  /// (which are reordered)
+  static double percentile(double *aData, int aNum, double aPct);
+
+  int    mNumMembers;
+  double mLowerPct;
+  double mUpperPct;
+  int    mMaxLag;
+  /// Values (NaN where missing) for the steps not yet finalised
+  QMap<double, QVector<double> > mPending;
+  /// Latest step reported by each member
+  QVector<double> mLatest;
+  /// Whether or not each member is still reporting
+  QVector<bool> mActive;
+  /// Last step to have been finalised
+  double mFinalisedSeq;
+  bool   mHaveFinalised;
+
+  QVector<double> mSeq;
+  QVector<double> mMean;
+  QVector<double> mLower;
+  QVector<double> mUpper;
+  /// Workspace for reduceStep
+  QVector<double> mScratch;
+};
+
+#endif
@@ -0,0 +1,124 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file exportthread.h
+    @brief Header file for the ExportThread class */
+
+#ifndef __EXPORT_THREAD_H__
+#define __EXPORT_THREAD_H__
+
+#include <qthread.h>
+#include <qlist.h>
+#include <qsize.h>
+#include <qstring.h>
+#include <QAtomicInt>
+
+class QWidget;
+
+#include "columnexporter.h"
+#include "plotrenderer.h"
+
+/// Writes a data file or an image of a plot on a worker thread so
+/// that the GUI (and the processing of messages from applications)
+/// carries on while it happens.  Everything to be written is copied
+/// when the job is set up so the live histories can carry on growing
+/// (and being realloc'd) in the meantime.
+class ExportThread : public QThread, public ColumnExporter
+{
+  Q_OBJECT
+
+public:
+  /// @param aFileName The file to write
+  ExportThread(const QString &aFileName);
+  ~ExportThread();
+
+  /// Copy aNumRows rows of each column to be written as data
+  void addBlockCopy(const QVector<const double *> &aColumns, int aNumRows);
+  /// Copy a block in which some columns lack values for some rows
+  /// @see ColumnExporter::addBlock
+  void addBlockCopy(const QVector<const double *> &aColumns, int aNumRows,
+		    const QVector<int> &aFirstRows,
+		    const QVector<int> &aLengths);
+  /// Write an image of a plot instead of data
+  void setImage(const PlotSnapshot &aSnapshot, const QSize &aSize);
+
+  /// Start the export along with a progress dialog (modal for
+  /// aParent's window only) that lets the user cancel it
+  void startWithProgress(QWidget *aParent, const QString &aLabel);
+
+  /// Whether the export completed successfully
+  bool succeeded() const;
+  /// Whether the export was cancelled
+  bool wasCancelled() const;
+  QString fileName() const;
+
+public slots:
+  /// Ask the export to stop as soon as possible - the partially
+  /// written file is removed
+  void cancel();
+
+signals:
+  /// Emitted (from the worker thread) as the export proceeds
+  void progressSignal(int aPercent);
+
+protected:
+  virtual void run();
+  virtual bool reportProgress(qint64 aDone, qint64 aTotal);
+
+private:
+  QString mFileName;
+  /// Copies of the data being written
+  QList<double *> mCopies;
+  /// Whether we're writing an image rather than data
+  bool mIsImage;
+  PlotSnapshot mSnapshot;
+  QSize mImageSize;
+  /// Set by cancel(), read by the worker thread
+  QAtomicInt mCancelled;
+  bool mSucceeded;
+  int mLastPercent;
+};
+
+#endif
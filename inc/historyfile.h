@@ -0,0 +1,158 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file historyfile.h
+    @brief Header file for the HistoryFile class */
+
+#ifndef __HISTORY_FILE_H__
+#define __HISTORY_FILE_H__
+
+#include <qfile.h>
+#include <qlist.h>
+#include <qmap.h>
+#include <qobject.h>
+#include <qstringlist.h>
+#include <qvector.h>
+
+class ParameterHistory;
+
+/// Gives HistoryPlot access to the columns of a binary export (see
+/// ColumnExporter) or of a recorded session (see SessionRecorder)
+/// without attaching to anything.  The file is memory mapped and only
+/// the header (or, for a session, the record headers) is read when it
+/// is opened; a column's data are only touched when it is plotted.
+/// Columns of an uncompressed export are used in place, all others
+/// are gathered from their chunks on first use - and only from the
+/// chunks covering the range of sequence numbers asked for.  Parent
+/// the HistoryFile to the plot(s) using its histories so that it lives
+/// as long as they do.
+class HistoryFile : public QObject
+{
+public:
+  HistoryFile(const QString &aFileName, QObject *aParent = 0);
+  ~HistoryFile();
+
+  /// Map the file and read its layout
+  /// @returns false if it can't be mapped or isn't a file we know
+  bool open();
+  QString fileName() const;
+  /// Description of any error from open()
+  QString errorString() const;
+  /// Whether the data are compressed (so that it's worth restricting
+  /// the range read with setSeqRange())
+  bool isCompressed() const;
+
+  /// Labels of the columns - for a session the first two are the
+  /// sequence number and time of each status message
+  const QStringList &labels() const;
+  /// Number of rows in the range selected
+  int numRows() const;
+
+  /// Range of sequence numbers (or values of the first column of an
+  /// export) in the file
+  void seqRange(double &aFirst, double &aLast) const;
+  /// Only read rows with sequence numbers in [aFirst, aLast].  Must
+  /// be called before any history() is asked for.
+  void setSeqRange(double aFirst, double aLast);
+
+  /// History holding the values of column aColumn (created on
+  /// first use and owned by this object)
+  ParameterHistory *history(int aColumn);
+
+private:
+  /// A run of rows stored together - a ROWS or ZROW record of a
+  /// session, a chunk of a compressed export or the whole of an
+  /// uncompressed one
+  struct Chunk
+  {
+    int mNumRows;
+    bool mCompressed;
+    /// Range of sequence numbers in the chunk
+    double mFirstSeq;
+    double mLastSeq;
+    /// Handle of the parameter in each column (sessions only)
+    QVector<int> mHandles;
+    /// Offset and (stored) size of each column of the chunk - for a
+    /// session the sequence numbers, times and then one per handle
+    QVector<qint64> mOffsets;
+    QVector<qint64> mSizes;
+    /// Rows of the chunk within the range selected
+    int mBegin;
+    int mEnd;
+  };
+
+  bool openColumns();
+  bool openSession();
+  bool readChunkIndex(int aNumCols, int aChunkRows);
+  /// Read one line of the header at mDataStart (and move past it)
+  QString headerLine();
+  /// Column of aChunk holding aColumn of the file, or -1 if none
+  int chunkColumn(const Chunk &aChunk, int aColumn) const;
+  /// Copy aNum values from row aRow of column aCol of aChunk
+  bool decode(const Chunk &aChunk, int aCol, int aRow, int aNum,
+	      double *aDest) const;
+  double *gatherColumn(int aColumn);
+
+  QFile   mFile;
+  uchar  *mMap;
+  qint64  mSize;
+  bool    mIsSession;
+  bool    mIsCompressed;
+  QString mError;
+
+  QStringList mLabels;
+  int     mNumRows;
+  /// Offset of the data (of an export) or first record (of a session)
+  qint64  mDataStart;
+  /// Handle of the parameter in each column of a session
+  QVector<int> mHandles;
+  QVector<Chunk> mChunks;
+
+  QVector<ParameterHistory *> mHistories;
+  /// Arrays we've had to fill (rather than use the mapping directly)
+  QList<double *> mBuffers;
+};
+
+#endif
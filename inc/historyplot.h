@@ -58,8 +58,6 @@
 #include "q3frame.h"
 #include "qmenubar.h"
 #include "q3filedialog.h"
-#include "qthread.h"
-#include "qpixmap.h"
 #include <qwt_plot.h>
 #include <qwt_plot_picker.h>
 //Added by qt3to4:
@@ -70,8 +68,14 @@
 
 #include "types.h"
 #include "historysubplot.h"
+#include "sharedabscissa.h"
+#include "plotrenderer.h"
 
 class ParameterHistory;
+class QwtLegend;
+class ExportThread;
+class HistoryFile;
+class QwtPlotItem;
 class QMenuBar;
 class Q3PopupMenu;
 
@@ -106,6 +110,24 @@ private:
     int    mShowSymbolsId;
     /// Hande of menu item for controlling whether lines are drawn
     int    mShowCurvesId;
+    /// Handle of menu item for switching to a density plot
+    int    mShowDensityId;
+    /// Handle of menu item for choosing follow mode
+    int    mFollowId;
+
+    /// The ways in which the plot can follow the latest data
+    enum FollowMode {kFOLLOW_OFF, kFOLLOW_STEPS, kFOLLOW_SECONDS};
+    /// Whether to show everything or only the latest data
+    FollowMode mFollowMode;
+    /// Number of steps or seconds of data to show in follow mode
+    double mFollowSpan;
+    /// Abscissa range of the follow-mode window when it is known in
+    /// advance (i.e. when following sequence numbers)
+    double mFollowXMin, mFollowXMax;
+    /// Times at which new data arrived...
+    QVector<double> mUpdateTimes;
+    /// ...and the number of samples logged as of each of those times
+    QVector<int> mUpdateCounts;
 
     /// Flag set when display options are changed by user - forces
     /// both curves to be redrawn.
@@ -117,13 +139,46 @@ private:
     /// Picker to handle plot selection when adding further curves
     QwtPicker *mPicker;
 
+    /// Thread writing a data file or image, if any
+    ExportThread *mExportThread;
+    /// File the data came from if this plot isn't of a live application
+    HistoryFile *mHistoryFile;
+    /// Start a (data or image) export running in the background
+    void startExport(ExportThread *aThread, const QString &aLabel);
+
+    /// Legend listing every curve - items are checkable so that
+    /// individual curves may be hidden
+    QwtLegend *mLegend;
+
+    /// Abscissa of the data logged before the steerer attached,
+    /// shared by all of the sub-plots
+    SharedAbscissa mHistAbscissa;
+    /// Abscissa of the data logged since the steerer attached,
+    /// shared by all of the sub-plots
+    SharedAbscissa mLiveAbscissa;
+
     /// Holds a list of the colours that QColor knows about
     QStringList mColourList;
-    /// Iterator so that each new curve is given a new colour
-    QStringList::Iterator mColourIter;
+    /// Index of the colour to give the next new curve
+    int mColourIndex;
 
     /// Wipe and (re)draw the graph
     void doPlot();
+    /// Pass the latest data on to all of the sub-plots
+    void updateCurves();
+    /// Note the time at which the latest data arrived
+    void recordUpdateTime();
+    /// Find the first sample before/after attaching that lies in
+    /// the follow-mode window
+    void followWindow(int &aHistStart, int &aLiveStart);
+    /// Set the automatic axes to fit the follow-mode window
+    void followAxes();
+    /// Reduce the data of every visible curve onto the current
+    /// abscissae, in parallel when there are several curves
+    void decimateCurves();
+    /// Return a colour for the next new curve - the named colours are
+    /// used first, after which colours are generated
+    QColor nextColour();
 
 protected:
     void closeEvent(QCloseEvent *e);
@@ -143,9 +198,16 @@ public slots:
     void autoXAxisSlot();
     void graphDisplaySymbolsSlot();
     void graphDisplayCurvesSlot();
+    void graphDisplayDensitySlot();
+    void followSlot();
+    /// Called when a background export has finished
+    void exportFinishedSlot();
+    void addFileCurveSlot();
     void toggleLogAxisXSlot();
     void toggleLogAxisYSlot();
     void canvasSelectedSlot(const Q3PointArray &);
+    /// Slot called when the user (un)checks a curve in the legend
+    void legendCheckedSlot(QwtPlotItem *aItem, bool aOn);
 
 signals:
     void plotClosedSignal(HistoryPlot *ptr);
@@ -175,47 +237,34 @@ public:
 		 const char *_lLabely,
 		 const int _yparamID);
 
+    /** Plot data from a file rather than a live application.  The
+     *  plot takes ownership of aFile and lets the user add curves
+     *  for any of its other columns.
+     *  @param aFile File that all of this plot's histories belong to */
+    void setHistoryFile(HistoryFile *aFile);
+
+    /** Take a copy of everything needed to draw this plot off-screen
+     *  @param aWidth Width (in pixels) that the data are to be
+     *    decimated for */
+    PlotSnapshot snapshot(int aWidth);
+
+    /** Ask the user for the size of image to export
+     *  @param aParent Parent for the dialog
+     *  @param aSize Holds the default size on entry and the chosen
+     *    size on return
+     *  @returns false if the user cancelled */
+    static bool getExportSize(QWidget *aParent, QSize &aSize);
+
     int    mToggleLogXId, mToggleLogYId;
     bool   mAutoYAxisSet, mAutoXAxisSet;
     /// Whether or not to display symbols on curve
     bool   mDisplaySymbolsSet;
     /// Whether or not to draw curve (as guide to eye)
     bool   mDisplayCurvesSet;
+    /// Whether to draw a density plot rather than individual points
+    bool   mDisplayDensitySet;
     bool   mUseLogXAxis, mUseLogYAxis;
 };
 
-/////////////////////////////////////////////////////////
-
-/** This class is necessary to give QT time to update the widget properly before
- *  taking a screenshot. Seemingly, standard calls to refresh() redraw() update()
- *  and the like only cause a refresh after all current events have been dealt with.
- *  Hence this class.
- */
-
-class ScreenGrabThread: public QThread
-{
-  private:
-    QWidget *mWidget;
-    QString mFileName;
-    QMenuBar *mMenuBar;
-  public:
-    ScreenGrabThread(QWidget *lWidget, QString &lFileName, QMenuBar *lMenuBar){
-      mWidget = lWidget;
-      mFileName = lFileName;
-      mMenuBar = lMenuBar;
-    }
-    virtual void run(){
-      wait(500);
-
-      // Grab the window contents rather than the widget
-      // since we seemingly can't force a refresh immediately - spawn a thread to do this
-      QPixmap lPixmap = QPixmap::grabWindow(mWidget->winId(), 0,
-					    mMenuBar->heightForWidth(mWidget->width()));
-      lPixmap.save(mFileName, "JPEG");
-    }
-};
-
-/////////////////////////////////////////////////////////
-
 
 #endif
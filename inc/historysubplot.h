@@ -50,11 +50,16 @@
 #define HISTORYSUBPLOT_H
 
 #include "qobject.h"
+#include "qcolor.h"
+#include "qvector.h"
 
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
+#include <qwt_plot_spectrogram.h>
 
 #include "parameterhistory.h"
+#include "sharedabscissa.h"
+#include "densitygrid.h"
 
 class HistoryPlot;
 
@@ -92,9 +97,29 @@ private:
     /// used to have
     int     mPreviousLogSize;
 
-    /// String holding the (QColor-recognised) name of the colour
-    /// of the pen for this curve
-    QString mColour;
+    /// The colour of the pen for this curve
+    QColor  mColour;
+
+    /// Whether the user has left this curve switched on in the legend
+    bool    mVisible;
+
+    /// Decimated copies of the data actually handed to Qwt
+    QVector<double> mHistX, mHistY;
+    QVector<double> mLiveX, mLiveY;
+
+    /// Whether we're drawn as a density (heatmap) rather than a curve
+    bool    mDensityMode;
+    /// 2D histogram of all of the (x, y) samples
+    DensityGrid mDensity;
+    /// Draws mDensity when in density mode
+    QwtPlotSpectrogram *mSpectrogram;
+    /// How many of the samples logged since we attached have been binned
+    int     mDensityLiveBinned;
+    /// Number of samples from before we attached that have been binned
+    int     mDensityHistBinned;
+
+    /// Attach mCurve to the plot if it isn't already
+    void attachCurve();
 
 public:
     HistorySubPlot(HistoryPlot *lHistPlot,
@@ -103,11 +128,30 @@ public:
 		   ParameterHistory *mYParamHist,
 		   const QString &lLabely,
 		   const int yparamID,
-		   const QString lColour);
+		   const QColor &lColour);
     ~HistorySubPlot();
 
+    /// Reduce this curve's data onto the shared abscissae.  Touches
+    /// nothing but our own buffers so may be run on a worker thread.
+    /// @param aHistStart Index of the first sample logged before
+    ///   attaching that aHistAbscissa covers
+    /// @param aLiveStart Index of the first sample logged since
+    ///   attaching that aLiveAbscissa covers
+    void decimate(const SharedAbscissa &aHistAbscissa, int aHistStart,
+		  const SharedAbscissa &aLiveAbscissa, int aLiveStart,
+		  bool lForceHistRedraw);
+    /// Get the extent of the data last handed to Qwt
+    /// @returns false if there is none
+    bool getDataRange(double &aXMin, double &aXMax,
+		      double &aYMin, double &aYMax) const;
     /// Wipe and (re)draw the graph
     void doPlot(bool lForceHistRedraw);
+    /// Bin any new samples and redraw the density plot
+    void doDensityPlot();
+    /// Switch between drawing curves and drawing a density plot
+    void setDensityMode(bool aOn);
+    /// The histogram drawn in density mode
+    const DensityGrid &density() const;
     /// Called by updateSlot in HistoryPlot
     void update();
     void filePrint();
@@ -122,6 +166,12 @@ public:
     void toggleLogAxisX();
     void toggleLogAxisY();
     QString getCurveLabel();
+    QColor getColour() const;
+    /// Show or hide both of this sub-plot's curves
+    void setVisible(bool aVisible);
+    bool isVisible() const;
+    /// Whether the given Qwt item is one of this sub-plot's curves
+    bool ownsCurve(const QwtPlotItem *aItem) const;
 
     /// Pointer to the array holding the array of logged values of
     /// the parameter being plotted
@@ -64,6 +64,9 @@ public:
   int getType() const;
   int getRowIndex() const;
   int getFrequency() const;
+  /// Frequency last reported by the application (and so shown)
+  int getCurrentFrequency() const;
+  void setCurrentFrequency(const int aFreq);
 
   int  getAndResetFrequency();
 
@@ -77,6 +80,7 @@ private:
   const int mType;
   int	mRowIndex;
   int	mNewFrequency;
+  int	mCurrentFrequency;
 
 };
 
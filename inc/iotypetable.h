@@ -56,6 +56,8 @@
 
 #include <qpoint.h>
 #include <qmutex.h>
+#include <qhash.h>
+#include <qvector.h>
 //Added by qt3to4:
 #include <Q3PtrList>
 
@@ -76,16 +78,24 @@ public:
 
   bool updateRow(const int lHandle, const int lVal);
   void addRow(const int lHandle, const char *lLabel, const int lVal, const int lType);
+  /// Update (or add) the rows for the aNum IOTypes described by the
+  /// arrays.  Does nothing at all if they're the same as last time.
+  void updateRows(const int aNum, const int *aHandles, char **aLabels,
+		  const int *aVals, const int *aTypes);
   int getNumIOTypes() const;
 
-  int getCommandRequestsCountNew();
-  int getCommandRequestsCountOfType(const int aType);
-  int populateCommandRequestArrayNew(int *aCmdArray, char **aCmdParamArray, const int aMaxCmds, const int aStartIndex);
-  int populateCommandRequestArrayOfType(int *aCmdArray, char **aCmdParamArray, const int aMaxCmds, const int aStartIndex, const int aType);
-  int setNewFreqValuesInLib();
+  /// Add a command to aBuilder for each selected row
+  int addCommandRequests(SteeringCommandBuilder *aBuilder);
+  /// Add a command to aBuilder for each selected row of type aType
+  int addCommandRequestsOfType(SteeringCommandBuilder *aBuilder,
+			       const int aType);
+  /// Add the new frequencies entered in the table to aBuilder,
+  /// returning how many were added.  Call clearNewValues once
+  /// they're sent.
+  int addNewFrequencies(SteeringCommandBuilder *aBuilder);
+  void clearNewValues();
 
 private:
-  void clearNewValues();
 
   int findIOTypeRowIndex(int aId);
   IOType *findIOType(int aId);
@@ -119,6 +129,11 @@ signals:
 
 private:
   Q3PtrList<IOType> mIOTypeList;
+  /// Index into mIOTypeList
+  QHash<int, IOType *> mIOTypeByHandle;
+  /// Handles and frequencies passed to the last updateRows()
+  QVector<int> mLastHandles;
+  QVector<int> mLastVals;
 
   bool	    mChkPtTypeFlag;
   int	    mRestartRowIndex;
@@ -0,0 +1,101 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file marshalarena.h
+    @brief Header file for the MarshalArena class */
+
+#ifndef __MARSHAL_ARENA_H__
+#define __MARSHAL_ARENA_H__
+
+#include <qvector.h>
+
+#include "ReG_Steer_Steerside.h"
+
+/// Reusable buffers for passing data to and from the steering
+/// library.  Each buffer only ever grows, so once an application's
+/// set of parameters and IOTypes has settled down nothing is
+/// allocated while its messages are handled.  There is one of these
+/// per Application, used from the GUI thread only (a SteeringTimeline
+/// and a SteeringRules each have their own for the comms thread).  A
+/// buffer is only
+/// valid until the next request for the same buffer, though asking
+/// for a bigger buffer keeps what was in it (so buffers can be filled
+/// an entry at a time - see SteeringCommandBuilder).
+class MarshalArena
+{
+public:
+  /// The integer buffers
+  enum IntBuffer {kHANDLES, kTYPES, kVALUES, kCOMMANDS, kPARAM_HANDLES,
+		  kIO_HANDLES, kIO_FREQS, kCHK_HANDLES, kCHK_FREQS,
+		  kNUM_INT_BUFFERS};
+  /// The string tables
+  enum StringBuffer {kLABELS, kCMD_PARAMS, kPARAM_VALUES,
+		     kNUM_STRING_BUFFERS};
+
+  MarshalArena();
+  ~MarshalArena();
+
+  /// Room for aCount parameter details, for Get_param_values
+  Param_details_struct *paramDetails(int aCount);
+  /// Room for aCount ints
+  int *ints(IntBuffer aBuffer, int aCount);
+  /// An array of aCount strings, each with room for aLength chars
+  /// (including the terminating null).  The strings keep their
+  /// contents unless aLength differs from the last request.
+  char **strings(StringBuffer aBuffer, int aCount,
+		 int aLength = REG_MAX_STRING_LENGTH + 1);
+
+private:
+  QVector<Param_details_struct> mParamDetails;
+  QVector<int>    mInts[kNUM_INT_BUFFERS];
+  /// Storage for the strings of each table
+  QVector<char>   mStringStore[kNUM_STRING_BUFFERS];
+  /// Pointers into mStringStore
+  QVector<char *> mStrings[kNUM_STRING_BUFFERS];
+  /// Length of the strings that mStrings was laid out for
+  int             mStringLength[kNUM_STRING_BUFFERS];
+};
+
+#endif
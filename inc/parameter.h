@@ -55,6 +55,9 @@
 #define __PARAMETER_H__
 
 #include <qstring.h>
+#include <qbytearray.h>
+#include <qlist.h>
+#include <qpair.h>
 
 #include "parameterhistory.h"
 
@@ -107,6 +110,25 @@ public:
   QString getMaxString();
   /// Return string containing the label of the parameter
   QString getLabel();
+  /// Whether aVal is of the right type and within the minimum
+  /// and maximum (if any) to be a new value of this parameter.
+  /// Throws a SteererException if the parameter's type is unknown.
+  bool isValidValue(const QString &aVal) const;
+  /// aVal brought within aMin and aMax, as held by getMinString()
+  /// and getMaxString() ("--" for no limit)
+  /// @param aClamped Set to whether aVal had to be changed
+  static double clampValue(double aVal, const QString &aMin,
+			   const QString &aMax, bool *aClamped = 0);
+  /// Store the value of the parameter (as received from the
+  /// steering library)
+  /// @returns false if it's the same as the value last stored
+  bool updateValue(const char *aVal);
+  /// Value last passed to updateValue()
+  const QByteArray &getValue() const;
+  /// New value entered by the user but not yet sent to the
+  /// application (steerable parameters only)
+  QString getNewValueString() const;
+  void setNewValueString(const QString &aVal);
   /// Pointer to the ParameterHistory object for this parameter
   ParameterHistory  *mParamHist;
   /// Whether or not the steering client has retrieved the full
@@ -134,7 +156,14 @@ private:
   QString mMaxStr;
   /// The label given this parameter by the application code
   QString mLabel;
+  /// Value last passed to updateValue()
+  QByteArray mValue;
+  /// New value entered by the user
+  QString mNewValue;
 };
 
 
+/// Values for a set of steered parameters, as (label, value) pairs
+typedef QList<QPair<QString, QString> > ParameterPreset;
+
 #endif
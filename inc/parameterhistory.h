@@ -51,6 +51,12 @@
 #ifndef __PARAMETERHISTORY_H__
 #define __PARAMETERHISTORY_H__
 
+/// Number of points kept for a sparkline
+#define kSPARKLINE_POINTS	64
+/// Most samples averaged into one point of a sparkline - beyond this
+/// the oldest points are dropped instead
+#define kMAX_SPARKLINE_STRIDE	64
+
 /// @brief Class providing storage and accessors for logged parameter data.
 /// Used by the history plotting code.
 /// @see HistoryPlot
@@ -63,7 +69,12 @@ class ParameterHistory {
     ParameterHistory();
     ~ParameterHistory();
     /// Store the supplied value in mParamHistArray (append)
-    void          updateParameter(const char* lVal);
+    /// @return Whether a point was added to the sparkline
+    bool          updateParameter(const char* lVal);
+    /// Copy the sparkline (oldest point first) into aPoints, which
+    /// must have room for kSPARKLINE_POINTS
+    /// @return The number of points copied
+    int           getSparkline(float *aPoints) const;
     /// Returns the value of the element at index in mParamHistArray
     const float   elementAt(int index);
     /// Returns mParamHistArray
@@ -85,6 +96,24 @@ class ParameterHistory {
     int     mArrayChunkSize;
     /// Array holding data that we've logged since being attached
     double *mParamHistArray;
+
+    /// Add a sample to the sparkline
+    bool    appendSparkline(double aVal);
+    /// Ring of the latest points of the sparkline, each the mean of
+    /// mSparkStride samples.  When it fills up pairs of points are
+    /// merged (doubling the stride) until the stride reaches
+    /// kMAX_SPARKLINE_STRIDE, so the line covers more and more of the
+    /// history in the same space.
+    float   mSpark[kSPARKLINE_POINTS];
+    /// Index in mSpark of the oldest point
+    int     mSparkStart;
+    /// Number of points in mSpark
+    int     mSparkCount;
+    /// Number of samples per point
+    int     mSparkStride;
+    /// Sum and number of the samples for the next point
+    double  mSparkSum;
+    int     mSparkPending;
 };
 
 #endif
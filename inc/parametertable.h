@@ -56,6 +56,12 @@
 
 #include "qpoint.h"
 #include "qmutex.h"
+#include "qstringlist.h"
+#include "qhash.h"
+#include "qset.h"
+#include "qvector.h"
+#include "qbitarray.h"
+#include "qregexp.h"
 //Added by qt3to4:
 #include <Q3PtrList>
 
@@ -99,6 +105,52 @@ public:
   /// Get a ptr to Parameter from its handle
   /// @param aId The handle of the parameter to look up
   Parameter *findParameter(int aId);
+  /// Lookup Parameter from its label - searches both the monitored
+  /// and steered parameters of the application
+  Parameter *findParameterFromLabel(const QString &aLabel);
+  /// Get the labels of all of the parameters in this table
+  QStringList getParameterLabels();
+  /// Start a batch of calls to updateRow() and addRow().  Only the
+  /// cells that change are repainted, once, by endUpdate().  Does
+  /// nothing if a batch is already open, so a batch may span several
+  /// status messages.
+  void beginUpdate();
+  /// Repaint whatever changed since beginUpdate()
+  void endUpdate();
+  /// Whether there's an open batch (i.e. changes not yet shown)
+  bool inUpdate() const {return mInBatch;}
+  /// Show only the parameters whose labels contain aPattern (case
+  /// insensitive), or match it if aRegExp.  Rows that are hidden
+  /// aren't repainted when their values change.
+  /// @return false (and the filter is left as it was) if aPattern
+  /// isn't a valid regular expression
+  bool setFilter(const QString &aPattern, bool aRegExp);
+  /// Show or hide the column of sparklines of each parameter's recent
+  /// history (if the table has one)
+  void setSparklinesShown(bool aShown);
+  /// Whether the column of sparklines is on show
+  bool sparklinesShown() const {return mSparklinesShown;}
+
+  /// @name Item-less storage
+  /// The table holds no Q3TableItems - the contents of each cell are
+  /// read from (and written to) the Parameter displayed in its row,
+  /// and only the cells that are visible are ever drawn.  See "Large
+  /// tables" in the Q3Table documentation.
+  //@{
+  virtual QString text(int aRow, int aCol) const;
+  virtual void setText(int aRow, int aCol, const QString &aText);
+  virtual Q3TableItem *item(int aRow, int aCol) const;
+  virtual void setItem(int aRow, int aCol, Q3TableItem *aItem);
+  virtual void takeItem(Q3TableItem *aItem);
+  virtual void clearCell(int aRow, int aCol);
+  virtual void insertWidget(int aRow, int aCol, QWidget *aWidget);
+  virtual QWidget *cellWidget(int aRow, int aCol) const;
+  virtual void clearCellWidget(int aRow, int aCol);
+  virtual void paintCell(QPainter *aPainter, int aRow, int aCol,
+			 const QRect &aRect, bool aSelected,
+			 const QColorGroup &aGroup);
+  virtual void adjustColumn(int aCol);
+  //@}
 
 public slots:
   /// Slot for the context menu in the parameter table
@@ -116,10 +168,55 @@ protected:
   int findParameterRowIndex(int aId);
   /// Reverse lookup of parameter ID
   Parameter *findParameterHandleFromRow(int row);
-  /// Lookup Parameter from its label
-  Parameter *findParameterFromLabel(const QString &aLabel);
+  /// Add a newly-created parameter to mParamList and the indices
+  void appendParameter(Parameter *aParam);
+  /// Text shown in the value column for a parameter
+  QString displayValue(Parameter *aParam) const;
+  /// Whether the (lower case) label passes the current filter
+  bool matchesFilter(const QString &aLowerLabel) const;
+  /// Whether the given row has been hidden by setFilter()
+  bool isFilteredOut(int aRow) const;
+  /// Draw a parameter's sparkline in the cell aRect
+  void paintSparkline(QPainter *aPainter, Parameter *aParam,
+		      const QRect &aRect, bool aSelected,
+		      const QColorGroup &aGroup);
+
+  virtual void resizeData(int aLen);
+  virtual QWidget *createEditor(int aRow, int aCol, bool aInitFromCell) const;
+  virtual void setCellContentFromEditor(int aRow, int aCol);
   /// List of the parameters associated with this application
   Q3PtrList<Parameter>   mParamList;
+  /// Indices into mParamList so that lookups while processing a
+  /// status message don't have to search the list
+  QHash<int, Parameter *>     mParamByHandle;
+  QHash<int, Parameter *>     mParamByRow;
+  QHash<QString, Parameter *> mParamByLabel;
+  /// Whether we're between beginUpdate() and endUpdate()
+  bool                  mInBatch;
+  /// Whether rows have been added during this batch
+  bool                  mRowsAdded;
+  /// Rows whose value has changed during this batch - a set since a
+  /// row can change many times in a batch that spans several messages
+  QSet<int>             mChangedRows;
+  /// Rows whose sparkline has changed during this batch
+  QSet<int>             mChangedSparkRows;
+  /// Column holding sparklines, -1 if the table hasn't one
+  int                   mSparklineColumn;
+  /// Whether mSparklineColumn is on show
+  bool                  mSparklinesShown;
+  /// Lower case label of the parameter in each row, for setFilter()
+  QVector<QString>      mFilterLabels;
+  /// The rows that match the current filter, in order
+  QVector<int>          mFilterMatches;
+  /// Rows hidden by the current filter
+  QBitArray             mFilteredOut;
+  /// The current filter (lower case if not a regular expression)
+  QString               mFilter;
+  bool                  mFilterIsRegExp;
+  QRegExp               mFilterRegExp;
+  /// Editors open on cells (keyed on row*numCols() + column) - there
+  /// is no more than one in practice
+  QHash<int, QWidget *> mCellWidgets;
   /// Pointer to table of monitored parameters
   ParameterTable       *mMonParamTable;
   /// Pointer to mutex used to control calls to steering library
@@ -147,7 +244,17 @@ public:
   ////  virtual bool updateRow no redefinition required
   virtual void addRow(const int lHandle, const char *lLabel, const char *lVal, const int lType, const char *lMinVal, const char *lMaxVal);
 
-  int setNewParamValuesInLib();
+  /// Add the new values entered in the table to aBuilder, returning
+  /// how many were added.  Call clearNewValues once they're sent.
+  int addNewParamValues(SteeringCommandBuilder *aBuilder);
+  /// Add the values of aPreset to aBuilder, each checked against
+  /// its parameter's type and range.  A line is appended to aRejected
+  /// for each label this application doesn't steer and each value it
+  /// won't take.  Returns how many values were added.  Throws a
+  /// SteererException for a parameter of unknown type.
+  int addPresetValues(const ParameterPreset &aPreset,
+		      SteeringCommandBuilder *aBuilder,
+		      QStringList &aRejected);
   void clearNewValues();
 
   // Method called by the event handler in order to determine
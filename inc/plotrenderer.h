@@ -0,0 +1,137 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file plotrenderer.h
+    @brief Header file for the PlotSnapshot and PlotRenderer classes */
+
+#ifndef __PLOT_RENDERER_H__
+#define __PLOT_RENDERER_H__
+
+#include <qcolor.h>
+#include <qlist.h>
+#include <qrect.h>
+#include <qsize.h>
+#include <qstring.h>
+#include <qvector.h>
+#include <qwt_scale_div.h>
+#include <qwt_scale_map.h>
+
+#include "densitygrid.h"
+
+class QPainter;
+
+/// A self-contained copy of everything needed to draw a HistoryPlot.
+/// Snapshots are taken on the GUI thread and hold no pointers back
+/// into the plot, so they may be rendered on any thread.
+class PlotSnapshot
+{
+public:
+  /// The (already decimated) data of one curve
+  struct Curve
+  {
+    QString mLabel;
+    QColor mColour;
+    /// Points logged before the steerer attached
+    QVector<double> mHistX, mHistY;
+    /// Points logged since the steerer attached
+    QVector<double> mLiveX, mLiveY;
+  };
+
+  PlotSnapshot();
+
+  /// Caption of the plot window
+  QString mTitle;
+  /// Title of the abscissa
+  QString mXLabel;
+  /// Scale maps and tick positions of the two axes as last drawn
+  QwtScaleMap mXMap, mYMap;
+  QwtScaleDiv mXDiv, mYDiv;
+  bool mShowSymbols;
+  bool mShowLines;
+  /// Every visible curve, in the order they're drawn
+  QList<Curve> mCurves;
+  /// Whether to draw mDensity rather than the curves
+  bool mShowDensity;
+  DensityGrid mDensity;
+};
+
+/// Draws PlotSnapshots with a plain QPainter.  Nothing here touches a
+/// widget so exports can be made at any size, off-screen and in
+/// parallel on worker threads.
+class PlotRenderer
+{
+public:
+  /// Draw the snapshot into aRect of the painter's device
+  static void render(const PlotSnapshot &aSnapshot, QPainter *aPainter,
+		     const QRect &aRect);
+  /// Draw the snapshot into a new file - SVG if aFileName ends in
+  /// ".svg", otherwise an image in the format implied by its suffix
+  /// @returns true on success
+  static bool renderToFile(const PlotSnapshot &aSnapshot,
+			   const QString &aFileName, const QSize &aSize);
+
+private:
+  static void drawCurve(QPainter *aPainter, const QwtScaleMap &aXMap,
+			const QwtScaleMap &aYMap, const QVector<double> &aX,
+			const QVector<double> &aY, int aSymbolSize,
+			bool aShowLines);
+  static void drawDensity(QPainter *aPainter, const PlotSnapshot &aSnapshot,
+			  const QwtScaleMap &aXMap, const QwtScaleMap &aYMap,
+			  const QRect &aCanvas);
+};
+
+/// One file to be written by PlotRenderer::renderToFile - used when
+/// exporting many plots at once
+struct PlotExportJob
+{
+  PlotSnapshot mSnapshot;
+  QString mFileName;
+  QSize mSize;
+};
+
+/// Render an export job, for use with QtConcurrent::mapped
+bool renderPlotExportJob(const PlotExportJob &aJob);
+
+#endif
@@ -0,0 +1,129 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sessionreader.h
+    @brief Header file for the SessionReader class */
+
+#ifndef __SESSION_READER_H__
+#define __SESSION_READER_H__
+
+#include <qbytearray.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qlist.h>
+#include <qstring.h>
+#include <qvector.h>
+
+/// Reads back a session log written by a SessionRecorder (see there
+/// for a description of the format), one chunk of rows at a time.
+class SessionReader
+{
+public:
+  /// Description of a recorded parameter
+  struct Param
+  {
+    int     mHandle;
+    int     mType;
+    bool    mSteerable;
+    QString mLabel;
+  };
+
+  /// A chunk of rows - one per status message
+  struct Chunk
+  {
+    int mNumRows;
+    /// Handle of the parameter in each column
+    QVector<int> mHandles;
+    QVector<double> mSeqNums;
+    QVector<double> mTimes;
+    /// Values of each parameter (NaN where missing)
+    QVector<QVector<double> > mColumns;
+  };
+
+  /// A command that was sent to the application
+  struct Command
+  {
+    /// Sequence number of the last status message before it was sent
+    double  mSeqNum;
+    double  mTime;
+    QString mText;
+  };
+
+  SessionReader(const QString &aFileName);
+  ~SessionReader();
+
+  /// Open the log and read its header
+  /// @returns false if the file can't be read or isn't a session log
+  bool open();
+  QString fileName() const;
+  /// Name of the application that was recorded
+  QString applicationName() const;
+
+  /// Read the next chunk of rows.  Parameter descriptions and commands
+  /// found on the way are added to parameters() and commands().
+  /// @returns false once there are no more (complete) chunks
+  bool nextChunk(Chunk &aChunk);
+  /// Go back to the first chunk
+  void rewind();
+
+  /// Every parameter seen so far, keyed on handle
+  const QHash<int, Param> &parameters() const;
+  /// Every command seen so far, in the order they were sent
+  const QList<Command> &commands() const;
+
+private:
+  bool readRecord(QByteArray &aTag, QByteArray &aPayload);
+  bool parseChunk(const QByteArray &aPayload, Chunk &aChunk);
+  bool parseCompressedChunk(const QByteArray &aPayload, Chunk &aChunk);
+
+  QFile   mFile;
+  QString mAppName;
+  /// Offset of the first record
+  qint64  mDataStart;
+  QHash<int, Param> mParams;
+  QList<Command> mCommands;
+};
+
+#endif
@@ -0,0 +1,188 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sessionrecorder.h
+    @brief Header file for the SessionRecorder class */
+
+#ifndef __SESSION_RECORDER_H__
+#define __SESSION_RECORDER_H__
+
+#include <qobject.h>
+#include <qfile.h>
+#include <qhash.h>
+#include <qstring.h>
+#include <qvector.h>
+#include <qlist.h>
+#include <qbytearray.h>
+#include <QFuture>
+
+class QTimer;
+
+/// Rows of status data are buffered and written out in chunks of
+/// (at most) this many rows
+#define kSESSION_CHUNK_ROWS 256
+
+/// Records every parameter value from every status message received
+/// from an application, along with the steering commands sent to it,
+/// in a chunked, columnar log file.
+///
+/// The file begins with an ASCII header, padded with spaces to a
+/// multiple of 8 bytes:
+/// <pre>
+/// RGSTEER-SESSION 1
+/// endian little
+/// application <name of application>
+/// end
+/// </pre>
+/// followed by a series of records.  Each starts with a four character
+/// tag and the (little-endian, 32-bit) length of the payload that
+/// follows, which is always a multiple of 8 bytes:
+/// - "PARM": int32 handle, int32 type, int32 steerable (0 or 1),
+///   label (padded with NULs)
+/// - "ROWS": int32 N, int32 M, M int32 handles (padded to 8 bytes),
+///   then N sequence numbers, N times (seconds since the epoch) and
+///   M columns of N values, all as doubles.  Missing values are NaN.
+/// - "ZROW": as ROWS but compressed - int32 N, int32 M, M int32
+///   handles, then 2+M int32 sizes (padded to 8 bytes), then the
+///   sequence numbers, times and M columns each compressed separately
+///   with qCompress() and padded to 8 bytes.  A reader can decompress
+///   just the columns it wants.
+/// - "CMND": float64 sequence number, float64 time, command text
+///   (padded with NULs)
+///
+/// A sparse index (one entry per ROWS record) is kept alongside in
+/// <file>.idx as triples of little-endian int64: first sequence
+/// number, last sequence number and the offset of the record in the
+/// log.  It allows the rows for any sequence number to be found
+/// without reading the whole log.
+///
+/// Data are only written when a chunk fills or on a timer, at which
+/// point the files are also synced to disk, so the cost per status
+/// message is little more than storing the values.  When compression
+/// is on, full chunks are compressed on a worker thread and written
+/// (in order) once done, so recording never waits for zlib.
+class SessionRecorder : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// @param aFileName The log to write (the index is aFileName.idx)
+  /// @param aAppName Name of the application being recorded
+  /// @param aSyncSecs How often to write out and sync buffered data
+  /// @param aCompression zlib level to compress chunks with (-1 for
+  ///   zlib's default), or 0 to write them uncompressed
+  SessionRecorder(const QString &aFileName, const QString &aAppName,
+		  int aSyncSecs, int aCompression = 0,
+		  QObject *aParent = 0);
+  ~SessionRecorder();
+
+  /// Whether the log was opened successfully
+  bool isOpen() const;
+  /// Name of the log file
+  QString fileName() const;
+
+  /// Start a row of data for a status message
+  void beginRow(int aSeqNum);
+  /// Record the value of a parameter in the current row.  Values
+  /// of parameters of type REG_CHAR are ignored.
+  void addValue(int aHandle, int aType, bool aSteerable,
+		const char *aLabel, const char *aValue);
+  /// Finish the current row
+  void endRow();
+  /// Record a command that was sent to the application
+  void recordCommand(const QString &aCommand);
+
+  /// Write out any buffered rows and sync the files to disk.  Chunks
+  /// still being compressed are left for the next flush.
+  void flush();
+
+public slots:
+  void syncSlot();
+
+private:
+  /// A record waiting to be written - records go out in order, so
+  /// anything behind a chunk that's being compressed waits for it
+  struct PendingRecord
+  {
+    QByteArray mTag;
+    QByteArray mPayload;
+    /// Whether mPayload is still being produced by mCompressed
+    bool       mCompressing;
+    QFuture<QByteArray> mCompressed;
+    /// Whether the record is a chunk of rows (and so is indexed)
+    bool       mIsChunk;
+    qint64     mFirstSeqNum;
+    qint64     mLastSeqNum;
+  };
+
+  void writeChunk();
+  void writeRecord(const char *aTag, const QByteArray &aPayload);
+  /// Write out the pending records
+  /// @param aWait Whether to wait for any still being compressed
+  void writePending(bool aWait);
+
+  QFile   mFile;
+  QFile   mIndexFile;
+  QTimer *mSyncTimer;
+  /// Whether anything has been written since the last sync
+  bool    mDirty;
+  /// zlib level, or 0 if chunks aren't compressed
+  int     mCompression;
+  QList<PendingRecord> mPending;
+
+  /// Column (in mColumns) holding the values of each handle
+  QHash<int, int> mColumnOfHandle;
+  QVector<int>    mHandles;
+  QVector<QVector<double> > mColumns;
+  QVector<double> mSeqNums;
+  QVector<double> mTimes;
+  /// Number of complete rows in the buffer
+  int     mNumRows;
+  bool    mRowOpen;
+  /// Sequence number of the most recent row
+  int     mLastSeqNum;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sessionreplayer.h
+    @brief Header file for the SessionReplayer class */
+
+#ifndef __SESSION_REPLAYER_H__
+#define __SESSION_REPLAYER_H__
+
+#include <qobject.h>
+#include <qdatetime.h>
+
+#include "sessionreader.h"
+#include "ReG_Steer_Steerside.h"
+
+class QTimer;
+class Application;
+class SteererMainWindow;
+
+/// Feeds the rows of a recorded session into an Application's
+/// ControlForm as if they were status messages arriving from a live
+/// application - so the tables and history plots behave exactly as
+/// they would have done at the time.
+///
+/// Rows may be replayed in real time, some multiple of it, or as fast
+/// as the GUI can take them (which gives a measure of how many status
+/// messages per second it can sustain).
+class SessionReplayer : public QObject
+{
+  Q_OBJECT
+
+public:
+  /// @param aReader An open reader, which the replayer takes over
+  /// @param aApp The Application to feed
+  /// @param aSpeed Multiple of real time to replay at - zero for as
+  ///   fast as possible
+  SessionReplayer(SessionReader *aReader, Application *aApp,
+		  SteererMainWindow *aSteerer, double aSpeed);
+  ~SessionReplayer();
+
+  void start();
+  /// Number of status messages replayed so far
+  int numReplayed() const;
+  /// Status messages replayed per second of wall-clock time
+  double rate() const;
+
+public slots:
+  void stop();
+
+private slots:
+  void nextRowSlot();
+
+private:
+  bool haveRow();
+  void replayRow();
+  void showCommands(double aSeqNum);
+  void reportProgress(bool aFinished);
+
+  SessionReader *mReader;
+  Application   *mApp;
+  SteererMainWindow *mSteerer;
+  double         mSpeed;
+  QTimer        *mTimer;
+
+  SessionReader::Chunk mChunk;
+  /// Next row of mChunk to replay
+  int            mRow;
+  /// Next of the reader's commands to show
+  int            mNextCommand;
+
+  /// Parameter details handed to the ControlForm
+  Param_details_struct *mMonDetails;
+  Param_details_struct *mSteeredDetails;
+  int            mDetailsSize;
+
+  QTime          mClock;
+  /// Recorded time of the first row replayed
+  double         mStartTime;
+  int            mNumReplayed;
+  /// When progress was last reported (ms on mClock)
+  int            mLastReport;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sharedabscissa.h
+    @brief Header file for the SharedAbscissa class */
+
+#ifndef __SHARED_ABSCISSA_H__
+#define __SHARED_ABSCISSA_H__
+
+#include <qvector.h>
+
+/// The abscissa shared by all of the curves on a single HistoryPlot.
+/// The x data are scanned once per redraw to split them into one
+/// bucket per pixel column of the canvas; each HistorySubPlot then
+/// reduces its own ordinate data into those buckets (keeping the
+/// first, last, minimum and maximum points of each) so the number of
+/// points handed to Qwt depends on the width of the plot rather than
+/// on the length of the history.
+class SharedAbscissa
+{
+public:
+  SharedAbscissa();
+  ~SharedAbscissa();
+
+  /// Forget everything learnt about previous data (e.g. when the
+  /// array has been replaced rather than appended to)
+  void reset();
+  /// Work out the bucket boundaries for the supplied abscissa data
+  /// @param aX Pointer to the abscissa data
+  /// @param aNum Number of points in aX
+  /// @param aNumBuckets Number of buckets to reduce the data into
+  void transform(const double *aX, int aNum, int aNumBuckets);
+
+  /// Reduce a curve's ordinate data onto the current buckets
+  /// @param aY Pointer to the ordinate data
+  /// @param aNum Number of points in aY
+  /// @param aOutX Receives the abscissae of the points to plot
+  /// @param aOutY Receives the ordinates of the points to plot
+  void reduce(const double *aY, int aNum,
+	      QVector<double> &aOutX, QVector<double> &aOutY) const;
+
+private:
+  /// The abscissa data as at the last transform
+  const double *mX;
+  /// Number of points in mX
+  int mNum;
+  /// Index of the first point in each bucket (plus one past the end)
+  QVector<int> mBucketStarts;
+  /// How far through the data the monotonicity check has got
+  int mCheckedUpTo;
+  /// Whether mX[0..mCheckedUpTo) is non-decreasing
+  bool mMonotonic;
+  /// Whether or not the last transform produced buckets - small or
+  /// non-monotonic (e.g. parameter vs. parameter) data are plotted as is
+  bool mDecimating;
+};
+
+#endif
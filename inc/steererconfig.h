@@ -83,6 +83,21 @@ class SteererConfig {
   bool mShowIOTypeTable;
   /** Whether or not to show the table of ChkTypes by default */
   bool mShowChkTypeTable;
+  /** Whether to show sparklines of the monitored parameters by default */
+  bool mShowSparklines;
+  /** Most times per second the tables and plots are redrawn (0 to
+      redraw for every status message) */
+  int mDisplayRefreshRate;
+  /** Whether to record every status message (and the commands sent)
+      from newly-attached applications */
+  bool mRecordSessions;
+  /** Directory in which session recordings are written */
+  QString mSessionDirectory;
+  /** How often (in seconds) recordings are written out and synced */
+  int mSessionSyncSecs;
+  /** zlib level recordings are compressed with (-1 for the default
+      level), or 0 for none */
+  int mSessionCompression;
 
   SteererConfig();
   ~SteererConfig();
@@ -58,6 +58,7 @@
 #include <QEvent>
 #include <QLabel>
 #include <Q3PtrList>
+#include <QFutureWatcher>
 
 class Q3Action;
 class QLabel;
@@ -72,6 +73,8 @@ class QStackedWidget;
 #include "steererconfig.h"
 
 class CommsThread;
+class EnsemblePlot;
+class HistoryPlot;
 
 class SteererMainWindow : public Q3MainWindow
 {
@@ -106,12 +109,42 @@ protected slots:
   void closeApplicationSlot(int aSimHandle);
   void configureSteererSlot();
   void toggleAutoPollSlot();
+  /// Switch recording of newly-attached applications on or off
+  void toggleRecordSessionsSlot();
+  /// Replay a recorded session as if it were a live application
+  void replaySessionSlot();
+  /// Plot the data in a binary export or recorded session
+  void openHistoryFileSlot();
+  /// Called when the user closes a plot opened from file
+  void filePlotClosedSlot(HistoryPlot *ptr);
   void tabChangedSlot(int index);
   void editTabTitleSlot();
   void hideChkPtTableSlot();
   void hideIOTableSlot();
   void hideSteerTableSlot();
   void hideMonTableSlot();
+  /// Show or hide the sparklines of the current application
+  void toggleSparklinesSlot();
+  /// Show how much redrawing has been done, and saved by not
+  /// redrawing the applications in hidden tabs
+  void displayStatisticsSlot();
+  /// Render every history plot of every application to file
+  void exportAllPlotsSlot();
+  /// Called once all of the plots have been exported
+  void exportAllPlotsDoneSlot();
+  /// Export every parameter of the current application
+  void exportApplicationSlot();
+  /// Plot a parameter from every application that has it
+  void ensemblePlotSlot();
+  /// Called when the user closes an ensemble plot
+  void ensemblePlotClosedSlot(EnsemblePlot *ptr);
+  /// Show, load or clear the steering timeline of the current
+  /// application
+  void steeringTimelineSlot();
+  /// Show, load or clear the rules steering the current application
+  void steeringRulesSlot();
+  /// Send the same steered parameter values to several applications
+  void broadcastSlot();
 
 public slots:
   void statusBarMessageSlot(Application *aApp, QString &message);
@@ -135,16 +168,37 @@ private:
   QMutex         mReGMutex;
   Q3Action	*mSetCheckIntervalAction;
   Q3Action	*mToggleAutoPollAction;
+  Q3Action       *mToggleRecordAction;
+  Q3Action       *mReplayAction;
+  Q3Action       *mOpenHistoryAction;
   Q3Action	*mAttachAction;
   Q3Action       *mSetTabTitleAction;
   Q3Action	*mQuitAction;
+  Q3Action       *mExportPlotsAction;
+  Q3Action       *mEnsemblePlotAction;
+  Q3Action       *mExportAppAction;
+  Q3Action       *mTimelineAction;
+  Q3Action       *mRulesAction;
+  Q3Action       *mBroadcastAction;
 
   Q3Action       *mHideChkPtTableAction;
   Q3Action       *mHideIOTableAction;
   Q3Action       *mHideSteerTableAction;
   Q3Action       *mHideMonTableAction;
+  Q3Action       *mToggleSparklinesAction;
+  Q3Action       *mDisplayStatsAction;
+
+  /// Handle given to the next replayed session - these are negative
+  /// so never clash with those from the steering library
+  int            mNextReplayHandle;
 
   Q3PtrList<Application> mAppList;
+  /// Plots of parameters across several applications
+  Q3PtrList<EnsemblePlot> mEnsemblePlotList;
+  /// Plots of data read from file rather than a live application
+  Q3PtrList<HistoryPlot> mFilePlotList;
+  /// Keeps track of plots being exported on worker threads
+  QFutureWatcher<bool> mExportWatcher;
   /// Holds the configuration information for the steering client
   SteererConfig *mSteererConfig;
 
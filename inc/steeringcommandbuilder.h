@@ -0,0 +1,110 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file steeringcommandbuilder.h
+    @brief Header file for the SteeringCommandBuilder class */
+
+#ifndef __STEERING_COMMAND_BUILDER_H__
+#define __STEERING_COMMAND_BUILDER_H__
+
+#include <qstring.h>
+#include <qstringlist.h>
+
+class QMutex;
+class MarshalArena;
+class SessionRecorder;
+
+/// Collects everything that one action in the GUI sends to an
+/// application - new parameter values, new IOType and ChkType
+/// frequencies and IOType commands - and sends it all with a single
+/// call to Emit_control.  The arrays passed to the steering library
+/// are held in the application's MarshalArena so nothing is
+/// allocated for them once they've grown big enough.  There is one of
+/// these per ControlForm, shared by its tables.
+class SteeringCommandBuilder
+{
+public:
+  SteeringCommandBuilder(int aSimHandle, QMutex *aMutex,
+			 MarshalArena *aArena);
+  ~SteeringCommandBuilder();
+
+  /// Set the recorder (if any) that everything sent is logged to
+  void setRecorder(SessionRecorder *aRecorder);
+
+  /// Forget everything added since the last send()
+  void reset();
+  /// Add a new value for a steerable parameter
+  void addParamValue(int aHandle, const QString &aLabel,
+		     const QString &aValue);
+  /// Add a new frequency for an IOType (or ChkType if aChkType)
+  void addFrequency(bool aChkType, int aHandle, int aFreq);
+  /// Add a command (an IOType or ChkType handle) and its parameter
+  void addCommand(int aCmdId, const char *aParam);
+  /// Number of values, frequencies and commands added
+  int count() const;
+
+  /// Set the new values and frequencies in the library and send them,
+  /// and the commands, to the application in one Emit_control.
+  /// Everything added is then forgotten, whether or not this succeeds.
+  /// Throws a SteererException if the library fails.
+  void send();
+
+private:
+  int             mSimHandle;
+  /// Mutex protecting calls to the steering library
+  QMutex         *mMutexPtr;
+  /// Where the arrays for the library are kept
+  MarshalArena   *mArena;
+  SessionRecorder *mRecorder;
+
+  int             mNumParams;
+  int             mNumIOFreqs;
+  int             mNumChkFreqs;
+  int             mNumCommands;
+  /// Labels of the parameters added (only kept if recording)
+  QStringList     mParamLabels;
+};
+
+#endif
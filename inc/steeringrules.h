@@ -0,0 +1,184 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file steeringrules.h
+    @brief Header file for the SteeringRules class */
+
+#ifndef __STEERING_RULES_H__
+#define __STEERING_RULES_H__
+
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qlist.h>
+#include <qhash.h>
+
+class QMutex;
+class MarshalArena;
+class SteeringCommandBuilder;
+
+/// Rules for steering an application automatically, read from a text
+/// file with one rule per line:
+///
+///   when <condition> set <label> = <expression> [every <n>]
+///
+/// for example
+///
+///   when residual > 1e-3 set timestep = timestep / 2 every 10
+///   when abs(temp - 300) > 5 set thermostat = thermostat + (300 - temp) / 10
+///
+/// Expressions are made of numbers, the labels of monitored and
+/// steered parameters (in double quotes if they aren't plain names),
+/// + - * / ( ), the comparisons < <= > >= == !=, and, or, not and the
+/// functions abs(x), min(x, y) and max(x, y).  Blank lines and lines
+/// starting with '#' are ignored.
+///
+/// The rules are evaluated by the CommsThread as each status message
+/// arrives, against the values in that message.  When a rule's
+/// condition holds it sets the steered parameter to the value of its
+/// expression, brought within the parameter's minimum and maximum.
+/// Everything set in response to one status message goes out in one
+/// Emit_control.  A rule with "every n" is only applied once in any
+/// n sequence numbers.
+class SteeringRules
+{
+public:
+  SteeringRules(const QString &aFileName, int aSimHandle, QMutex *aMutex);
+  ~SteeringRules();
+
+  /// Read the file, returning false (see errorString) if it can't
+  /// be read or has a bad rule
+  bool load();
+  QString errorString() const;
+  QString fileName() const;
+
+  /// Number of rules
+  int count() const;
+  /// A line per rule saying how often it has been applied
+  QString describe() const;
+
+  /// Apply the rules to the values of the status message with
+  /// sequence number aSeqNum.  A line (with aSeqNum in it) is
+  /// appended to aLog for each rule applied, or that couldn't be.
+  /// Returns the number of values sent.  Only called by the
+  /// CommsThread.
+  int evaluate(int aSeqNum, QStringList &aLog);
+
+  /// A node of a parsed expression
+  struct Expr
+  {
+    enum Op {kNUMBER, kPARAM, kNEG, kNOT, kADD, kSUB, kMUL, kDIV,
+	     kLT, kLE, kGT, kGE, kEQ, kNE, kAND, kOR, kABS, kMIN, kMAX};
+
+    Expr(Op aOp, Expr *aLeft = 0, Expr *aRight = 0);
+    ~Expr();
+
+    Op      mOp;
+    /// Value of a kNUMBER
+    double  mValue;
+    /// Label of a kPARAM
+    QString mLabel;
+    /// Operands (only mLeft for unary operators and abs)
+    Expr   *mLeft;
+    Expr   *mRight;
+  };
+
+private:
+  /// One line of the file
+  struct Rule
+  {
+    Rule();
+    ~Rule();
+
+    QString mText;
+    Expr   *mCondition;
+    /// Label of the steered parameter set
+    QString mTarget;
+    Expr   *mValue;
+    /// Fewest sequence numbers between applications of the rule
+    int     mEvery;
+    /// Sequence number last applied at (-1 for never)
+    int     mLastSeqNum;
+    int     mTimesApplied;
+    /// Why the rule couldn't be applied last time (only logged when
+    /// it changes, so a rule that can't be applied doesn't flood
+    /// the log)
+    QString mLastProblem;
+  };
+
+  /// What the status message says about a steered parameter
+  struct Steered
+  {
+    int     mHandle;
+    int     mType;
+    QString mMin;
+    QString mMax;
+  };
+
+  /// Get the values in the latest status message
+  void getValues(QHash<QString, double> &aValues,
+		 QHash<QString, Steered> &aSteered);
+  /// @return false (with the label in aMissing) if the expression
+  /// uses a parameter that there's no value for
+  static bool evalExpr(const Expr *aExpr,
+		       const QHash<QString, double> &aValues,
+		       double &aResult, QString &aMissing);
+  /// Log aProblem for aRule unless it's what was logged last time
+  void problem(Rule *aRule, int aIndex, int aSeqNum, const QString &aProblem,
+	       QStringList &aLog);
+
+  QString        mFileName;
+  QString        mError;
+  int            mSimHandle;
+  /// Mutex protecting calls to the steering library
+  QMutex        *mMutexPtr;
+  QList<Rule *>  mRules;
+
+  /// Buffers for the library - this is the comms thread's, the
+  /// application's own arena belongs to the GUI thread
+  MarshalArena           *mArena;
+  SteeringCommandBuilder *mBuilder;
+};
+
+#endif
@@ -0,0 +1,147 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file steeringtimeline.h
+    @brief Header file for the SteeringTimeline class */
+
+#ifndef __STEERING_TIMELINE_H__
+#define __STEERING_TIMELINE_H__
+
+#include <qstring.h>
+#include <qstringlist.h>
+#include <qlist.h>
+#include <qhash.h>
+
+class QMutex;
+class MarshalArena;
+class SteeringCommandBuilder;
+
+/// A list of steering actions, each due at a given sequence number of
+/// an application, read from a text file with one action per line:
+///
+///   <sequence number> set <parameter label> <value>
+///   <sequence number> frequency <IOType or ChkType label> <frequency>
+///   <sequence number> pause | resume | stop
+///
+/// Blank lines and lines starting with '#' are ignored.  The
+/// timeline is run by the CommsThread: as each status message
+/// arrives, every action that has come due is sent straight away, in
+/// a single Emit_control, without waiting for the GUI.  Labels are
+/// looked up in the library when the action is sent, so they needn't
+/// exist when the timeline is loaded.
+class SteeringTimeline
+{
+public:
+  SteeringTimeline(const QString &aFileName, int aSimHandle,
+		   QMutex *aMutex);
+  ~SteeringTimeline();
+
+  /// Read the file, returning false (see errorString) if it can't
+  /// be read or has a bad line
+  bool load();
+  QString errorString() const;
+  QString fileName() const;
+
+  /// Number of actions in the timeline
+  int count() const;
+  /// Number of actions not sent yet
+  int pendingCount() const;
+  /// Whether any actions are due at sequence number aSeqNum
+  bool isDue(int aSeqNum) const;
+  /// A line per action saying when it was due and what became of it
+  QString describe() const;
+
+  /// Send every action due at sequence number aSeqNum.  A line
+  /// (with aSeqNum in it) is appended to aLog for each action, and
+  /// the command of each pause, resume or stop sent to aCmds.
+  /// Returns the number of actions sent.  Only called by the
+  /// CommsThread.
+  int fire(int aSeqNum, QStringList &aLog, QList<int> &aCmds);
+
+private:
+  enum ActionType {kSET, kFREQUENCY, kCOMMAND};
+
+  /// One line of the timeline
+  struct Action
+  {
+    int        mSeqNum;
+    ActionType mType;
+    /// Parameter or IOType label (kSET and kFREQUENCY)
+    QString    mLabel;
+    /// New value or frequency (kSET and kFREQUENCY)
+    QString    mValue;
+    /// REG_STR_* command (kCOMMAND)
+    int        mCmdId;
+    /// The action as it appeared in the file
+    QString    mText;
+    /// Sequence number it was sent at, -1 if it hasn't been
+    int        mFiredAt;
+    /// What happened when it was sent
+    QString    mResult;
+  };
+
+  bool parseLine(const QString &aLine, Action &aAction);
+  /// Handles of the application's steered parameters (aType kSET),
+  /// or of its IOTypes or ChkTypes, keyed by label
+  QHash<QString, int> handlesByLabel(ActionType aType, bool aChkType);
+  static bool seqNumLessThan(const Action &aFirst, const Action &aSecond);
+
+  QString        mFileName;
+  QString        mError;
+  int            mSimHandle;
+  /// Mutex protecting calls to the steering library
+  QMutex        *mMutexPtr;
+  /// Actions in the order they're due
+  QList<Action>  mActions;
+  /// Index of the first action not yet sent
+  int            mNext;
+
+  /// Buffers for the library - this is the comms thread's, the
+  /// application's own arena belongs to the GUI thread
+  MarshalArena           *mArena;
+  SteeringCommandBuilder *mBuilder;
+};
+
+#endif
@@ -53,6 +53,8 @@
 
 #include <q3table.h>
 
+class SteeringCommandBuilder;
+
 // abstract table class
 class Table : public Q3Table
 {
@@ -75,6 +77,12 @@ public:
   //int getNumInitRows() const;
   int getMaxRowIndex() const;
   int getSimHandle() const;
+  /// Set the builder that values and commands from this table are
+  /// sent to the application with
+  void setCommandBuilder(SteeringCommandBuilder *aBuilder);
+
+protected:
+  SteeringCommandBuilder *commandBuilder() const;
 
 signals:
   void detachFromApplicationForErrorSignal();
@@ -85,6 +93,7 @@ private:
   int		mInitNumRows;
   int		mMaxRowIndex;
   bool		mAppAttached;
+  SteeringCommandBuilder *mCommandBuilder;
 
 };
 
@@ -65,11 +65,15 @@
 #define kNEWVALUE_COLUMN	4
 
 /// parameter tables sizes
-#define kNUM_MON_COLUMNS	4
+#define kNUM_MON_COLUMNS	5
 #define kNUM_STEER_COLUMNS	5
 // MR: removed - was causing problems, and giving no noticeable benefit
 //#define kINIT_ROWS		0//3
 
+/// monitored parameters table only - the last column (the steered
+/// table has its New Value column there instead)
+#define kMON_SPARKLINE_COLUMN	(kNUM_MON_COLUMNS - 1)
+
 
 /// iotype table constants
 #define kIO_ID_COLUMN		0
@@ -101,12 +105,14 @@
 #define kMIN_POLLING_INT	100
 #define kMAX_POLLING_INT        2000
 
+/// most display refreshes per second - any more and the tables and
+/// plots take all of the gui thread's time
+#define kMAX_REFRESH_RATE	50
+
 /// Unique numbers to make QCustomEvent IDs for postEvent
 /// from CommsThread.cpp
 #define kMSG_EVENT		100
 #define kSIGNAL_EVENT		200
-
-/// Maximum number of plots in a single history plot
-#define kMAX_HISTORY_PLOTS      10
+#define kTIMELINE_EVENT		300
 
 #endif
@@ -62,6 +62,8 @@
 #include <qwidget.h>
 #include <q3popupmenu.h>
 #include <qdom.h>
+#include <qdatetime.h>
+#include <qdir.h>
 //Added by qt3to4:
 #include <Q3HBoxLayout>
 #include <QEvent>
@@ -70,19 +72,28 @@
 #include "types.h"
 #include "application.h"
 #include "controlform.h"
+#include "parametertable.h"
 #include "debug.h"
 #include "commsthread.h"
 #include "exception.h"
 #include "steerermainwindow.h"
+#include "steererconfig.h"
+#include "sessionrecorder.h"
+#include "sessionreplayer.h"
+#include "marshalarena.h"
 
 #include "ReG_Steer_Steerside.h"
 
 Application::Application(QWidget *aParent, const char *aName,
-			 int aSimHandle, bool aIsLocal, QMutex *aMutex)
+			 int aSimHandle, bool aIsLocal, QMutex *aMutex,
+			 bool aIsReplay)
   : QWidget(aParent, aName), mSimHandle(aSimHandle), mMutexPtr(aMutex),
     mNumCommands(0), mDetachSupported(false), mStopSupported(false),
     mPauseSupported(false),  mResumeSupported(false), mDetachedFlag(false),
-    mStatusTxt(""), mControlForm(kNULL), mControlBox(kNULL)
+    mFinishedFlag(false),
+    mStatusTxt(""), mControlForm(kNULL), mControlBox(kNULL),
+    mRecorder(kNULL), mIsReplay(aIsReplay), mReplayer(kNULL),
+    mArena(kNULL)
 {
 
   // MR keep an internal record of whether we're local or grid
@@ -91,6 +102,27 @@ Application::Application(QWidget *aParent, const char *aName,
   // construct form for steering one application
   REG_DBGCON("Application");
 
+  // Start recording this session if asked to - before the ControlForm
+  // is created so that its tables can log the commands they send
+  SteererConfig *lConfig = ((SteererMainWindow*)aParent)->getConfig();
+  if (lConfig->mRecordSessions && !mIsReplay){
+    QDir lDir;
+    lDir.mkpath(lConfig->mSessionDirectory);
+    QString lFileName = lConfig->mSessionDirectory +
+      QString("/session_%1_%2.rgs").arg(QDateTime::currentDateTime().
+					toString("yyyyMMdd-hhmmss")).arg(aSimHandle);
+    mRecorder = new SessionRecorder(lFileName, QString(aName),
+				    lConfig->mSessionSyncSecs,
+				    lConfig->mSessionCompression, this);
+    if (!mRecorder->isOpen()){
+      delete mRecorder;
+      mRecorder = kNULL;
+    }
+  }
+
+  // Buffers for the ControlForm's (and our own) library calls
+  mArena = new MarshalArena();
+
   // create some layouts for positioning
   Q3HBoxLayout *lFormLayout = new Q3HBoxLayout(this, 6, 6);
   ///  QVBoxLayout *lButtonLayout = new QVBoxLayout(-1, "hb1" );
@@ -100,6 +132,9 @@ Application::Application(QWidget *aParent, const char *aName,
   mControlBox = new Q3GroupBox(1, Qt::Vertical, "", this, "editbox" );
   mControlForm = new ControlForm(mControlBox, aName, aSimHandle, this,
 				 mMutexPtr);
+  mControlForm->setDisplayRefreshRate(lConfig->mDisplayRefreshRate);
+  mControlForm->getMonParamTable()->
+    setSparklinesShown(lConfig->mShowSparklines);
   lFormLayout->addWidget(mControlBox);
   //this->addChild(mControlBox);
 
@@ -116,6 +151,13 @@ Application::Application(QWidget *aParent, const char *aName,
   // This message was originally automatically added to the
   // old style status text on app creation. Do it  here instead
   QString message = QString("Attached to application");
+  if (mIsReplay){
+    // Nothing to detach from and nothing can be steered
+    message = QString("Replaying recorded session");
+    mDetachedFlag = true;
+    mControlForm->disableAll(false);
+    mControlForm->setEnabledClose(true);
+  }
   mSteerer->statusBarMessageSlot(this, message);
 
   mChkTableVisible = true;
@@ -131,8 +173,18 @@ Application::~Application()
   if (!mDetachedFlag)
     detachFromApplication();
 
+  delete mReplayer;
+  mReplayer = kNULL;
+
   delete mControlForm;  //check this SMR XXX
   mControlForm = kNULL;
+
+  delete mArena;
+  mArena = kNULL;
+
+  // Write out whatever's left of the recording
+  delete mRecorder;
+  mRecorder = kNULL;
 }
 
 
@@ -164,6 +216,7 @@ Application::disableForDetach(const bool aUnRegister)
   // ARPDBG - no longer wait for confirmation and thus
   // let user close form when done.
   mControlForm->setEnabledClose(true);
+  setFinished();
 }
 
 /** As for disableForDetach but called when an error condition
@@ -174,6 +227,19 @@ Application::disableForDetachOnError()
 {
   mControlForm->disableAll(true);
   mControlForm->setEnabledClose(true);
+  setFinished();
+}
+
+/** Tell anything waiting on this application's data (e.g. ensemble
+  * plots) not to expect much more
+  */
+void
+Application::setFinished()
+{
+  if (mFinishedFlag)
+    return;
+  mFinishedFlag = true;
+  emit finishedSignal(this);
 }
 
 void
@@ -200,7 +266,7 @@ Application::enableCmdButtons()
     {
       if (mNumCommands > 0)
       {
-	lCmdIds = new int[mNumCommands];
+	lCmdIds = mArena->ints(MarshalArena::kCOMMANDS, mNumCommands);
 
 	mMutexPtr->lock();
 	lReGStatus = Get_supp_cmds(mSimHandle, mNumCommands, lCmdIds);	//ReG library
@@ -241,17 +307,10 @@ Application::enableCmdButtons()
       } // switch
     } //for
 
-    // cleanup
-    delete [] lCmdIds;
-    lCmdIds = kNULL;
-
   } //try
 
   catch (SteererException StEx)
   {
-    delete [] lCmdIds;
-    lCmdIds = kNULL;
-
     StEx.print();
     throw StEx;
   }
@@ -327,8 +386,6 @@ Application::emitStopCmdSlot()
 void
 Application::emitPauseCmdSlot()
 {
-  QString message;
-
   // Disable Pause and enable resume if supported (should be forced
   // to support both in library)
   if(!getCurrentStatus().contains("paused", FALSE)){
@@ -336,7 +393,24 @@ Application::emitPauseCmdSlot()
     if(emitSingleCmd(REG_STR_PAUSE) != REG_SUCCESS){
       return;
     }
+    showPaused(true);
+  }
+  else{
+
+    if(emitSingleCmd(REG_STR_RESUME) != REG_SUCCESS){
+      return;
+    }
+    showPaused(false);
+  }
+}
 
+//------------------------------------------------------------------------
+void
+Application::showPaused(const bool aPaused)
+{
+  QString message;
+
+  if(aPaused){
     mControlForm->setPauseButtonLabel(QString("Resume"));
 
     // disable IOtype commands
@@ -349,11 +423,6 @@ Application::emitPauseCmdSlot()
     message = QString("Attached - paused");
   }
   else{
-
-    if(emitSingleCmd(REG_STR_RESUME) != REG_SUCCESS){
-      return;
-    }
-
     mControlForm->setPauseButtonLabel(QString("Pause"));
 
     // enable IOtype commands
@@ -409,6 +478,16 @@ Application::emitSingleCmd(int aCmdId)
 
     if (lReGStatus != REG_SUCCESS)
       THROWEXCEPTION("Emit control");
+
+    if (mRecorder){
+      switch(aCmdId){
+      case REG_STR_STOP:   mRecorder->recordCommand("stop");   break;
+      case REG_STR_PAUSE:  mRecorder->recordCommand("pause");  break;
+      case REG_STR_RESUME: mRecorder->recordCommand("resume"); break;
+      case REG_STR_DETACH: mRecorder->recordCommand("detach"); break;
+      default: break;
+      }
+    }
   }
 
   catch (SteererException StEx)
@@ -437,18 +516,60 @@ Application::customEvent(QEvent *aEvent)
   // - alternative is to have CommsThread execute processNextMessage
   // but then we need to worry about locking within Qt GUI related methods
 
-  // only expect events with type (User+kMSG_EVENT)
+  // only expect events with type (User+kMSG_EVENT) or (User+kTIMELINE_EVENT)
   if (aEvent->type() == QEvent::User+kMSG_EVENT)
   {
     CommsThreadEvent *lEvent = (CommsThreadEvent *) aEvent;
     processNextMessage(lEvent);
   }
+  else if (aEvent->type() == QEvent::User+kTIMELINE_EVENT)
+  {
+    processTimelineEvent((TimelineEvent *) aEvent);
+  }
   else
   {
     REG_DBGMSG("Application::customEvent -  unexpected event type");
   }
 }
 
+//------------------------------------------------------------------------
+void
+Application::processTimelineEvent(TimelineEvent *aEvent)
+{
+  // the commsthread has already sent these (from a timeline or rules)
+  // - just bring the gui (and any recording) up to date
+  if (mDetachedFlag)
+    return;
+
+  const QStringList &lLog = aEvent->log();
+  for (int i=0; i<lLog.count(); i++){
+    REG_DBGMSG1("Automatic steering: ", lLog[i].latin1());
+    if (mRecorder)
+      mRecorder->recordCommand(lLog[i]);
+  }
+
+  const QList<int> &lCmds = aEvent->commands();
+  for (int i=0; i<lCmds.count(); i++){
+    switch(lCmds[i]){
+    case REG_STR_PAUSE:  showPaused(true);  break;
+    case REG_STR_RESUME: showPaused(false); break;
+    case REG_STR_STOP:
+      // as for the stop button
+      disableForDetach(false);
+      break;
+    default: break;
+    }
+  }
+
+  // the status is checked for "paused" so the last action is added
+  // to it rather than replacing it
+  if (!lLog.isEmpty()){
+    QString message = getCurrentStatus().section(" [", 0, 0) +
+      " [" + lLog.last() + "]";
+    mSteerer->statusBarMessageSlot(this, message);
+  }
+}
+
 //------------------------------------------------------------------------
 void
 Application::processNextMessage(CommsThreadEvent *aEvent)
@@ -499,8 +620,12 @@ Application::processNextMessage(CommsThreadEvent *aEvent)
       int  *commands;
       bool detached;
       detached = false;
-      // update parameter list and table
+      // update parameter list and table (and record the new values)
+      if (mRecorder)
+	mRecorder->beginRow(aEvent->getSeqNum());
       mControlForm->updateParameters(true);
+      if (mRecorder)
+	mRecorder->endRow();
 
       // update IOType list and table (needed for frequency update)
       mControlForm->updateIOTypes(false);	// sample types
@@ -736,6 +861,20 @@ int Application::getHandle(){
   return mSimHandle;
 }
 
+ControlForm *Application::getControlForm(){
+  return mControlForm;
+}
+
+SessionRecorder *Application::getRecorder(){
+  return mRecorder;
+}
+
+void Application::startReplay(SessionReader *aReader, double aSpeed){
+  delete mReplayer;
+  mReplayer = new SessionReplayer(aReader, this, mSteerer, aSpeed);
+  mReplayer->start();
+}
+
 void Application::setCurrentStatus(QString &msg){
   mStatusTxt = msg;
 }
@@ -791,3 +930,7 @@ void Application::setIOTableVisible(bool flag){
 void Application::setChkTableVisible(bool flag){
   mChkTableVisible = flag;
 }
+
+void Application::setDisplayRefreshRate(int aRate){
+  mControlForm->setDisplayRefreshRate(aRate);
+}
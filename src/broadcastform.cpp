@@ -0,0 +1,247 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file broadcastform.cpp
+    @brief Implementation of the BroadcastForm class */
+
+#include <q3listbox.h>
+#include <q3filedialog.h>
+#include <qcombobox.h>
+#include <qfile.h>
+#include <qlayout.h>
+#include <qlineedit.h>
+#include <qmessagebox.h>
+#include <qpushbutton.h>
+#include <qregexp.h>
+#include <qtextedit.h>
+#include <qtextstream.h>
+#include <qtooltip.h>
+#include <Q3HBoxLayout>
+#include <Q3VBoxLayout>
+#include <QLabel>
+
+#include "buildconfig.h"
+#include "broadcastform.h"
+#include "types.h"
+#include "debug.h"
+
+BroadcastForm::BroadcastForm(const QStringList &aAppNames,
+			     const QStringList &aLabels,
+			     QWidget *parent, const char *name,
+			     bool modal, Qt::WFlags f)
+  : QDialog( parent, name, modal, f )
+{
+  REG_DBGCON("BroadcastForm");
+
+  this->setCaption( "Broadcast Steered Parameters" );
+  resize( 350, 450 );
+
+  Q3VBoxLayout *lFormLayout = new Q3VBoxLayout(this, 10, 6,
+					       "broadcastformlayout");
+
+  lFormLayout->addWidget(new QLabel("Applications to steer:", this));
+  mAppListBox = new Q3ListBox(this, "broadcastapps");
+  mAppListBox->setSelectionMode(Q3ListBox::Multi);
+  mAppListBox->insertStringList(aAppNames);
+  mAppListBox->selectAll(TRUE);
+  lFormLayout->addWidget(mAppListBox);
+
+  lFormLayout->addWidget(new QLabel("Values to set, one \"<label> <value>\" "
+				    "per line:", this));
+
+  Q3HBoxLayout *lAddLayout = new Q3HBoxLayout(6, "broadcastaddlayout");
+  mLabelCombo = new QComboBox(FALSE, this, "broadcastlabels");
+  mLabelCombo->insertStringList(aLabels);
+  mValueEdit = new QLineEdit(this, "broadcastvalue");
+  mAddButton = new QPushButton("Add", this, "broadcastaddbutton");
+  mAddButton->setAutoDefault(FALSE);
+  QToolTip::add(mAddButton, "Add this parameter and value to the list");
+  connect(mAddButton, SIGNAL(clicked()), this, SLOT(addValueSlot()));
+  connect(mValueEdit, SIGNAL(returnPressed()), this, SLOT(addValueSlot()));
+  lAddLayout->addWidget(mLabelCombo);
+  lAddLayout->addWidget(mValueEdit);
+  lAddLayout->addWidget(mAddButton);
+  lFormLayout->addLayout(lAddLayout);
+
+  mPresetEdit = new QTextEdit(this);
+  mPresetEdit->setAcceptRichText(false);
+  lFormLayout->addWidget(mPresetEdit);
+
+  Q3HBoxLayout *lButtonLayout = new Q3HBoxLayout(6, "broadcastbuttonlayout");
+
+  mLoadButton = new QPushButton("Load preset...", this, "loadpresetbutton");
+  mLoadButton->setAutoDefault(FALSE);
+  QToolTip::add(mLoadButton, "Read the values from a file");
+  connect(mLoadButton, SIGNAL(clicked()), this, SLOT(loadPresetSlot()));
+
+  mBroadcastButton = new QPushButton("Broadcast", this, "broadcastbutton");
+  mBroadcastButton->setAutoDefault(FALSE);
+  QToolTip::add(mBroadcastButton, "Send the values to every chosen "
+		"application");
+  connect(mBroadcastButton, SIGNAL(clicked()), this, SLOT(broadcastSlot()));
+
+  mCancelButton = new QPushButton("Cancel", this, "cancelbutton");
+  mCancelButton->setAutoDefault(FALSE);
+  connect(mCancelButton,  SIGNAL(clicked()), this, SLOT( reject()));
+
+  lButtonLayout->addWidget(mLoadButton);
+  lButtonLayout->addStretch();
+  lButtonLayout->addWidget(mBroadcastButton);
+  lButtonLayout->addWidget(mCancelButton);
+  lFormLayout->addLayout(lButtonLayout);
+}
+
+BroadcastForm::~BroadcastForm()
+{
+  REG_DBGDST("BroadcastForm");
+}
+
+QList<int>
+BroadcastForm::getSelectedApps() const
+{
+  QList<int> lApps;
+
+  for (unsigned int i=0; i<mAppListBox->count(); i++)
+  {
+    if (mAppListBox->isSelected(i))
+      lApps.append(i);
+  }
+  return lApps;
+}
+
+const ParameterPreset &
+BroadcastForm::getPreset() const
+{
+  return mPreset;
+}
+
+void
+BroadcastForm::addValueSlot()
+{
+  if (mLabelCombo->currentText().isEmpty() ||
+      mValueEdit->text().stripWhiteSpace().isEmpty())
+    return;
+
+  mPresetEdit->append(mLabelCombo->currentText() + " " +
+		      mValueEdit->text().stripWhiteSpace());
+  mValueEdit->clear();
+}
+
+void
+BroadcastForm::loadPresetSlot()
+{
+  QString lFileName =
+    Q3FileDialog::getOpenFileName(QString::null,
+				  "Presets (*.txt);;All files (*)", this,
+				  "preset dialog", "Choose a preset");
+  if (lFileName.isEmpty())
+    return;
+
+  QFile lFile(lFileName);
+  if (!lFile.open(QIODevice::ReadOnly))
+  {
+    QMessageBox::warning(this, "Load preset",
+			 "Failed to open " + lFileName);
+    return;
+  }
+
+  QTextStream lStream(&lFile);
+  mPresetEdit->setPlainText(lStream.readAll());
+}
+
+QString
+BroadcastForm::parsePreset(const QString &aText)
+{
+  QStringList lLines = QStringList::split('\n', aText);
+
+  mPreset.clear();
+  for (int i=0; i<lLines.count(); i++)
+  {
+    QString lLine = lLines[i].stripWhiteSpace();
+    if (lLine.isEmpty() || lLine.startsWith("#"))
+      continue;
+
+    // The label may contain spaces so the value is the last word
+    int lSplit = lLine.findRev(QRegExp("\\s"));
+    if (lSplit < 0)
+    {
+      mPreset.clear();
+      return lLine;
+    }
+    mPreset.append(qMakePair(lLine.left(lSplit).stripWhiteSpace(),
+			     lLine.mid(lSplit + 1)));
+  }
+  return QString::null;
+}
+
+void
+BroadcastForm::broadcastSlot()
+{
+  QString lBadLine = parsePreset(mPresetEdit->toPlainText());
+
+  if (!lBadLine.isNull())
+  {
+    QMessageBox::information(this, "Invalid entry",
+			     "Each line should be a parameter label "
+			     "followed by its value, not\n" + lBadLine,
+			     QMessageBox::Ok,
+			     QMessageBox::NoButton,
+			     QMessageBox::NoButton);
+    return;
+  }
+
+  if (mPreset.isEmpty() || getSelectedApps().isEmpty())
+  {
+    QMessageBox::information(this, "Nothing to send",
+			     "Please choose at least one application and "
+			     "enter at least one value",
+			     QMessageBox::Ok,
+			     QMessageBox::NoButton,
+			     QMessageBox::NoButton);
+    return;
+  }
+
+  QDialog::accept();
+}
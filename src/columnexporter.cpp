@@ -0,0 +1,422 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file columnexporter.cpp
+    @brief Implementation of the ColumnExporter class - chunked text
+    and binary export of parameter histories */
+
+#include <qiodevice.h>
+#include <qsysinfo.h>
+#include <QtEndian>
+#include <limits>
+
+#include "buildconfig.h"
+#include "columnexporter.h"
+
+/// Size of the buffer that output is gathered in before writing
+static const int kEXPORT_CHUNK_BYTES = 256*1024;
+
+ColumnExporter::ColumnExporter()
+  : mNumRows(0)
+{
+}
+
+ColumnExporter::~ColumnExporter()
+{
+}
+
+//---------------------------------------------------------------------------
+void ColumnExporter::setComment(const QString &aComment)
+{
+  mComment = aComment;
+}
+
+//---------------------------------------------------------------------------
+void ColumnExporter::setLabels(const QStringList &aLabels)
+{
+  mLabels = aLabels;
+}
+
+//---------------------------------------------------------------------------
+void ColumnExporter::addBlock(const QVector<const double *> &aColumns,
+			      int aNumRows)
+{
+  addBlock(aColumns, aNumRows, QVector<int>(aColumns.count(), 0),
+	   QVector<int>(aColumns.count(), aNumRows));
+}
+
+//---------------------------------------------------------------------------
+void ColumnExporter::addBlock(const QVector<const double *> &aColumns,
+			      int aNumRows, const QVector<int> &aFirstRows,
+			      const QVector<int> &aLengths)
+{
+  if(aNumRows <= 0){
+    return;
+  }
+  Block lBlock;
+  lBlock.mColumns = aColumns;
+  lBlock.mNumRows = aNumRows;
+  lBlock.mFirstRows = aFirstRows;
+  lBlock.mLengths = aLengths;
+  mBlocks.append(lBlock);
+  mNumRows += aNumRows;
+}
+
+//---------------------------------------------------------------------------
+void ColumnExporter::gather(const Block &aBlock, int aCol, int aRow,
+			    int aNum, double *aDest)
+{
+  const double lMissing = std::numeric_limits<double>::quiet_NaN();
+  int lFirst = aBlock.mFirstRows[aCol];
+  int lEnd = lFirst + aBlock.mLengths[aCol];
+
+  for(int i = aRow; i < aRow + aNum; i++){
+    *aDest++ = (i >= lFirst && i < lEnd) ?
+      aBlock.mColumns[aCol][i - lFirst] : lMissing;
+  }
+}
+
+//---------------------------------------------------------------------------
+qint64 ColumnExporter::numRows() const
+{
+  return mNumRows;
+}
+
+//---------------------------------------------------------------------------
+ColumnExporter::Format ColumnExporter::formatForFile(const QString &aFileName)
+{
+  if(aFileName.endsWith(".binz")){
+    return kCOMPRESSED_FORMAT;
+  }
+  return aFileName.endsWith(".bin") ? kBINARY_FORMAT : kTEXT_FORMAT;
+}
+
+//---------------------------------------------------------------------------
+bool ColumnExporter::reportProgress(qint64 aDone, qint64 aTotal)
+{
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool ColumnExporter::write(QIODevice *aDevice, Format aFormat)
+{
+  if(aFormat == kCOMPRESSED_FORMAT){
+    return writeCompressed(aDevice);
+  }
+  if(aFormat == kBINARY_FORMAT){
+    return writeBinary(aDevice);
+  }
+  return writeText(aDevice);
+}
+
+//---------------------------------------------------------------------------
+bool ColumnExporter::writeText(QIODevice *aDevice)
+{
+  int    i, j, k;
+  int    lLen;
+  double lVal;
+  int    lNumCols = mLabels.count();
+  qint64 lDone = 0;
+  qint64 lTotal = mNumRows*lNumCols;
+
+  // Header for data
+  QString lHeader;
+  if(!mComment.isEmpty()){
+    lHeader += "# " + mComment + "\n";
+  }
+  lHeader += "# " + mLabels.join(", ") + "\n";
+  if(aDevice->write(lHeader.toLatin1()) < 0){
+    return false;
+  }
+
+  // Rows are formatted straight into one buffer and written out
+  // whenever it's nearly full - no per-value allocations
+  char *lBuf = new char[kEXPORT_CHUNK_BYTES];
+  // Room for the longest possible row
+  const int lMaxRow = 32*(lNumCols + 1);
+  int lPos = 0;
+
+  for(k = 0; k < mBlocks.count(); k++){
+    const Block &lBlock = mBlocks[k];
+    for(i = 0; i < lBlock.mNumRows; i++){
+
+      if(lPos + lMaxRow > kEXPORT_CHUNK_BYTES){
+	if(aDevice->write(lBuf, lPos) != lPos ||
+	   !reportProgress(lDone, lTotal)){
+	  delete [] lBuf;
+	  return false;
+	}
+	lPos = 0;
+      }
+
+      // First column is the abscissa
+      for(j = 0; j < lNumCols; j++){
+	gather(lBlock, j, i, 1, &lVal);
+	lLen = snprintf(lBuf + lPos, kEXPORT_CHUNK_BYTES - lPos,
+			(j == 0) ? "%.10g" : "  %.8e", lVal);
+	if(lLen > 0) lPos += lLen;
+      }
+      lBuf[lPos++] = '\n';
+      lDone += lNumCols;
+    }
+  }
+
+  bool lOk = (aDevice->write(lBuf, lPos) == lPos);
+  delete [] lBuf;
+
+  return lOk && reportProgress(lDone, lTotal);
+}
+
+//---------------------------------------------------------------------------
+bool ColumnExporter::writeBinary(QIODevice *aDevice)
+{
+  int    i, j, k, n;
+  int    lChunk;
+  int    lNumCols = mLabels.count();
+  qint64 lDone = 0;
+  qint64 lTotal = mNumRows*lNumCols;
+  bool   lSwap = (QSysInfo::ByteOrder != QSysInfo::LittleEndian);
+
+  QByteArray lBytes = binaryHeader(false, 0);
+  if(aDevice->write(lBytes) != lBytes.size()){
+    return false;
+  }
+
+  const int lChunkVals = kEXPORT_CHUNK_BYTES/sizeof(double);
+  double *lBuf = new double[lChunkVals];
+
+  // Column by column, block by block, chunk by chunk
+  for(j = 0; j < lNumCols; j++){
+    for(k = 0; k < mBlocks.count(); k++){
+      const Block &lBlock = mBlocks[k];
+      const double *lSrc = lBlock.mColumns[j];
+      bool lFull = (lBlock.mFirstRows[j] == 0 &&
+		    lBlock.mLengths[j] >= lBlock.mNumRows);
+
+      for(i = 0; i < lBlock.mNumRows; i += lChunk){
+	lChunk = lBlock.mNumRows - i;
+	if(lChunk > lChunkVals) lChunk = lChunkVals;
+
+	const char *lOut = (const char *)(lSrc + i);
+	if(!lFull){
+	  // Gaps to fill - gather (and then swap in place if need be)
+	  gather(lBlock, j, i, lChunk, lBuf);
+	  lOut = (const char *)lBuf;
+	}
+	if(lSwap){
+	  unsigned char *lIn = (unsigned char *)lOut;
+	  unsigned char *lDest = (unsigned char *)lBuf;
+	  unsigned char lByte;
+	  for(n = 0; n < lChunk*8; n += 8){
+	    for(int b = 0; b < 4; b++){
+	      lByte = lIn[n + b];
+	      lDest[n + b] = lIn[n + 7 - b];
+	      lDest[n + 7 - b] = lByte;
+	    }
+	  }
+	  lOut = (const char *)lBuf;
+	}
+
+	if(aDevice->write(lOut, lChunk*sizeof(double)) !=
+	   (qint64)(lChunk*sizeof(double))){
+	  delete [] lBuf;
+	  return false;
+	}
+	lDone += lChunk;
+	if(!reportProgress(lDone, lTotal)){
+	  delete [] lBuf;
+	  return false;
+	}
+      }
+    }
+  }
+
+  delete [] lBuf;
+  return true;
+}
+
+//---------------------------------------------------------------------------
+QByteArray ColumnExporter::binaryHeader(bool aCompressed, int aChunkRows) const
+{
+  int lNumCols = mLabels.count();
+
+  // Self-describing header
+  QString lHeader = "RGSTEER-COLUMNS 1\nendian little\ntype float64\n";
+  lHeader += QString("rows %1\ncolumns %2\n").arg(mNumRows).arg(lNumCols);
+  if(aCompressed){
+    lHeader += QString("compression zlib\nchunkrows %1\n").arg(aChunkRows);
+  }
+  for(int j = 0; j < lNumCols; j++){
+    QString lLabel = mLabels[j];
+    lLabel.replace('\n', ' ');
+    lHeader += "column " + lLabel + "\n";
+  }
+  lHeader += "end\n";
+  QByteArray lBytes = lHeader.toLatin1();
+  // Pad so that the data are 8-byte aligned (for memory mapping)
+  while(lBytes.size() % 8){
+    lBytes.insert(lBytes.size() - 1, ' ');
+  }
+  return lBytes;
+}
+
+//---------------------------------------------------------------------------
+void ColumnExporter::gatherRows(int aCol, qint64 aRow, int aNum,
+				double *aDest) const
+{
+  qint64 lBlockStart = 0;
+
+  for(int k = 0; k < mBlocks.count() && aNum > 0; k++){
+    const Block &lBlock = mBlocks[k];
+    qint64 lBlockEnd = lBlockStart + lBlock.mNumRows;
+
+    if(aRow < lBlockEnd){
+      int lNum = (int)qMin((qint64)aNum, lBlockEnd - aRow);
+      gather(lBlock, aCol, (int)(aRow - lBlockStart), lNum, aDest);
+      aDest += lNum;
+      aRow += lNum;
+      aNum -= lNum;
+    }
+    lBlockStart = lBlockEnd;
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Little-endian bytes of an int64
+static QByteArray int64Bytes(qint64 aVal)
+{
+  uchar lBytes[8];
+  qToLittleEndian<qint64>(aVal, lBytes);
+  return QByteArray((const char *)lBytes, 8);
+}
+
+//---------------------------------------------------------------------------
+bool ColumnExporter::writeCompressed(QIODevice *aDevice)
+{
+  int    i, j, r;
+  int    lNumCols = mLabels.count();
+  qint64 lDone = 0;
+  qint64 lTotal = mNumRows*lNumCols;
+  bool   lSwap = (QSysInfo::ByteOrder != QSysInfo::LittleEndian);
+
+  // Chunks decompress to the same size as the buffer we stream with
+  const int lChunkRows = kEXPORT_CHUNK_BYTES/sizeof(double);
+  const int lNumChunks = (int)((mNumRows + lChunkRows - 1)/lChunkRows);
+
+  QByteArray lHeader = binaryHeader(true, lChunkRows);
+  if(aDevice->write(lHeader) != lHeader.size()){
+    return false;
+  }
+  qint64 lPos = lHeader.size();
+
+  // Offset and size of every chunk of every column, and the range of
+  // column 0 in every chunk of rows
+  QVector<qint64> lOffsets(lNumChunks*lNumCols);
+  QVector<qint64> lSizes(lNumChunks*lNumCols);
+  QVector<double> lFirst(lNumChunks);
+  QVector<double> lLast(lNumChunks);
+
+  double *lBuf = new double[lChunkRows];
+  const char lPad[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+  // We're already on a worker thread (see ExportThread) so the
+  // compression is done in-line
+  for(j = 0; j < lNumCols; j++){
+    for(r = 0; r < lNumChunks; r++){
+      qint64 lRow = (qint64)r*lChunkRows;
+      int lNum = (int)qMin((qint64)lChunkRows, mNumRows - lRow);
+
+      gatherRows(j, lRow, lNum, lBuf);
+      if(j == 0){
+	lFirst[r] = lBuf[0];
+	lLast[r] = lBuf[lNum - 1];
+      }
+      if(lSwap){
+	for(i = 0; i < lNum; i++){
+	  quint64 lBits;
+	  memcpy(&lBits, &lBuf[i], sizeof(double));
+	  qToLittleEndian<quint64>(lBits, (uchar *)&lBuf[i]);
+	}
+      }
+
+      QByteArray lBlob = qCompress((const uchar *)lBuf,
+				   lNum*sizeof(double));
+      int lPadding = (8 - lBlob.size() % 8) % 8;
+      if(aDevice->write(lBlob) != lBlob.size() ||
+	 aDevice->write(lPad, lPadding) != lPadding){
+	delete [] lBuf;
+	return false;
+      }
+      lOffsets[r*lNumCols + j] = lPos;
+      lSizes[r*lNumCols + j] = lBlob.size();
+      lPos += lBlob.size() + lPadding;
+
+      lDone += lNum;
+      if(!reportProgress(lDone, lTotal)){
+	delete [] lBuf;
+	return false;
+      }
+    }
+  }
+  delete [] lBuf;
+
+  // Index, then where to find it
+  QByteArray lIndex;
+  for(r = 0; r < lNumChunks; r++){
+    quint64 lBits;
+    memcpy(&lBits, &lFirst[r], sizeof(double));
+    lIndex += int64Bytes((qint64)lBits);
+    memcpy(&lBits, &lLast[r], sizeof(double));
+    lIndex += int64Bytes((qint64)lBits);
+    for(j = 0; j < lNumCols; j++){
+      lIndex += int64Bytes(lOffsets[r*lNumCols + j]);
+      lIndex += int64Bytes(lSizes[r*lNumCols + j]);
+    }
+  }
+  lIndex += "CHUNKIDX";
+  lIndex += int64Bytes(lPos);
+
+  return (aDevice->write(lIndex) == lIndex.size());
+}
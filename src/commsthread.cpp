@@ -74,6 +74,8 @@
 #include "commsthread.h"
 #include "steerermainwindow.h"
 #include "application.h"
+#include "steeringtimeline.h"
+#include "steeringrules.h"
 
 #include "ReG_Steer_Steerside.h"
 
@@ -160,6 +162,9 @@ CommsThread::~CommsThread()
   // must stop a thread running before it is deleted...
   if (running())
     stop();
+
+  qDeleteAll(mTimelines);
+  qDeleteAll(mRules);
 }
 
 void
@@ -189,6 +194,89 @@ CommsThread::getCheckInterval() const
  return mCheckInterval;
 }
 
+void
+CommsThread::setTimeline(int aSimHandle, SteeringTimeline *aTimeline)
+{
+  QMutexLocker lLocker(&mAutoSteerMutex);
+
+  delete mTimelines.take(aSimHandle);
+  if (aTimeline)
+    mTimelines.insert(aSimHandle, aTimeline);
+}
+
+QString
+CommsThread::describeTimeline(int aSimHandle)
+{
+  QMutexLocker lLocker(&mAutoSteerMutex);
+
+  SteeringTimeline *lTimeline = mTimelines.value(aSimHandle, kNULL);
+  if (!lTimeline)
+    return QString::null;
+
+  return QString("%1 (%2 of %3 actions pending)\n\n%4").
+    arg(lTimeline->fileName()).arg(lTimeline->pendingCount()).
+    arg(lTimeline->count()).arg(lTimeline->describe());
+}
+
+void
+CommsThread::setRules(int aSimHandle, SteeringRules *aRules)
+{
+  QMutexLocker lLocker(&mAutoSteerMutex);
+
+  delete mRules.take(aSimHandle);
+  if (aRules)
+    mRules.insert(aSimHandle, aRules);
+}
+
+QString
+CommsThread::describeRules(int aSimHandle)
+{
+  QMutexLocker lLocker(&mAutoSteerMutex);
+
+  SteeringRules *lRules = mRules.value(aSimHandle, kNULL);
+  if (!lRules)
+    return QString::null;
+
+  return QString("%1 (%2 rules)\n\n%3").arg(lRules->fileName()).
+    arg(lRules->count()).arg(lRules->describe());
+}
+
+void
+CommsThread::runRules(int aSimHandle, int aSeqNum, Application *aApp)
+{
+  QMutexLocker lLocker(&mAutoSteerMutex);
+
+  SteeringRules *lRules = mRules.value(aSimHandle, kNULL);
+  if (!lRules)
+    return;
+
+  // applied here rather than in the GUI so that the application is
+  // steered in response to this status message, not a later one
+  TimelineEvent *lEvent = new TimelineEvent();
+  lRules->evaluate(aSeqNum, lEvent->log());
+  if (lEvent->log().isEmpty()){
+    delete lEvent;
+    return;
+  }
+  QCoreApplication::postEvent(aApp, lEvent);
+}
+
+void
+CommsThread::runTimeline(int aSimHandle, int aSeqNum, Application *aApp)
+{
+  QMutexLocker lLocker(&mAutoSteerMutex);
+
+  SteeringTimeline *lTimeline = mTimelines.value(aSimHandle, kNULL);
+  if (!lTimeline || !lTimeline->isDue(aSeqNum))
+    return;
+
+  // sent from here rather than the GUI so that the actions reach the
+  // application within a status message of when they're due
+  TimelineEvent *lEvent = new TimelineEvent();
+  lTimeline->fire(aSeqNum, lEvent->log(), lEvent->commands());
+  QCoreApplication::postEvent(aApp, lEvent);
+}
+
 void
 CommsThread::stop()
 {
@@ -386,8 +474,14 @@ CommsThread::run()
 	// ARPDBG - attempt to avoid lock-up on shutdown
 	if(lApp && mKeepRunningFlag){
 
+	  if(lMsgType == STATUS){
+	    runTimeline(lSimHandle, app_seqnum, lApp);
+	    runRules(lSimHandle, app_seqnum, lApp);
+	  }
+
 	  CommsThreadEvent *lEvent = new CommsThreadEvent(lMsgType);
 	  if(num_cmds)lEvent->storeCommands(num_cmds, commands);
+	  if(lMsgType == STATUS)lEvent->setSeqNum(app_seqnum);
 	  QCoreApplication::postEvent(lApp, lEvent);
 	}
 	else{
@@ -430,6 +524,7 @@ CommsThreadEvent::CommsThreadEvent(int aMsgType)
   // class to extend QCustomEvent to hold mMsgType
   REG_DBGCON("CommsThreadEvent");
   mNumCmds = 0;
+  mSeqNum = -1;
 }
 
 CommsThreadEvent::~CommsThreadEvent()
@@ -463,3 +558,35 @@ int *CommsThreadEvent::getCmdsPtr()
 {
   return mCommands;
 }
+
+void CommsThreadEvent::setSeqNum(int aSeqNum)
+{
+  mSeqNum = aSeqNum;
+}
+
+int CommsThreadEvent::getSeqNum() const
+{
+  return mSeqNum;
+}
+
+
+TimelineEvent::TimelineEvent()
+  : QCustomEvent(QEvent::User + kTIMELINE_EVENT)
+{
+  REG_DBGCON("TimelineEvent");
+}
+
+TimelineEvent::~TimelineEvent()
+{
+  REG_DBGDST("TimelineEvent");
+}
+
+QStringList &TimelineEvent::log()
+{
+  return mLog;
+}
+
+QList<int> &TimelineEvent::commands()
+{
+  return mCommands;
+}
@@ -74,7 +74,8 @@
 #include "types.h"
 #include "debug.h"
 
-ConfigForm::ConfigForm(int aCurrentIntervalValue, QWidget *parent,
+ConfigForm::ConfigForm(int aCurrentIntervalValue, int aCurrentRefreshRate,
+		       QWidget *parent,
 		       const char *name,
 		       bool modal, Qt::WFlags f)
   : QDialog( parent, name, modal, f ),
@@ -82,6 +83,8 @@ ConfigForm::ConfigForm(int aCurrentIntervalValue, QWidget *parent,
 {
   mMinVal_Sec = 0.05f;
   mMaxVal_Sec = 2.0f;
+  mMaxRefreshRate = kMAX_REFRESH_RATE;
+  mRefreshRate = aCurrentRefreshRate;
 
   REG_DBGMSG1("ARPDBG: min val = ", mMinVal_Sec);
   REG_DBGMSG1("ARPDBG: max val = ", mMaxVal_Sec);
@@ -91,7 +94,7 @@ ConfigForm::ConfigForm(int aCurrentIntervalValue, QWidget *parent,
   // note aCurrentIntervalValue is in milliseconds - convert to
   // seconds for GUI entry
 
-  this->setCaption( "Configure Polling" );
+  this->setCaption( "Configure Polling and Display" );
   resize( 150, 150 );
 
   // create the layouts for the form
@@ -113,6 +116,19 @@ ConfigForm::ConfigForm(int aCurrentIntervalValue, QWidget *parent,
 
   lFormLayout->addWidget( mLineEdit);
 
+  lFormLayout->addWidget(new QLabel("Enter maximum display refreshes per "
+				    "second \n(0 to refresh for every "
+				    "status message)\n"
+				    "Valid range: 0 - "
+				    +QString::number(mMaxRefreshRate), this));
+
+  mRefreshLineEdit = new QLineEdit( this );
+  mRefreshLineEdit->setText(QString::number(aCurrentRefreshRate));
+  mRefreshLineEdit->setValidator( new QIntValidator(0, mMaxRefreshRate,
+						    mRefreshLineEdit) );
+
+  lFormLayout->addWidget( mRefreshLineEdit);
+
   mApplyButton = new QPushButton("Apply", this, "Applybutton"); \
   mApplyButton->setAutoDefault(FALSE);
   QToolTip::add(mApplyButton, "Apply to steerer");
@@ -145,12 +161,37 @@ ConfigForm::getIntervalValue(void) const
   return mIntervalValue;
 }
 
+int
+ConfigForm::getRefreshRate(void) const
+{
+  return mRefreshRate;
+}
+
 
 void
 ConfigForm::applySlot()
 {
   bool lOk = false;
   double lValue;
+
+  // An empty refresh rate leaves it as it was
+  if (!mRefreshLineEdit->text().isEmpty())
+  {
+    int lRate = mRefreshLineEdit->text().toInt(&lOk);
+    if (!lOk || lRate < 0 || lRate > mMaxRefreshRate)
+    {
+      QMessageBox::information(0, "Invalid entry",
+			       "Please enter a refresh rate between 0 and "+
+			       QString::number(mMaxRefreshRate),
+			       QMessageBox::Ok,
+			       QMessageBox::NoButton,
+			       QMessageBox::NoButton);
+      return;
+    }
+    mRefreshRate = lRate;
+    lOk = false;
+  }
+
   if (!mLineEdit->text().isEmpty())
   {
     lValue = mLineEdit->text().toDouble(&lOk);
@@ -67,10 +67,17 @@
 #include <q3vgroupbox.h>
 //#include <qhbuttongroup.h>
 #include <q3groupbox.h>
+#include <q3filedialog.h>
+#include <qinputdialog.h>
+#include <qlineedit.h>
+#include <qcheckbox.h>
+#include <qtimer.h>
+#include <qdatetime.h>
 //Added by qt3to4:
 #include <Q3HBoxLayout>
 #include <Q3VBoxLayout>
 #include <Q3HButtonGroup>
+#include <QtAlgorithms>
 
 #include "buildconfig.h"
 #include "types.h"
@@ -82,6 +89,10 @@
 #include "utility.h"
 #include "exception.h"
 #include "steerermainwindow.h"
+#include "sessionrecorder.h"
+#include "exportthread.h"
+#include "marshalarena.h"
+#include "steeringcommandbuilder.h"
 
 #include "ReG_Steer_Steerside.h"
 
@@ -98,8 +109,15 @@ ControlForm::ControlForm(QWidget *aParent, const char *aName, int aSimHandle,
     mIOTypeChkPtTable(kNULL),
     mCloseButton(kNULL), mDetachButton(kNULL), mStopButton(kNULL),
     mPauseButton(kNULL), mConsumeDataButton(kNULL),
-    mEmitDataButton(kNULL), mMutexPtr(aMutex)
+    mEmitDataButton(kNULL), mMutexPtr(aMutex), mExportThread(kNULL),
+    mCommandBuilder(kNULL),
+    mRefreshTimer(kNULL), mRefreshPending(false), mPlotsPending(false),
+    mUnskippedData(false),
+    mDisplayActive(true), mRefreshCount(0), mSkippedRefreshCount(0),
+    mRefreshMSecs(0), mSamplesSinceRefresh(0), mSamplesShown(0)
 {
+  mIOTypesPending[0] = mIOTypesPending[1] = false;
+
   REG_DBGCON("ControlForm");
 
   mHistoryPlotList.setAutoDelete( TRUE );
@@ -171,6 +189,25 @@ ControlForm::ControlForm(QWidget *aParent, const char *aName, int aSimHandle,
     lCmdGrpLayout->addWidget(mGridRestartChkPtButton);
   }
 
+  //--------------------------------------
+  // filter for the parameter tables
+  mFilterEdit = new QLineEdit(this, "paramfilter");
+  QToolTip::add(mFilterEdit, "Only show parameters whose labels contain "
+		"this text");
+  connect(mFilterEdit, SIGNAL(textChanged(const QString &)), this,
+	  SLOT(filterChangedSlot()));
+
+  mFilterRegExpBox = new QCheckBox("Regexp", this, "paramfilterregexp");
+  QToolTip::add(mFilterRegExpBox, "Treat the filter as a regular "
+		"expression");
+  connect(mFilterRegExpBox, SIGNAL(toggled(bool)), this,
+	  SLOT(filterChangedSlot()));
+
+  Q3HBoxLayout *lFilterLayout = new Q3HBoxLayout(-1, "filterlayout");
+  lFilterLayout->addWidget(new QLabel("Filter:", this));
+  lFilterLayout->addWidget(mFilterEdit);
+  lFilterLayout->addWidget(mFilterRegExpBox);
+
   //--------------------------------------
   // set up table for monitored parameters
   mMonTableLabel = new TableLabel("Monitored Parameters",
@@ -306,11 +343,21 @@ ControlForm::ControlForm(QWidget *aParent, const char *aName, int aSimHandle,
   connect(this, SIGNAL(detachFromApplicationForErrorSignal()),
 	  aApplication, SLOT(detachFromApplicationForErrorSlot()));
 
+  // Everything the tables send goes through one builder, which logs
+  // it if the session is being recorded
+  mCommandBuilder = new SteeringCommandBuilder(mSimHandle, mMutexPtr,
+					       aApplication->getArena());
+  mCommandBuilder->setRecorder(aApplication->getRecorder());
+  mSteerParamTable->setCommandBuilder(mCommandBuilder);
+  mIOTypeSampleTable->setCommandBuilder(mCommandBuilder);
+  mIOTypeChkPtTable->setCommandBuilder(mCommandBuilder);
+
   //---------------------------------------------
   // the overall layout
   Q3VBoxLayout *lEditLayout = new Q3VBoxLayout(this, 0, 0, "editlayout");
 
   lEditLayout->addLayout(lCmdGrpLayout);
+  lEditLayout->addLayout(lFilterLayout);
   lEditLayout->addLayout(lTopLeftLayout);
   lEditLayout->addLayout(lSteerLayout);
   lEditLayout->addLayout(lSampleLayout);
@@ -326,6 +373,11 @@ ControlForm::ControlForm(QWidget *aParent, const char *aName, int aSimHandle,
   // Close button only becomes enabled when detach from application
   mCloseButton->setEnabled(FALSE);
 
+  // Started by setDisplayRefreshRate() - until then the display is
+  // refreshed for every status message
+  mRefreshTimer = new QTimer(this);
+  connect(mRefreshTimer, SIGNAL(timeout()), this, SLOT(refreshDisplaySlot()));
+
   // Whether we are in mode where user is selecting a history plot
   mUserChoosePlotMode = false;
   mParamToAdd = NULL;
@@ -334,6 +386,12 @@ ControlForm::ControlForm(QWidget *aParent, const char *aName, int aSimHandle,
 ControlForm::~ControlForm()
 {
   REG_DBGDST("ControlForm");
+  // The export works on its own copies of the data
+  if(mExportThread){
+    mExportThread->wait();
+    delete mExportThread;
+  }
+  delete mCommandBuilder;
 }
 
 void
@@ -345,9 +403,141 @@ ControlForm::updateParameters(const bool isStatusMsg)
   // update steered parameters
   updateParameters(true, isStatusMsg);
 
-  if(!mHistoryPlotList.isEmpty()){
-    // Emit a SIGNAL so that any HistoryPlots can update
-    emit paramUpdateSignal();
+  parametersChanged(isStatusMsg);
+}
+
+//--------------------------------------------------------------------
+
+void
+ControlForm::parametersChanged(const bool isStatusMsg)
+{
+  if(isStatusMsg){
+    mSamplesSinceRefresh++;
+  }
+  mRefreshPending = true;
+  mPlotsPending = true;
+  mUnskippedData = true;
+
+  if(!mRefreshTimer->isActive()){
+    refreshDisplaySlot();
+  }
+}
+
+//--------------------------------------------------------------------
+
+void
+ControlForm::refreshDisplaySlot()
+{
+  if(mRefreshPending && !mDisplayActive){
+    // Nobody can see the tables - leave the changes to be shown by
+    // setDisplayActive().  The timer keeps ticking but only a tick
+    // with new data to show is a refresh saved.
+    if(mUnskippedData){
+      mUnskippedData = false;
+      mSkippedRefreshCount++;
+    }
+  }
+  else if(mRefreshPending){
+    mRefreshPending = false;
+    mUnskippedData = false;
+
+    QTime lClock;
+    lClock.start();
+
+    // Repaint the cells that have changed since the last refresh (the
+    // batches were opened by applyParameters())
+    mMonParamTable->endUpdate();
+    mSteerParamTable->endUpdate();
+
+    // When the refresh rate is limited the labels say how many status
+    // messages each refresh covers
+    int lSamples = mRefreshTimer->isActive() ? mSamplesSinceRefresh : 0;
+    if(lSamples != mSamplesShown){
+      QString lSuffix;
+      if(lSamples){
+	lSuffix = QString(" (%1 sample%2 since last refresh)").arg(lSamples).
+	  arg(lSamples == 1 ? "" : "s");
+      }
+      mMonTableLabel->setText("Monitored Parameters" + lSuffix);
+      mSteerTableLabel->setText("Steered Parameters" + lSuffix);
+      mSamplesShown = lSamples;
+    }
+    mSamplesSinceRefresh = 0;
+
+    mRefreshCount++;
+    mRefreshMSecs += lClock.elapsed();
+  }
+
+  if(mPlotsPending){
+    mPlotsPending = false;
+    if(receivers(SIGNAL(paramUpdateSignal())) > 0){
+      // Emit a SIGNAL so that any HistoryPlots (or EnsemblePlots) can
+      // update
+      emit paramUpdateSignal();
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+
+void
+ControlForm::setDisplayActive(bool aActive)
+{
+  if(aActive == mDisplayActive){
+    return;
+  }
+  mDisplayActive = aActive;
+
+  if(!mDisplayActive){
+    return;
+  }
+
+  // Catch up with whatever arrived while we were hidden
+  try{
+    for(int i = 0; i < 2; i++){
+      if(mIOTypesPending[i]){
+	mIOTypesPending[i] = false;
+	updateIOTypes(i == 1);
+      }
+    }
+  }
+  catch (SteererException StEx){
+    StEx.print();
+  }
+  refreshDisplaySlot();
+}
+
+//--------------------------------------------------------------------
+
+void
+ControlForm::filterChangedSlot()
+{
+  bool lRegExp = mFilterRegExpBox->isChecked();
+  QString lPattern = mFilterEdit->text();
+
+  bool lOk = mMonParamTable->setFilter(lPattern, lRegExp) &&
+    mSteerParamTable->setFilter(lPattern, lRegExp);
+
+  // Leave the last valid filter in place while a regular expression
+  // is being typed, but show that this one isn't valid
+  QPalette lPalette = mFilterEdit->palette();
+  lPalette.setColor(QPalette::Text, lOk ? Qt::black : Qt::red);
+  mFilterEdit->setPalette(lPalette);
+}
+
+//--------------------------------------------------------------------
+
+void
+ControlForm::setDisplayRefreshRate(int aRate)
+{
+  if(aRate > 0){
+    // A zero interval would fire on every pass of the event loop
+    mRefreshTimer->start(qMax(1, 1000/aRate));
+  }
+  else{
+    // Back to refreshing for every message - catch up first
+    mRefreshTimer->stop();
+    refreshDisplaySlot();
   }
 }
 
@@ -361,101 +551,120 @@ ControlForm::updateParameters(const bool aSteeredFlag,
   // aSteerFlag determines whether get monitored or steered parameters
 
   int lNumParams = 0;
-  bool lCleanUpFlag = false;
-  Param_details_struct *lParamDetails = kNULL;
 
-  try
+  // find out number of parameters that library is going to give us
+  mMutexPtr->lock();
+  if(Get_param_number(mSimHandle, aSteeredFlag, &lNumParams)
+     != REG_SUCCESS){  //ReG library
+    mMutexPtr->unlock();
+    THROWEXCEPTION("Get_param_number");
+  }
+  mMutexPtr->unlock();
+
+  if (lNumParams > 0)
     {
-      // find out number of parameters that library is going to give us
+      // the array for Get_param_values belongs to the application's
+      // arena - it is only reallocated when it needs to grow and, as
+      // nothing is allocated here, any exception (rethrown to
+      // Application::processNextMessage) needs no clean up
+      Param_details_struct *lParamDetails =
+	mApplication->getArena()->paramDetails(lNumParams);
+
+      // get parameter data from library and update tables on gui
       mMutexPtr->lock();
-      if(Get_param_number(mSimHandle, aSteeredFlag, &lNumParams)
-	 != REG_SUCCESS){  //ReG library
+      if (Get_param_values(mSimHandle,		//ReG library
+			   aSteeredFlag,
+			   lNumParams,
+			   lParamDetails) == REG_SUCCESS){
 	mMutexPtr->unlock();
-	THROWEXCEPTION("Get_param_number");
-      }
-      mMutexPtr->unlock();
-
-      if (lNumParams > 0)
-	{
-	  // flag that cleanup required - don't like this but checking
-	  // for kNULL didn't work
-	  lCleanUpFlag = true;
-
-	  // set up arrays of appropriate size for Get_param_values
-	  lParamDetails = new Param_details_struct[lNumParams];
-
-	  // point to relevent table - i.e. steered or monitored
-	  ParameterTable *lTablePtr;
-	  if (aSteeredFlag)
-	    lTablePtr = mSteerParamTable;
-	  else
-	    lTablePtr = mMonParamTable;
-
-	  // get parameter data from library and update tables on gui
-	  mMutexPtr->lock();
-	  if (Get_param_values(mSimHandle,		//ReG library
-			       aSteeredFlag,
-			       lNumParams,
-			       lParamDetails) == REG_SUCCESS){
-	    mMutexPtr->unlock();
-
-	    for (int i=0; i<lNumParams; i++){
-	      //check if already exists - if so only update value
-	      if (!(lTablePtr->updateRow(lParamDetails[i].handle,
-					 lParamDetails[i].value,
-					 isStatusMsg))){
-
-		// must be new parameter so add it
-		if (aSteeredFlag){
-		  ((SteeredParameterTable*)lTablePtr)->addRow(lParamDetails[i].handle,
-							      lParamDetails[i].label,
-							      lParamDetails[i].value,
-							      lParamDetails[i].type,
-							      lParamDetails[i].min_val,
-							      lParamDetails[i].max_val);
-		}
-		else{
-		  lTablePtr->addRow(lParamDetails[i].handle,
-				    lParamDetails[i].label,
-				    lParamDetails[i].value,
-				    lParamDetails[i].type);
-		}
-	      }
-	    } //for lNumParams
-
-	    // Adjust width of first column holding labels
-	    lTablePtr->adjustColumn(0);
-
-	  } // if Get_param_values
-	  else{
-
-	    mMutexPtr->unlock();
-	    THROWEXCEPTION("Get_param_values");
+
+	SessionRecorder *lRecorder = isStatusMsg ?
+	  mApplication->getRecorder() : kNULL;
+
+	if (lRecorder){
+	  for (int i=0; i<lNumParams; i++){
+	    lRecorder->addValue(lParamDetails[i].handle,
+				lParamDetails[i].type,
+				aSteeredFlag,
+				lParamDetails[i].label,
+				lParamDetails[i].value);
 	  }
+	}
 
-	  // delete local arrays
-	  delete [] lParamDetails;
+	applyParameters(aSteeredFlag, lParamDetails, lNumParams,
+			isStatusMsg);
 
-	} // if lNumParams > 0
+      } // if Get_param_values
+      else{
 
-      // finally check for any parameters no longer present and flag
-      // as unregistered SMR XXX to do (ReG library not support unRegister yet)
+	mMutexPtr->unlock();
+	THROWEXCEPTION("Get_param_values");
+      }
 
-    } //try
+    } // if lNumParams > 0
 
-  catch (SteererException StEx)
-    {
-      // clean up
-      if (lCleanUpFlag)
-	{
-	  delete [] lParamDetails;
-	}
+  // finally check for any parameters no longer present and flag
+  // as unregistered SMR XXX to do (ReG library not support unRegister yet)
+
+} // ::updateParameters
+
+//--------------------------------------------------------------------
 
-      // rethrow to Application::processNextMessage
-      throw StEx;
+void
+ControlForm::applyParameters(const bool aSteeredFlag,
+			     const Param_details_struct *aParamDetails,
+			     const int aNumParams, const bool isStatusMsg)
+{
+  // point to relevent table - i.e. steered or monitored
+  ParameterTable *lTablePtr;
+  if (aSteeredFlag)
+    lTablePtr = mSteerParamTable;
+  else
+    lTablePtr = mMonParamTable;
+
+  // Only changed cells are repainted, and only at the next refresh
+  // (see refreshDisplaySlot()).  If the last batch hasn't been shown
+  // yet this one is added to it.
+  lTablePtr->beginUpdate();
+
+  for (int i=0; i<aNumParams; i++){
+    //check if already exists - if so only update value
+    if (!(lTablePtr->updateRow(aParamDetails[i].handle,
+			       aParamDetails[i].value,
+			       isStatusMsg))){
+
+      // must be new parameter so add it
+      if (aSteeredFlag){
+	((SteeredParameterTable*)lTablePtr)->addRow(aParamDetails[i].handle,
+						    aParamDetails[i].label,
+						    aParamDetails[i].value,
+						    aParamDetails[i].type,
+						    aParamDetails[i].min_val,
+						    aParamDetails[i].max_val);
+      }
+      else{
+	lTablePtr->addRow(aParamDetails[i].handle,
+			  aParamDetails[i].label,
+			  aParamDetails[i].value,
+			  aParamDetails[i].type);
+      }
     }
+  } //for aNumParams
+}
 
-} // ::updateParameters
+//--------------------------------------------------------------------
+
+void
+ControlForm::replayParameters(const Param_details_struct *aMonDetails,
+			      const int aNumMon,
+			      const Param_details_struct *aSteeredDetails,
+			      const int aNumSteered)
+{
+  applyParameters(false, aMonDetails, aNumMon, true);
+  applyParameters(true, aSteeredDetails, aNumSteered, true);
+
+  parametersChanged(true);
+}
 
 //--------------------------------------------------------------------
 
@@ -476,14 +685,13 @@ ControlForm::updateIOTypes(bool aChkPtType)
 
   IOTypeTable	*lIOTypeTablePtr;
   int		lNumTypes;
-  int		*lHandles = kNULL;
-  int		*lTypes = kNULL;
-  int		*lVals = kNULL;
-  char		**lLabels = kNULL;
-  bool		lCleanUpFlag = false;
   int		lStatus = REG_FAILURE;
-  int		i;
 
+  // Nothing to see - fetch them when the form is shown again
+  if (!mDisplayActive){
+    mIOTypesPending[aChkPtType ? 1 : 0] = true;
+    return;
+  }
 
   // point to relevant table - sample or checkpoint
   if (aChkPtType)
@@ -492,108 +700,61 @@ ControlForm::updateIOTypes(bool aChkPtType)
     lIOTypeTablePtr = mIOTypeSampleTable;
 
 
-  try
+  mMutexPtr->lock();
+  if (aChkPtType){
+    lStatus = Get_chktype_number(mSimHandle, &lNumTypes);	//ReG library
+  }
+  else{
+    lStatus = Get_iotype_number(mSimHandle, &lNumTypes);	//ReG library
+  }
+  mMutexPtr->unlock();
+
+  if(lStatus != REG_SUCCESS)
+    THROWEXCEPTION("Get_iotype_number");
+
+  REG_DBGMSG1("Number IO/Chk Types: Monitored = ", lNumTypes);
+
+  if (lNumTypes>0)
   {
+    // arrays for Get_iotypes belong to the application's arena and
+    // are only reallocated when they need to grow.  Note that
+    // REG_MAX_STRING_LENGTH is max string length imposed by library
+    MarshalArena *lArena = mApplication->getArena();
+    int *lHandles = lArena->ints(MarshalArena::kHANDLES, lNumTypes);
+    int *lTypes = lArena->ints(MarshalArena::kTYPES, lNumTypes);
+    int *lVals = lArena->ints(MarshalArena::kVALUES, lNumTypes);
+    char **lLabels = lArena->strings(MarshalArena::kLABELS, lNumTypes);
 
     mMutexPtr->lock();
     if (aChkPtType){
-      lStatus = Get_chktype_number(mSimHandle, &lNumTypes);	//ReG library
+      lStatus = Get_chktypes(mSimHandle,     		//ReG library
+			     lNumTypes,
+			     lHandles,
+			     lLabels,
+			     lTypes,
+			     lVals);
     }
     else{
-      lStatus = Get_iotype_number(mSimHandle, &lNumTypes);	//ReG library
+      lStatus = Get_iotypes(mSimHandle,      		//ReG library
+			    lNumTypes,
+			    lHandles,
+			    lLabels,
+			    lTypes,
+			    lVals);
     }
     mMutexPtr->unlock();
 
-    if(lStatus != REG_SUCCESS)
-      THROWEXCEPTION("Get_iotype_number");
-
-    REG_DBGMSG1("Number IO/Chk Types: Monitored = ", lNumTypes);
-
-    if (lNumTypes>0)
-    {
-      lCleanUpFlag = true;
-
-      // setup arrays of appropriate size for Get_param_values
-      // note that REG_MAX_STRING_LENGTH is max string length imposed by library
-      lHandles = new int[lNumTypes];
-      lTypes = new int[lNumTypes];
-      lVals = new int[lNumTypes];
-      lLabels = new char *[lNumTypes];
-      for(i=0; i<lNumTypes; i++)
-      {
-	lLabels[i] = new char[REG_MAX_STRING_LENGTH + 1];
-      }
-
-      mMutexPtr->lock();
-      if (aChkPtType){
-	lStatus = Get_chktypes(mSimHandle,     		//ReG library
-			       lNumTypes,
-			       lHandles,
-			       lLabels,
-			       lTypes,
-			       lVals);
-      }
-      else{
-	lStatus = Get_iotypes(mSimHandle,      		//ReG library
-			      lNumTypes,
-			      lHandles,
-			      lLabels,
-			      lTypes,
-			      lVals);
-      }
-      mMutexPtr->unlock();
-
-      if (lStatus == REG_SUCCESS)
-      {
-	for (i=0; i<lNumTypes; i++)
-	{
-	  //check if already exists - if so only update frequency value
-	  if (!(lIOTypeTablePtr->updateRow(lHandles[i], lVals[i])))
-	  {
-	    // new IOTypee so add it
-	    lIOTypeTablePtr->addRow(lHandles[i], lLabels[i], lVals[i], lTypes[i]);
-	  }
-
-	} //for lNumTypes
-      } // if Get_IOType_values
-      else
-	THROWEXCEPTION("Get_iotypes");
-
-      // note: no need to check for any IOType no longer present
-      // as iotype cannot be unregistered
-
-      // delete local arrays
-      delete [] lHandles;
-      delete [] lTypes;
-      delete [] lVals;
-      for(i=0; i<lNumTypes; i++)
-	{
-	  delete [] lLabels[i];
-	}
-      delete [] lLabels;
-
-    } //if (lNumTypes>0)
-
-  } //try
+    if (lStatus != REG_SUCCESS)
+      THROWEXCEPTION("Get_iotypes");
 
-  catch (SteererException StEx)
-  {
-    if (lCleanUpFlag)
-    {
-      delete [] lHandles;
-      delete [] lTypes;
-      delete [] lVals;
-      for(int i=0; i<lNumTypes; i++)
-	{
-	  delete [] lLabels[i];
-	}
-      delete [] lLabels;
-    }
+    // only rows whose frequency has changed are touched
+    lIOTypeTablePtr->updateRows(lNumTypes, lHandles, lLabels, lVals,
+				lTypes);
 
-    // rethrow to Application::processNextMessage
-    throw StEx;
-  }
+    // note: no need to check for any IOType no longer present
+    // as iotype cannot be unregistered
 
+  } //if (lNumTypes>0)
 
 } // ::updateIOTypes
 
@@ -603,6 +764,12 @@ ControlForm::disableAll(const bool aUnRegister)
 {
   // clear and disable all parts of form as application has detached
 
+  // Show the last values received before anything is cleared (the
+  // IOTypes can't be fetched once the application has gone)
+  mRefreshTimer->stop();
+  mIOTypesPending[0] = mIOTypesPending[1] = false;
+  refreshDisplaySlot();
+
   mSteerParamTable->clearAndDisableForDetach(aUnRegister);
   mMonParamTable->clearAndDisableForDetach(aUnRegister);
   mIOTypeSampleTable->clearAndDisableForDetach();
@@ -697,7 +864,8 @@ ControlForm::setEnabledClose(const bool aEnable)
 void
 ControlForm::enableParamButtonsSlot()
 {
-  mEmitButton->setEnabled(TRUE);
+  // Nothing can be steered once detached (or when replaying)
+  mEmitButton->setEnabled(mSteerParamTable->getAppAttached());
 }
 
 void
@@ -762,29 +930,22 @@ void ControlForm::setEmitButtonStateSlot(const bool aEnable){
 void
 ControlForm::emitAllValuesSlot()
 {
-  // emit both parameter values and iotype frequencies
-  int lReGStatus = REG_FAILURE;
+  // emit both parameter values and iotype frequencies in one go
   try
   {
-
-    // set the values in library
-    int lCount = mSteerParamTable->setNewParamValuesInLib();
-    lCount += mIOTypeSampleTable->setNewFreqValuesInLib();
-    lCount += mIOTypeChkPtTable->setNewFreqValuesInLib();
+    mCommandBuilder->reset();
+    int lCount = mSteerParamTable->addNewParamValues(mCommandBuilder);
+    lCount += mIOTypeSampleTable->addNewFrequencies(mCommandBuilder);
+    lCount += mIOTypeChkPtTable->addNewFrequencies(mCommandBuilder);
 
     if (lCount > 0)
     {
-      // call ReG library function to "emit" values to steered application
-      mMutexPtr->lock();
-      lReGStatus = Emit_control(mSimHandle,		//ReG library
-				0,
-				NULL,
-				NULL);
-      mMutexPtr->unlock();
-
-      if (lReGStatus != REG_SUCCESS)
-	THROWEXCEPTION("Emit_contol");
+      mCommandBuilder->send();
 
+      // clear the cells in the tables
+      mSteerParamTable->clearNewValues();
+      mIOTypeSampleTable->clearNewValues();
+      mIOTypeChkPtTable->clearNewValues();
     }
 
   } //try
@@ -895,6 +1056,236 @@ void ControlForm::setPauseButtonLabel(QString aLabel){
   }
 }
 
+//--------------------------------------------------------------------
+Parameter *ControlForm::findParameterFromLabel(const QString &aLabel)
+{
+  if(!mMonParamTable){
+    return kNULL;
+  }
+  return mMonParamTable->findParameterFromLabel(aLabel);
+}
+
+//--------------------------------------------------------------------
+QStringList ControlForm::getParameterLabels()
+{
+  QStringList lLabels;
+
+  if(mMonParamTable){
+    lLabels += mMonParamTable->getParameterLabels();
+  }
+  if(mSteerParamTable){
+    lLabels += mSteerParamTable->getParameterLabels();
+  }
+  return lLabels;
+}
+
+//--------------------------------------------------------------------
+int ControlForm::broadcastValues(const ParameterPreset &aPreset,
+				 QStringList &aRejected)
+{
+  if (!mSteerParamTable || !mSteerParamTable->getAppAttached()){
+    aRejected.append("not attached");
+    return 0;
+  }
+
+  int lCount = 0;
+  try
+  {
+    mCommandBuilder->reset();
+    lCount = mSteerParamTable->addPresetValues(aPreset, mCommandBuilder,
+					       aRejected);
+    if (lCount > 0)
+      mCommandBuilder->send();
+  }
+
+  catch (SteererException StEx)
+  {
+    // as for the emit buttons, but the caller reports it
+    StEx.print();
+    aRejected.append(QString("failed (") + StEx.getErrorMsg() + ")");
+    emit detachFromApplicationForErrorSignal();
+    return -1;
+  }
+
+  return lCount;
+}
+
+//--------------------------------------------------------------------
+/** Sequence numbers go up, so the rows of a block covering a range of
+ *  them are found by binary search */
+static void seqRange(const double *aSeqNums, int aNum, int aFirst,
+		     int aLast, int &aStart, int &aEnd)
+{
+  aStart = qLowerBound(aSeqNums, aSeqNums + aNum, (double)aFirst) - aSeqNums;
+  aEnd = qUpperBound(aSeqNums, aSeqNums + aNum, (double)aLast) - aSeqNums;
+  if(aEnd < aStart) aEnd = aStart;
+}
+
+//--------------------------------------------------------------------
+/** Add rows [aStart, aEnd) of a block to an export.  Column j has
+ *  aLengths[j] values starting at row aFirstRows[j] of the block, so
+ *  only the part of it that overlaps the rows wanted is copied. */
+static void addRowRange(ExportThread *aExporter,
+			const QVector<const double *> &aColumns,
+			const QVector<int> &aFirstRows,
+			const QVector<int> &aLengths, int aStart, int aEnd)
+{
+  int lNumCols = aColumns.count();
+  QVector<const double *> lColumns(lNumCols);
+  QVector<int> lFirstRows(lNumCols);
+  QVector<int> lLengths(lNumCols);
+
+  for(int j=0; j<lNumCols; j++){
+    int lFrom = qMax(aStart, aFirstRows[j]);
+    int lTo = qMin(aEnd, aFirstRows[j] + aLengths[j]);
+    lColumns[j] = aColumns[j] ? aColumns[j] + (lFrom - aFirstRows[j]) : NULL;
+    lFirstRows[j] = lFrom - aStart;
+    lLengths[j] = (lTo > lFrom && aColumns[j]) ? lTo - lFrom : 0;
+  }
+  aExporter->addBlockCopy(lColumns, aEnd - aStart, lFirstRows, lLengths);
+}
+
+//--------------------------------------------------------------------
+void ControlForm::exportParameters(){
+
+  int i;
+  bool ok;
+
+  if(mExportThread){
+    QMessageBox::information(this, "Export",
+			     "Please wait for the current export to finish.");
+    return;
+  }
+
+  Parameter *lSeqParam = findParameterFromLabel("SEQUENCE_NUM");
+  if(!lSeqParam){
+    QMessageBox::information(this, "Export",
+			     "This application has no SEQUENCE_NUM to line "
+			     "up the parameters with.");
+    return;
+  }
+  ParameterHistory *lSeqHist = lSeqParam->mParamHist;
+
+  // Data from before we attached (the log) followed by what we've
+  // received since.  The log may overlap with what we received so
+  // only the part of it before the first live row is used.
+  int lNumLive = lSeqHist->mArrayPos;
+  int lNumHist = lSeqHist->mPreviousHistArraySize;
+  const double *lSeqLive = lSeqHist->ptrToArray();
+  const double *lSeqLog = lSeqHist->mPtrPreviousHistArray;
+  if(!lSeqLog) lNumHist = 0;
+  // Length of the whole log, which the other logs line up with
+  int lSeqLogSize = lNumHist;
+  if(lNumLive > 0 && lNumHist > 0){
+    lNumHist = qLowerBound(lSeqLog, lSeqLog + lNumHist, lSeqLive[0]) -
+      lSeqLog;
+  }
+  if(lNumHist + lNumLive == 0){
+    QMessageBox::information(this, "Export", "There is no data to export.");
+    return;
+  }
+
+  int lMin = (int)(lNumHist ? lSeqLog[0] : lSeqLive[0]);
+  int lMax = (int)(lNumLive ? lSeqLive[lNumLive-1] : lSeqLog[lNumHist-1]);
+  int lFirst = QInputDialog::getInteger("Export", "First sequence number:",
+					lMin, lMin, lMax, 1, &ok, this);
+  if(!ok) return;
+  int lLast = QInputDialog::getInteger("Export", "Last sequence number:",
+				       lMax, lFirst, lMax, 1, &ok, this);
+  if(!ok) return;
+
+  QString lFilter;
+  QString lFileName = Q3FileDialog::getSaveFileName(".",
+			  "Data (*.dat);;Binary columns (*.bin);;"
+			  "Compressed binary columns (*.binz)", this,
+			  "export dialog",
+			  "Choose a name for the data file",
+			  &lFilter);
+  if(lFileName.isNull()){
+    return;
+  }
+  if(!lFileName.endsWith(".dat") && !lFileName.endsWith(".bin") &&
+     !lFileName.endsWith(".binz")){
+    lFileName.append(lFilter.contains("binz") ? ".binz" :
+		     lFilter.contains("bin") ? ".bin" : ".dat");
+  }
+
+  // Every parameter that holds numbers, with the sequence number first
+  QStringList lLabels("SEQUENCE_NUM");
+  QVector<const double *> lHist(1, lSeqLog);
+  QVector<int> lHistFirst(1, 0);
+  QVector<int> lHistLen(1, lNumHist);
+  QVector<const double *> lLive(1, lSeqLive);
+  QVector<int> lLiveFirst(1, 0);
+  QVector<int> lLiveLen(1, lNumLive);
+
+  QStringList lAll = getParameterLabels();
+  for(i=0; i<lAll.count(); i++){
+    Parameter *lParam = findParameterFromLabel(lAll[i]);
+    if(!lParam || lParam == lSeqParam || lParam->getType() == REG_CHAR){
+      continue;
+    }
+    ParameterHistory *lHistory = lParam->mParamHist;
+    lLabels.append(lAll[i]);
+
+    // Every status message adds a value to every parameter, so logs
+    // and live data both line up at the end - a parameter that
+    // appeared part-way through has a gap at the start.  (Only the
+    // first lNumHist rows of the log are exported, which
+    // addRowRange takes care of.)
+    int lLen = 0;
+    if(lHistory->mPtrPreviousHistArray){
+      lLen = qMin(lHistory->mPreviousHistArraySize, lSeqLogSize);
+    }
+    lHist.append(lHistory->mPtrPreviousHistArray ?
+		 lHistory->mPtrPreviousHistArray +
+		 (lHistory->mPreviousHistArraySize - lLen) : NULL);
+    lHistFirst.append(lSeqLogSize - lLen);
+    lHistLen.append(lLen);
+
+    lLen = qMin(lHistory->mArrayPos, lNumLive);
+    lLive.append(lHistory->ptrToArray() + (lHistory->mArrayPos - lLen));
+    lLiveFirst.append(lNumLive - lLen);
+    lLiveLen.append(lLen);
+  }
+
+  ExportThread *lExporter = new ExportThread(lFileName);
+  lExporter->setComment("Data exported from RealityGrid Qt Steering Client "
+			"(missing values are nan)");
+  lExporter->setLabels(lLabels);
+
+  int lStart, lEnd;
+  if(lNumHist > 0){
+    seqRange(lSeqLog, lNumHist, lFirst, lLast, lStart, lEnd);
+    addRowRange(lExporter, lHist, lHistFirst, lHistLen, lStart, lEnd);
+  }
+  if(lNumLive > 0){
+    seqRange(lSeqLive, lNumLive, lFirst, lLast, lStart, lEnd);
+    addRowRange(lExporter, lLive, lLiveFirst, lLiveLen, lStart, lEnd);
+  }
+
+  mExportThread = lExporter;
+  connect(mExportThread, SIGNAL(finished()), this, SLOT(exportFinishedSlot()));
+  mExportThread->startWithProgress(this, "Exporting " +
+				   QString(mApplication->name()) + "...");
+}
+
+//--------------------------------------------------------------------
+void ControlForm::exportFinishedSlot(){
+
+  if(!mExportThread){
+    return;
+  }
+
+  bool lFailed = !mExportThread->succeeded() && !mExportThread->wasCancelled();
+  mExportThread->deleteLater();
+  mExportThread = kNULL;
+
+  if(lFailed){
+    QMessageBox::warning(this, "Export", "Failed to save file.");
+  }
+}
+
 //--------------------------------------------------------------------
 void ControlForm::newHistoryPlot(Parameter *xParamPtr, Parameter *yParamPtr,
 				 QString xLabel, QString yLabel){
@@ -0,0 +1,314 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file densitygrid.cpp
+    @brief Implementation of the DensityGrid class - incrementally
+    updated 2D histogram used for density plots */
+
+#include <math.h>
+
+#include "buildconfig.h"
+#include "densitygrid.h"
+
+/// True unless aVal is infinite or NaN
+static inline bool isFiniteValue(double aVal)
+{
+  return (aVal - aVal) == 0.0;
+}
+
+DensityGrid::DensityGrid(int aNumBinsX, int aNumBinsY)
+  : QwtRasterData(QwtDoubleRect(0.0, 0.0, 1.0, 1.0)),
+    mNumBinsX(aNumBinsX), mNumBinsY(aNumBinsY),
+    mX0(0.0), mY0(0.0), mDx(1.0), mDy(1.0), mHaveExtent(false),
+    mMaxCount(0), mNumPoints(0)
+{
+  // Pairwise merging needs an even number of bins
+  mNumBinsX += (mNumBinsX % 2);
+  mNumBinsY += (mNumBinsY % 2);
+  mBins.fill(0, mNumBinsX*mNumBinsY);
+}
+
+DensityGrid::~DensityGrid()
+{
+}
+
+//---------------------------------------------------------------------------
+QwtRasterData *DensityGrid::copy() const
+{
+  return new DensityGrid(*this);
+}
+
+//---------------------------------------------------------------------------
+double DensityGrid::value(double x, double y) const
+{
+  int i, j;
+  double lX = (x - mX0)/mDx;
+  double lY = (y - mY0)/mDy;
+
+  if(lX < 0.0 || lY < 0.0 || lX >= mNumBinsX || lY >= mNumBinsY){
+    return 0.0;
+  }
+  i = (int)lX;
+  j = (int)lY;
+
+  return log10(1.0 + (double)mBins[j*mNumBinsX + i]);
+}
+
+//---------------------------------------------------------------------------
+QwtDoubleInterval DensityGrid::range() const
+{
+  double lMax = log10(1.0 + (double)mMaxCount);
+  if(lMax <= 0.0){
+    lMax = 1.0;
+  }
+  return QwtDoubleInterval(0.0, lMax);
+}
+
+//---------------------------------------------------------------------------
+QSize DensityGrid::rasterHint(const QwtDoubleRect &aRect) const
+{
+  int lNx = (int)ceil(aRect.width()/mDx);
+  int lNy = (int)ceil(aRect.height()/mDy);
+
+  if(lNx < 1) lNx = 1;
+  if(lNy < 1) lNy = 1;
+  if(lNx > mNumBinsX) lNx = mNumBinsX;
+  if(lNy > mNumBinsY) lNy = mNumBinsY;
+
+  return QSize(lNx, lNy);
+}
+
+//---------------------------------------------------------------------------
+void DensityGrid::clear()
+{
+  mBins.fill(0);
+  mMaxCount = 0;
+  mNumPoints = 0;
+  mHaveExtent = false;
+  mX0 = mY0 = 0.0;
+  mDx = mDy = 1.0;
+  setBoundingRect(QwtDoubleRect(0.0, 0.0, 1.0, 1.0));
+}
+
+//---------------------------------------------------------------------------
+int DensityGrid::count() const
+{
+  return mNumPoints;
+}
+
+//---------------------------------------------------------------------------
+QwtLinearColorMap DensityGrid::colourMap()
+{
+  // Empty bins take the colour of the plot canvas
+  QwtLinearColorMap lColourMap(Qt::darkGray, Qt::red);
+  lColourMap.addColorStop(0.01, Qt::darkBlue);
+  lColourMap.addColorStop(0.35, Qt::cyan);
+  lColourMap.addColorStop(0.7, Qt::yellow);
+
+  return lColourMap;
+}
+
+//---------------------------------------------------------------------------
+void DensityGrid::addPoints(const double *aX, const double *aY, int aNum)
+{
+  int i, lIx, lIy;
+  unsigned int lCount;
+  bool lFound = false;
+  double lXMin = 0.0, lXMax = 0.0, lYMin = 0.0, lYMax = 0.0;
+
+  if(aNum <= 0){
+    return;
+  }
+
+  // Size the grid for the whole batch up front so that binning the
+  // samples needs no checks
+  for(i = 0; i < aNum; i++){
+    if(!isFiniteValue(aX[i]) || !isFiniteValue(aY[i])){
+      continue;
+    }
+    if(!lFound){
+      lXMin = lXMax = aX[i];
+      lYMin = lYMax = aY[i];
+      lFound = true;
+      continue;
+    }
+    if(aX[i] < lXMin) lXMin = aX[i];
+    else if(aX[i] > lXMax) lXMax = aX[i];
+    if(aY[i] < lYMin) lYMin = aY[i];
+    else if(aY[i] > lYMax) lYMax = aY[i];
+  }
+  if(!lFound){
+    return;
+  }
+  include(lXMin, lXMax, lYMin, lYMax);
+
+  unsigned int *lBins = mBins.data();
+
+  for(i = 0; i < aNum; i++){
+    if(!isFiniteValue(aX[i]) || !isFiniteValue(aY[i])){
+      continue;
+    }
+    lIx = (int)((aX[i] - mX0)/mDx);
+    lIy = (int)((aY[i] - mY0)/mDy);
+    // Guard against rounding at the upper edges
+    if(lIx >= mNumBinsX) lIx = mNumBinsX - 1;
+    if(lIy >= mNumBinsY) lIy = mNumBinsY - 1;
+
+    lCount = ++lBins[lIy*mNumBinsX + lIx];
+    if(lCount > mMaxCount){
+      mMaxCount = lCount;
+    }
+    mNumPoints++;
+  }
+}
+
+//---------------------------------------------------------------------------
+void DensityGrid::include(double aXMin, double aXMax,
+			  double aYMin, double aYMax)
+{
+  double lSpan;
+
+  if(!mHaveExtent){
+    // Start off with the first batch filling the middle half of the
+    // grid so that a little drift costs nothing.  A degenerate
+    // batch gets an extent based on its magnitude.
+    lSpan = aXMax - aXMin;
+    if(lSpan <= 0.0){
+      lSpan = (aXMin != 0.0 ? 0.01*fabs(aXMin) : 1.0);
+    }
+    mDx = 2.0*lSpan/mNumBinsX;
+    mX0 = 0.5*(aXMin + aXMax) - 0.5*mNumBinsX*mDx;
+
+    lSpan = aYMax - aYMin;
+    if(lSpan <= 0.0){
+      lSpan = (aYMin != 0.0 ? 0.01*fabs(aYMin) : 1.0);
+    }
+    mDy = 2.0*lSpan/mNumBinsY;
+    mY0 = 0.5*(aYMin + aYMax) - 0.5*mNumBinsY*mDy;
+
+    mHaveExtent = true;
+  }
+
+  while(aXMin < mX0){
+    merge(0, false);
+  }
+  while(aXMax >= mX0 + mNumBinsX*mDx){
+    merge(0, true);
+  }
+  while(aYMin < mY0){
+    merge(1, false);
+  }
+  while(aYMax >= mY0 + mNumBinsY*mDy){
+    merge(1, true);
+  }
+
+  setBoundingRect(QwtDoubleRect(mX0, mY0, mNumBinsX*mDx, mNumBinsY*mDy));
+}
+
+//---------------------------------------------------------------------------
+void DensityGrid::merge(int aAxis, bool aUp)
+{
+  int i, j, lDest, lSrc;
+  unsigned int lCount;
+  unsigned int *lBins = mBins.data();
+  int lHalf;
+
+  mMaxCount = 0;
+
+  if(aAxis == 0){
+    // Bins 2i and 2i+1 of the old grid become bin i of the new one
+    // when growing upwards and bin N/2 + i when growing downwards
+    lHalf = mNumBinsX/2;
+    for(j = 0; j < mNumBinsY; j++){
+      unsigned int *lRow = lBins + j*mNumBinsX;
+      if(aUp){
+	for(i = 0; i < lHalf; i++){
+	  lCount = lRow[2*i] + lRow[2*i + 1];
+	  lRow[i] = lCount;
+	  if(lCount > mMaxCount) mMaxCount = lCount;
+	}
+	for(i = lHalf; i < mNumBinsX; i++){
+	  lRow[i] = 0;
+	}
+      }
+      else{
+	for(i = lHalf - 1; i >= 0; i--){
+	  lCount = lRow[2*i] + lRow[2*i + 1];
+	  lRow[lHalf + i] = lCount;
+	  if(lCount > mMaxCount) mMaxCount = lCount;
+	}
+	for(i = 0; i < lHalf; i++){
+	  lRow[i] = 0;
+	}
+      }
+    }
+    if(!aUp){
+      mX0 -= mNumBinsX*mDx;
+    }
+    mDx *= 2.0;
+  }
+  else{
+    lHalf = mNumBinsY/2;
+    for(j = 0; j < lHalf; j++){
+      lDest = aUp ? j : (mNumBinsY - 1 - j);
+      lSrc = aUp ? 2*j : (mNumBinsY - 2 - 2*j);
+      for(i = 0; i < mNumBinsX; i++){
+	lCount = lBins[lSrc*mNumBinsX + i] + lBins[(lSrc + 1)*mNumBinsX + i];
+	lBins[lDest*mNumBinsX + i] = lCount;
+	if(lCount > mMaxCount) mMaxCount = lCount;
+      }
+    }
+    for(j = 0; j < lHalf; j++){
+      lDest = aUp ? (lHalf + j) : j;
+      for(i = 0; i < mNumBinsX; i++){
+	lBins[lDest*mNumBinsX + i] = 0;
+      }
+    }
+    if(!aUp){
+      mY0 -= mNumBinsY*mDy;
+    }
+    mDy *= 2.0;
+  }
+}
@@ -0,0 +1,302 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file ensembleplot.cpp
+    @brief Implementation of the EnsemblePlot class - a parameter
+    overlaid from several applications with ensemble statistics */
+
+#include <qmenubar.h>
+#include <qpen.h>
+#include <qtimer.h>
+#include <Q3PopupMenu>
+#include <Q3VBoxLayout>
+#include <qwt_legend.h>
+
+#include "buildconfig.h"
+#include "ensembleplot.h"
+#include "parameterhistory.h"
+#include "debug.h"
+
+using namespace std;
+
+/// Lower and upper percentiles drawn as the ensemble band
+static const double kENSEMBLE_LOWER_PCT = 10.0;
+static const double kENSEMBLE_UPPER_PCT = 90.0;
+/// Most steps the statistics wait for a slow member before going
+/// ahead without it
+static const int kENSEMBLE_MAX_LAG = 50;
+
+EnsemblePlot::EnsemblePlot(const QString &aLabel, int aNumMembers)
+  : Q3Frame(0,0,0), mLabel(aLabel),
+    mStats(aNumMembers, kENSEMBLE_LOWER_PCT, kENSEMBLE_UPPER_PCT,
+	   kENSEMBLE_MAX_LAG),
+    mShowMembers(true), mRedrawPending(false)
+{
+  setCaption(mLabel + " across " + QString::number(aNumMembers) +
+	     " applications");
+
+  mPlotter = new QwtPlot(this);
+  mPlotter->setCanvasBackground(Qt::darkGray);
+  mPlotter->setAxisTitle(QwtPlot::xBottom, "SEQUENCE_NUM");
+  mPlotter->setAxisTitle(QwtPlot::yLeft, mLabel);
+  mPlotter->insertLegend(new QwtLegend, QwtPlot::RightLegend);
+
+  Q3VBoxLayout *tBL = new Q3VBoxLayout(this);
+  mMenuBar = new QMenuBar(this, "menuBar");
+
+  mFileMenu = new Q3PopupMenu(this, "filePopup");
+  mFileMenu->insertItem("&Close", this, SLOT(fileQuit()), Qt::CTRL+Qt::Key_C);
+
+  mGraphMenu = new Q3PopupMenu(this, "graphPopup");
+  mShowMembersId = mGraphMenu->insertItem("Toggle display of &members", this,
+					  SLOT(toggleMembersSlot()),
+					  Qt::ALT+Qt::Key_M);
+  mGraphMenu->setItemChecked(mShowMembersId, mShowMembers);
+
+  mMenuBar->insertItem("&File", mFileMenu);
+  mMenuBar->insertItem("&Graph", mGraphMenu);
+
+  tBL->setMenuBar(mMenuBar);
+  tBL->addWidget(mPlotter);
+
+  // The statistics are drawn on top of the members
+  mLowerCurve = new QwtPlotCurve(QString("%1th percentile").arg(kENSEMBLE_LOWER_PCT));
+  mLowerCurve->setPen(QPen(Qt::yellow, 2, Qt::DashLine));
+  mLowerCurve->setZ(30.0);
+  mLowerCurve->attach(mPlotter);
+
+  mUpperCurve = new QwtPlotCurve(QString("%1th percentile").arg(kENSEMBLE_UPPER_PCT));
+  mUpperCurve->setPen(QPen(Qt::yellow, 2, Qt::DashLine));
+  mUpperCurve->setZ(30.0);
+  mUpperCurve->attach(mPlotter);
+
+  mMeanCurve = new QwtPlotCurve("Mean");
+  mMeanCurve->setPen(QPen(Qt::white, 3));
+  mMeanCurve->setZ(40.0);
+  mMeanCurve->attach(mPlotter);
+
+  mMemberList.setAutoDelete( TRUE );
+}
+
+//--------------------------------------------------------------------
+EnsemblePlot::~EnsemblePlot()
+{
+  REG_DBGDST("EnsemblePlot");
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::addMember(Application *aApp, const QString &aName,
+			     ParameterHistory *aSeqHist,
+			     ParameterHistory *aValHist)
+{
+  EnsembleMember *lMember = new EnsembleMember;
+  int lIndex = mMemberList.count();
+
+  lMember->mApp = aApp;
+  lMember->mSeqHist = aSeqHist;
+  lMember->mValHist = aValHist;
+  lMember->mConsumed = 0;
+
+  // Members are told apart by stepping round the hue circle
+  QColor lColour;
+  lColour.setHsv((lIndex*137) % 360, 160, 255);
+  lMember->mCurve = new QwtPlotCurve(aName);
+  lMember->mCurve->setPen(QPen(lColour));
+  lMember->mCurve->setZ(10.0);
+  // With dozens of members the legend is kept for the statistics
+  lMember->mCurve->setItemAttribute(QwtPlotItem::Legend, false);
+  lMember->mCurve->attach(mPlotter);
+
+  mMemberList.append(lMember);
+  updateSlot();
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::removeApplication(Application *aApp)
+{
+  int i;
+  EnsembleMember *lMember;
+
+  // Take whatever has been logged before the data go away
+  consumeSamples();
+
+  for(i = 0, lMember = mMemberList.first(); lMember;
+      i++, lMember = mMemberList.next()){
+    if(lMember->mApp == aApp){
+      lMember->mApp = NULL;
+      lMember->mSeqHist = NULL;
+      lMember->mValHist = NULL;
+      mStats.retireMember(i);
+      updateSlot();
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::retireApplicationSlot(Application *aApp)
+{
+  int i;
+  EnsembleMember *lMember;
+
+  // Its histories stay put (and its curve is still drawn) until it
+  // is closed, but the statistics mustn't wait for it any more
+  consumeSamples();
+
+  for(i = 0, lMember = mMemberList.first(); lMember;
+      i++, lMember = mMemberList.next()){
+    if(lMember->mApp == aApp){
+      mStats.retireMember(i);
+      updateSlot();
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::consumeSamples()
+{
+  int i, j, lNum;
+  EnsembleMember *lMember;
+
+  for(i = 0, lMember = mMemberList.first(); lMember;
+      i++, lMember = mMemberList.next()){
+    if(!lMember->mSeqHist || !lMember->mValHist){
+      continue;
+    }
+    // Both are logged from the same status messages so sample n of
+    // one goes with sample n of the other
+    lNum = lMember->mValHist->mArrayPos;
+    if(lMember->mSeqHist->mArrayPos < lNum){
+      lNum = lMember->mSeqHist->mArrayPos;
+    }
+    const double *lSeq = lMember->mSeqHist->ptrToArray();
+    const double *lVal = lMember->mValHist->ptrToArray();
+    for(j = lMember->mConsumed; j < lNum; j++){
+      mStats.addSample(i, lSeq[j], lVal[j]);
+    }
+    lMember->mConsumed = lNum;
+  }
+}
+
+//--------------------------------------------------------------------
+/** Each member's ControlForm signals us so updates arrive in bursts
+ *  - they're gathered up and dealt with together
+ */
+void EnsemblePlot::updateSlot()
+{
+  if(mRedrawPending){
+    return;
+  }
+  mRedrawPending = true;
+  QTimer::singleShot(100, this, SLOT(redrawSlot()));
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::redrawSlot()
+{
+  int lNum;
+  EnsembleMember *lMember;
+
+  mRedrawPending = false;
+
+  consumeSamples();
+  mStats.finalise();
+
+  int lNumBuckets = mPlotter->canvas()->contentsRect().width();
+  if(lNumBuckets < 100){
+    lNumBuckets = 100;
+  }
+
+  // Members
+  for(lMember = mMemberList.first(); lMember; lMember = mMemberList.next()){
+    lMember->mCurve->setVisible(mShowMembers);
+    if(!mShowMembers || !lMember->mSeqHist || !lMember->mValHist){
+      continue;
+    }
+    lNum = lMember->mConsumed;
+    lMember->mAbscissa.transform(lMember->mSeqHist->ptrToArray(), lNum,
+				 lNumBuckets);
+    lMember->mAbscissa.reduce(lMember->mValHist->ptrToArray(), lNum,
+			      lMember->mX, lMember->mY);
+    lMember->mCurve->setData(lMember->mX.data(), lMember->mY.data(),
+			     lMember->mX.size());
+  }
+
+  // Statistics
+  lNum = mStats.seq().size();
+  mStatsAbscissa.transform(mStats.seq().data(), lNum, lNumBuckets);
+  mStatsAbscissa.reduce(mStats.mean().data(), lNum, mStatsX, mStatsY);
+  mMeanCurve->setData(mStatsX.data(), mStatsY.data(), mStatsX.size());
+  mStatsAbscissa.reduce(mStats.lower().data(), lNum, mStatsX, mStatsY);
+  mLowerCurve->setData(mStatsX.data(), mStatsY.data(), mStatsX.size());
+  mStatsAbscissa.reduce(mStats.upper().data(), lNum, mStatsX, mStatsY);
+  mUpperCurve->setData(mStatsX.data(), mStatsY.data(), mStatsX.size());
+
+  mPlotter->replot();
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::toggleMembersSlot()
+{
+  mShowMembers = !mShowMembers;
+  mGraphMenu->setItemChecked(mShowMembersId, mShowMembers);
+  updateSlot();
+}
+
+//--------------------------------------------------------------------
+void EnsemblePlot::fileQuit()
+{
+  close();
+}
+
+//--------------------------------------------------------------------
+/** Override QWidget::closeEvent to catch the user clicking the close button
+ *  in the window bar as well as them selecting Close from the File menu.
+ */
+void EnsemblePlot::closeEvent(QCloseEvent *e)
+{
+  e->accept();
+  // Emit a SIGNAL to tell the main window we can be deleted
+  emit ensemblePlotClosedSignal(this);
+}
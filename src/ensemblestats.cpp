@@ -0,0 +1,208 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file ensemblestats.cpp
+    @brief Implementation of the EnsembleStats class - per-step
+    statistics across an ensemble of applications */
+
+#include <algorithm>
+#include <limits>
+
+#include "buildconfig.h"
+#include "ensemblestats.h"
+
+EnsembleStats::EnsembleStats(int aNumMembers, double aLowerPct,
+			     double aUpperPct, int aMaxLag)
+  : mNumMembers(aNumMembers), mLowerPct(aLowerPct), mUpperPct(aUpperPct),
+    mMaxLag(aMaxLag < 1 ? 1 : aMaxLag), mFinalisedSeq(0.0), mHaveFinalised(false)
+{
+  mLatest.fill(-HUGE_VAL, aNumMembers);
+  mActive.fill(true, aNumMembers);
+  mScratch.resize(aNumMembers);
+}
+
+EnsembleStats::~EnsembleStats()
+{
+}
+
+//---------------------------------------------------------------------------
+void EnsembleStats::addSample(int aMember, double aSeq, double aValue)
+{
+  if(aMember < 0 || aMember >= mNumMembers || !mActive[aMember]){
+    return;
+  }
+  mLatest[aMember] = aSeq;
+
+  // A member that has gone back in time (e.g. restarted from a
+  // checkpoint) can't change steps that are already done
+  if(mHaveFinalised && aSeq <= mFinalisedSeq){
+    return;
+  }
+
+  QMap<double, QVector<double> >::iterator lIt = mPending.find(aSeq);
+  if(lIt == mPending.end()){
+    lIt = mPending.insert(aSeq, QVector<double>(mNumMembers,
+					   std::numeric_limits<double>::quiet_NaN()));
+  }
+  (*lIt)[aMember] = aValue;
+}
+
+//---------------------------------------------------------------------------
+void EnsembleStats::retireMember(int aMember)
+{
+  if(aMember >= 0 && aMember < mNumMembers){
+    mActive[aMember] = false;
+  }
+}
+
+//---------------------------------------------------------------------------
+int EnsembleStats::finalise()
+{
+  int    i;
+  int    lNumDone = 0;
+  double lUpTo = HUGE_VAL;
+
+  // Only steps that every member still reporting has got past are
+  // complete.  A member that hasn't reported anything yet (e.g. one
+  // that is paused) isn't waited for.
+  for(i = 0; i < mNumMembers; i++){
+    if(mActive[i] && mLatest[i] != -HUGE_VAL && mLatest[i] < lUpTo){
+      lUpTo = mLatest[i];
+    }
+  }
+
+  // Steps more than mMaxLag behind are done with regardless, so a
+  // member that has stalled can't hold the rest up (or make
+  // mPending grow without limit)
+  QMap<double, QVector<double> >::iterator lIt = mPending.begin();
+  while(lIt != mPending.end() &&
+	(lIt.key() <= lUpTo || mPending.count() > mMaxLag)){
+    reduceStep(lIt.key(), lIt.value());
+    mFinalisedSeq = lIt.key();
+    mHaveFinalised = true;
+    lIt = mPending.erase(lIt);
+    lNumDone++;
+  }
+
+  return lNumDone;
+}
+
+//---------------------------------------------------------------------------
+void EnsembleStats::reduceStep(double aSeq, const QVector<double> &aValues)
+{
+  int    i;
+  int    lNum = 0;
+  double lSum = 0.0;
+  const double *lIn = aValues.data();
+  double *lOut = mScratch.data();
+
+  // Gather the members that reported this step; the sum is then a
+  // straight loop the compiler can vectorise
+  for(i = 0; i < mNumMembers; i++){
+    if(lIn[i] == lIn[i]){
+      lOut[lNum++] = lIn[i];
+    }
+  }
+  if(lNum == 0){
+    return;
+  }
+  for(i = 0; i < lNum; i++){
+    lSum += lOut[i];
+  }
+
+  mSeq.append(aSeq);
+  mMean.append(lSum/lNum);
+  mLower.append(percentile(lOut, lNum, mLowerPct));
+  mUpper.append(percentile(lOut, lNum, mUpperPct));
+}
+
+//---------------------------------------------------------------------------
+double EnsembleStats::percentile(double *aData, int aNum, double aPct)
+{
+  // Nearest rank - nth_element is linear on average
+  int lRank = (int)(0.5 + aPct*(aNum - 1)/100.0);
+
+  if(lRank < 0) lRank = 0;
+  if(lRank >= aNum) lRank = aNum - 1;
+  std::nth_element(aData, aData + lRank, aData + aNum);
+
+  return aData[lRank];
+}
+
+//---------------------------------------------------------------------------
+double EnsembleStats::lowerPercentile() const
+{
+  return mLowerPct;
+}
+
+//---------------------------------------------------------------------------
+double EnsembleStats::upperPercentile() const
+{
+  return mUpperPct;
+}
+
+//---------------------------------------------------------------------------
+const QVector<double> &EnsembleStats::seq() const
+{
+  return mSeq;
+}
+
+//---------------------------------------------------------------------------
+const QVector<double> &EnsembleStats::mean() const
+{
+  return mMean;
+}
+
+//---------------------------------------------------------------------------
+const QVector<double> &EnsembleStats::lower() const
+{
+  return mLower;
+}
+
+//---------------------------------------------------------------------------
+const QVector<double> &EnsembleStats::upper() const
+{
+  return mUpper;
+}
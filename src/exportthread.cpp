@@ -0,0 +1,183 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file exportthread.cpp
+    @brief Implementation of the ExportThread class - data and image
+    export on a worker thread */
+
+#include <qfile.h>
+#include <qprogressdialog.h>
+
+#include "buildconfig.h"
+#include "exportthread.h"
+#include "debug.h"
+
+ExportThread::ExportThread(const QString &aFileName)
+  : QThread(), ColumnExporter(), mFileName(aFileName), mIsImage(false),
+    mCancelled(0), mSucceeded(false), mLastPercent(-1)
+{
+  REG_DBGCON("ExportThread");
+}
+
+ExportThread::~ExportThread()
+{
+  REG_DBGDST("ExportThread");
+  for(int i = 0; i < mCopies.count(); i++){
+    delete [] mCopies[i];
+  }
+}
+
+//---------------------------------------------------------------------------
+void ExportThread::addBlockCopy(const QVector<const double *> &aColumns,
+				int aNumRows)
+{
+  addBlockCopy(aColumns, aNumRows, QVector<int>(aColumns.count(), 0),
+	       QVector<int>(aColumns.count(), aNumRows));
+}
+
+//---------------------------------------------------------------------------
+void ExportThread::addBlockCopy(const QVector<const double *> &aColumns,
+				int aNumRows, const QVector<int> &aFirstRows,
+				const QVector<int> &aLengths)
+{
+  QVector<const double *> lCopies;
+
+  if(aNumRows <= 0){
+    return;
+  }
+  // Only what's there is copied - gaps are filled as it's written
+  for(int i = 0; i < aColumns.count(); i++){
+    double *lCopy = new double[aLengths[i] > 0 ? aLengths[i] : 1];
+    if(aLengths[i] > 0){
+      memcpy(lCopy, aColumns[i], aLengths[i]*sizeof(double));
+    }
+    mCopies.append(lCopy);
+    lCopies.append(lCopy);
+  }
+  addBlock(lCopies, aNumRows, aFirstRows, aLengths);
+}
+
+//---------------------------------------------------------------------------
+void ExportThread::setImage(const PlotSnapshot &aSnapshot, const QSize &aSize)
+{
+  mIsImage = true;
+  mSnapshot = aSnapshot;
+  mImageSize = aSize;
+}
+
+//---------------------------------------------------------------------------
+void ExportThread::startWithProgress(QWidget *aParent, const QString &aLabel)
+{
+  QProgressDialog *lProgress = new QProgressDialog(aLabel, "Cancel", 0, 100,
+						   aParent);
+  lProgress->setWindowModality(Qt::WindowModal);
+  lProgress->setMinimumDuration(500);
+  lProgress->setValue(0);
+
+  connect(this, SIGNAL(progressSignal(int)), lProgress, SLOT(setValue(int)));
+  connect(lProgress, SIGNAL(canceled()), this, SLOT(cancel()));
+  connect(this, SIGNAL(finished()), lProgress, SLOT(deleteLater()));
+
+  start(QThread::LowPriority);
+}
+
+//---------------------------------------------------------------------------
+bool ExportThread::succeeded() const
+{
+  return mSucceeded;
+}
+
+//---------------------------------------------------------------------------
+bool ExportThread::wasCancelled() const
+{
+  return (int)mCancelled != 0;
+}
+
+//---------------------------------------------------------------------------
+QString ExportThread::fileName() const
+{
+  return mFileName;
+}
+
+//---------------------------------------------------------------------------
+void ExportThread::cancel()
+{
+  mCancelled = 1;
+}
+
+//---------------------------------------------------------------------------
+bool ExportThread::reportProgress(qint64 aDone, qint64 aTotal)
+{
+  int lPercent = (aTotal > 0) ? (int)((100*aDone)/aTotal) : 100;
+
+  // Don't swamp the GUI's event queue
+  if(lPercent != mLastPercent){
+    mLastPercent = lPercent;
+    emit progressSignal(lPercent);
+  }
+  return !wasCancelled();
+}
+
+//---------------------------------------------------------------------------
+void ExportThread::run()
+{
+  if(mIsImage){
+    // An image is drawn in one go so can't be interrupted part way
+    mSucceeded = PlotRenderer::renderToFile(mSnapshot, mFileName, mImageSize);
+    emit progressSignal(100);
+  }
+  else{
+    QFile lFile(mFileName);
+    if(lFile.open(QIODevice::WriteOnly)){
+      mSucceeded = write(&lFile, formatForFile(mFileName));
+      lFile.close();
+    }
+  }
+
+  if(wasCancelled()){
+    mSucceeded = false;
+    QFile::remove(mFileName);
+  }
+}
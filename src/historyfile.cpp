@@ -0,0 +1,541 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file historyfile.cpp
+    @brief Implementation of the HistoryFile class - memory mapped
+    access to exported and recorded parameter histories */
+
+#include <QtEndian>
+#include <QtAlgorithms>
+#include <limits>
+
+#include "buildconfig.h"
+#include "historyfile.h"
+#include "parameterhistory.h"
+#include "debug.h"
+
+//---------------------------------------------------------------------------
+/// Copy aNum little-endian doubles from aSrc into aVals
+static void copyDoubles(const uchar *aSrc, double *aVals, int aNum)
+{
+  if(QSysInfo::ByteOrder == QSysInfo::LittleEndian){
+    memcpy(aVals, aSrc, aNum*sizeof(double));
+    return;
+  }
+  for(int i = 0; i < aNum; i++){
+    quint64 lBits = qFromLittleEndian<quint64>(aSrc + 8*i);
+    memcpy(&aVals[i], &lBits, sizeof(double));
+  }
+}
+
+//---------------------------------------------------------------------------
+static void fillMissing(double *aVals, int aNum)
+{
+  for(int i = 0; i < aNum; i++){
+    aVals[i] = std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+//---------------------------------------------------------------------------
+HistoryFile::HistoryFile(const QString &aFileName, QObject *aParent)
+  : QObject(aParent), mFile(aFileName), mMap(NULL), mSize(0),
+    mIsSession(false), mIsCompressed(false), mNumRows(0), mDataStart(0)
+{
+  REG_DBGCON("HistoryFile");
+}
+
+//---------------------------------------------------------------------------
+HistoryFile::~HistoryFile()
+{
+  REG_DBGDST("HistoryFile");
+
+  for(int i = 0; i < mHistories.count(); i++){
+    delete mHistories[i];
+  }
+  for(int i = 0; i < mBuffers.count(); i++){
+    delete [] mBuffers[i];
+  }
+  if(mMap){
+    mFile.unmap(mMap);
+  }
+}
+
+//---------------------------------------------------------------------------
+bool HistoryFile::open()
+{
+  if(!mFile.open(QIODevice::ReadOnly)){
+    mError = mFile.errorString();
+    return false;
+  }
+  mSize = mFile.size();
+  mMap = mFile.map(0, mSize);
+  if(!mMap){
+    mError = "Failed to map file: " + mFile.errorString();
+    return false;
+  }
+
+  QString lMagic = headerLine();
+  bool lOk = false;
+  if(lMagic == "RGSTEER-COLUMNS 1"){
+    lOk = openColumns();
+  }
+  else if(lMagic == "RGSTEER-SESSION 1"){
+    mIsSession = true;
+    lOk = openSession();
+  }
+  else{
+    mError = "Not a binary export or recorded session";
+  }
+  if(!lOk){
+    return false;
+  }
+
+  // Everything is selected to begin with
+  mNumRows = 0;
+  for(int k = 0; k < mChunks.count(); k++){
+    mChunks[k].mBegin = 0;
+    mChunks[k].mEnd = mChunks[k].mNumRows;
+    mNumRows += mChunks[k].mNumRows;
+  }
+  mHistories.fill(NULL, mLabels.count());
+  return true;
+}
+
+//---------------------------------------------------------------------------
+QString HistoryFile::fileName() const
+{
+  return mFile.fileName();
+}
+
+//---------------------------------------------------------------------------
+QString HistoryFile::errorString() const
+{
+  return mError;
+}
+
+//---------------------------------------------------------------------------
+bool HistoryFile::isCompressed() const
+{
+  return mIsCompressed;
+}
+
+//---------------------------------------------------------------------------
+const QStringList &HistoryFile::labels() const
+{
+  return mLabels;
+}
+
+//---------------------------------------------------------------------------
+int HistoryFile::numRows() const
+{
+  return mNumRows;
+}
+
+//---------------------------------------------------------------------------
+QString HistoryFile::headerLine()
+{
+  qint64 lEnd = mDataStart;
+  while(lEnd < mSize && mMap[lEnd] != '\n' && lEnd - mDataStart < 1024){
+    lEnd++;
+  }
+  QString lLine = QString::fromLatin1((const char *)mMap + mDataStart,
+				      (int)(lEnd - mDataStart));
+  mDataStart = lEnd + 1;
+  return lLine.stripWhiteSpace();
+}
+
+//---------------------------------------------------------------------------
+bool HistoryFile::openColumns()
+{
+  int lNumCols = -1;
+  int lChunkRows = 0;
+
+  mNumRows = -1;
+  while(mDataStart < mSize){
+    QString lLine = headerLine();
+
+    if(lLine == "end"){
+      if(mNumRows < 0 || lNumCols != mLabels.count() || (mDataStart % 8)){
+	break;
+      }
+      if(mIsCompressed){
+	if(lChunkRows <= 0 || !readChunkIndex(lNumCols, lChunkRows)){
+	  break;
+	}
+	return true;
+      }
+      if(mDataStart + 8*(qint64)mNumRows*lNumCols > mSize){
+	break;
+      }
+
+      // The whole file is one chunk
+      Chunk lChunk;
+      lChunk.mNumRows = mNumRows;
+      lChunk.mCompressed = false;
+      for(int j = 0; j < lNumCols; j++){
+	lChunk.mOffsets.append(mDataStart + 8*(qint64)mNumRows*j);
+	lChunk.mSizes.append(8*(qint64)mNumRows);
+      }
+      lChunk.mFirstSeq = lChunk.mLastSeq = 0.0;
+      if(mNumRows > 0 && lNumCols > 0){
+	decode(lChunk, 0, 0, 1, &lChunk.mFirstSeq);
+	decode(lChunk, 0, mNumRows - 1, 1, &lChunk.mLastSeq);
+      }
+      mChunks.append(lChunk);
+      return true;
+    }
+    else if(lLine.startsWith("rows ")){
+      mNumRows = lLine.mid(5).toInt();
+    }
+    else if(lLine.startsWith("columns ")){
+      lNumCols = lLine.mid(8).toInt();
+    }
+    else if(lLine.startsWith("column ")){
+      mLabels.append(lLine.mid(7));
+    }
+    else if(lLine.startsWith("chunkrows ")){
+      lChunkRows = lLine.mid(10).toInt();
+    }
+    else if(lLine == "compression zlib"){
+      mIsCompressed = true;
+    }
+    else if(lLine.startsWith("compression ") ||
+	    (lLine.startsWith("endian ") && lLine != "endian little") ||
+	    (lLine.startsWith("type ") && lLine != "type float64")){
+      break;
+    }
+  }
+  mError = "Binary export header is damaged or file is truncated";
+  return false;
+}
+
+//---------------------------------------------------------------------------
+bool HistoryFile::readChunkIndex(int aNumCols, int aChunkRows)
+{
+  // The file ends with "CHUNKIDX" and the offset of the index
+  if(mSize < mDataStart + 16 ||
+     memcmp(mMap + mSize - 16, "CHUNKIDX", 8)){
+    return false;
+  }
+  qint64 lIndex = qFromLittleEndian<qint64>(mMap + mSize - 8);
+  int lNumChunks = (mNumRows + aChunkRows - 1)/aChunkRows;
+  qint64 lEntrySize = 16 + 16*(qint64)aNumCols;
+
+  if(lIndex < mDataStart || lIndex + lNumChunks*lEntrySize > mSize - 16){
+    return false;
+  }
+
+  for(int r = 0; r < lNumChunks; r++){
+    const uchar *lEntry = mMap + lIndex + r*lEntrySize;
+    Chunk lChunk;
+    lChunk.mNumRows = qMin(aChunkRows, mNumRows - r*aChunkRows);
+    lChunk.mCompressed = true;
+
+    quint64 lBits = qFromLittleEndian<quint64>(lEntry);
+    memcpy(&lChunk.mFirstSeq, &lBits, sizeof(double));
+    lBits = qFromLittleEndian<quint64>(lEntry + 8);
+    memcpy(&lChunk.mLastSeq, &lBits, sizeof(double));
+
+    for(int j = 0; j < aNumCols; j++){
+      qint64 lOffset = qFromLittleEndian<qint64>(lEntry + 16 + 16*j);
+      qint64 lSize = qFromLittleEndian<qint64>(lEntry + 24 + 16*j);
+      if(lOffset < mDataStart || lSize < 0 || lOffset + lSize > lIndex){
+	return false;
+      }
+      lChunk.mOffsets.append(lOffset);
+      lChunk.mSizes.append(lSize);
+    }
+    mChunks.append(lChunk);
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool HistoryFile::openSession()
+{
+  QMap<int, QString> lParams;
+
+  while(mDataStart < mSize){
+    QString lLine = headerLine();
+    if(lLine == "end"){
+      break;
+    }
+    if(lLine.startsWith("endian ") && lLine != "endian little"){
+      mError = "Session log has an unknown byte order";
+      return false;
+    }
+  }
+
+  // The sparse index gives the range of sequence numbers in each
+  // chunk without touching the chunk itself
+  QMap<qint64, QPair<double, double> > lRanges;
+  QFile lIndexFile(mFile.fileName() + ".idx");
+  if(lIndexFile.open(QIODevice::ReadOnly)){
+    QByteArray lIndex = lIndexFile.readAll();
+    const uchar *lEntry = (const uchar *)lIndex.constData();
+    for(int i = 0; i + 24 <= lIndex.size(); i += 24){
+      lRanges.insert(qFromLittleEndian<qint64>(lEntry + i + 16),
+		     qMakePair((double)qFromLittleEndian<qint64>(lEntry + i),
+			       (double)qFromLittleEndian<qint64>(lEntry + i + 8)));
+    }
+  }
+
+  // Walk the record headers - the data themselves aren't touched
+  qint64 lPos = mDataStart;
+  while(lPos + 8 <= mSize){
+    const uchar *lRec = mMap + lPos;
+    qint32 lLen = qFromLittleEndian<qint32>(lRec + 4);
+    // A record cut short means the recording was still being written
+    if(lLen < 0 || (lLen % 8) || lPos + 8 + lLen > mSize){
+      break;
+    }
+    const uchar *lPayload = lRec + 8;
+    bool lIsRows = !memcmp(lRec, "ROWS", 4);
+    bool lIsZRows = !memcmp(lRec, "ZROW", 4);
+
+    if((lIsRows || lIsZRows) && lLen >= 8){
+      Chunk lChunk;
+      lChunk.mNumRows = qFromLittleEndian<qint32>(lPayload);
+      lChunk.mCompressed = lIsZRows;
+      int lNumCols = qFromLittleEndian<qint32>(lPayload + 4);
+      if(lChunk.mNumRows <= 0 || lNumCols < 0){
+	break;
+      }
+      // The handles (and the compressed sizes) must be in the record
+      // before they're read
+      qint64 lData = 8 + 4*(qint64)lNumCols +
+	(lIsZRows ? 4*(2 + (qint64)lNumCols) : 0);
+      if(lData > lLen){
+	break;
+      }
+      lChunk.mHandles.resize(lNumCols);
+      for(int j = 0; j < lNumCols; j++){
+	lChunk.mHandles[j] = qFromLittleEndian<qint32>(lPayload + 8 + 4*j);
+      }
+
+      // Sequence numbers, times, then a column per handle
+      lData += (8 - lData % 8) % 8;
+      bool lBadSize = false;
+      for(int c = 0; c < 2 + lNumCols; c++){
+	qint64 lSize = 8*(qint64)lChunk.mNumRows;
+	if(lIsZRows){
+	  lSize = qFromLittleEndian<qint32>(lPayload + 8 + 4*lNumCols + 4*c);
+	  if(lSize < 0){
+	    lBadSize = true;
+	    break;
+	  }
+	}
+	lChunk.mOffsets.append(lPos + 8 + lData);
+	lChunk.mSizes.append(lSize);
+	lData += lSize + (8 - lSize % 8) % 8;
+      }
+      if(lBadSize || lData > lLen){
+	break;
+      }
+
+      if(lRanges.contains(lPos)){
+	lChunk.mFirstSeq = lRanges[lPos].first;
+	lChunk.mLastSeq = lRanges[lPos].second;
+      }
+      else{
+	decode(lChunk, 0, 0, 1, &lChunk.mFirstSeq);
+	decode(lChunk, 0, lChunk.mNumRows - 1, 1, &lChunk.mLastSeq);
+      }
+      mChunks.append(lChunk);
+      mIsCompressed = mIsCompressed || lIsZRows;
+    }
+    else if(!memcmp(lRec, "PARM", 4) && lLen >= 12){
+      // Label is NUL-padded
+      lParams.insert(qFromLittleEndian<qint32>(lPayload),
+		     QString::fromLatin1((const char *)lPayload + 12,
+					 qstrnlen((const char *)lPayload + 12,
+						  lLen - 12)));
+    }
+    lPos += 8 + lLen;
+  }
+
+  if(mChunks.isEmpty()){
+    mError = "Session log holds no status messages";
+    return false;
+  }
+
+  mLabels << "Seq no." << "Time (s)";
+  mHandles << 0 << 0;
+  QMap<int, QString>::const_iterator lIt;
+  for(lIt = lParams.constBegin(); lIt != lParams.constEnd(); ++lIt){
+    mLabels.append(lIt.value());
+    mHandles.append(lIt.key());
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void HistoryFile::seqRange(double &aFirst, double &aLast) const
+{
+  aFirst = aLast = 0.0;
+  for(int k = 0; k < mChunks.count(); k++){
+    if(k == 0 || mChunks[k].mFirstSeq < aFirst){
+      aFirst = mChunks[k].mFirstSeq;
+    }
+    if(k == 0 || mChunks[k].mLastSeq > aLast){
+      aLast = mChunks[k].mLastSeq;
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void HistoryFile::setSeqRange(double aFirst, double aLast)
+{
+  Q_ASSERT(mHistories.count(NULL) == mHistories.count());
+
+  mNumRows = 0;
+  for(int k = 0; k < mChunks.count(); k++){
+    Chunk &lChunk = mChunks[k];
+
+    if(lChunk.mLastSeq < aFirst || lChunk.mFirstSeq > aLast){
+      // Never decompressed
+      lChunk.mBegin = lChunk.mEnd = 0;
+    }
+    else if(lChunk.mFirstSeq >= aFirst && lChunk.mLastSeq <= aLast){
+      lChunk.mBegin = 0;
+      lChunk.mEnd = lChunk.mNumRows;
+    }
+    else{
+      // Range starts or ends in this chunk - find out where
+      QVector<double> lSeq(lChunk.mNumRows);
+      if(!decode(lChunk, 0, 0, lChunk.mNumRows, lSeq.data())){
+	lChunk.mBegin = lChunk.mEnd = 0;
+	continue;
+      }
+      lChunk.mBegin = qLowerBound(lSeq.begin(), lSeq.end(), aFirst) -
+	lSeq.begin();
+      lChunk.mEnd = qUpperBound(lSeq.begin(), lSeq.end(), aLast) -
+	lSeq.begin();
+    }
+    mNumRows += lChunk.mEnd - lChunk.mBegin;
+  }
+}
+
+//---------------------------------------------------------------------------
+int HistoryFile::chunkColumn(const Chunk &aChunk, int aColumn) const
+{
+  if(!mIsSession || aColumn < 2){
+    return aColumn;
+  }
+  int lCol = aChunk.mHandles.indexOf(mHandles[aColumn]);
+  return (lCol < 0) ? -1 : lCol + 2;
+}
+
+//---------------------------------------------------------------------------
+bool HistoryFile::decode(const Chunk &aChunk, int aCol, int aRow, int aNum,
+			 double *aDest) const
+{
+  const uchar *lSrc = mMap + aChunk.mOffsets[aCol];
+
+  if(!aChunk.mCompressed){
+    copyDoubles(lSrc + 8*(qint64)aRow, aDest, aNum);
+    return true;
+  }
+
+  QByteArray lRaw = qUncompress(lSrc, (int)aChunk.mSizes[aCol]);
+  if(lRaw.size() != 8*aChunk.mNumRows){
+    fillMissing(aDest, aNum);
+    return false;
+  }
+  copyDoubles((const uchar *)lRaw.constData() + 8*aRow, aDest, aNum);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+double *HistoryFile::gatherColumn(int aColumn)
+{
+  if(!mIsSession && !mIsCompressed && mChunks.count() == 1 &&
+     QSysInfo::ByteOrder == QSysInfo::LittleEndian){
+    // Use the mapping as it is - pages are read as they're plotted
+    const Chunk &lChunk = mChunks.first();
+    return (double *)(mMap + lChunk.mOffsets[aColumn]) + lChunk.mBegin;
+  }
+
+  double *lVals = new double[mNumRows > 0 ? mNumRows : 1];
+  mBuffers.append(lVals);
+
+  int lRow = 0;
+  for(int k = 0; k < mChunks.count(); k++){
+    const Chunk &lChunk = mChunks[k];
+    const int lN = lChunk.mEnd - lChunk.mBegin;
+    if(lN <= 0){
+      continue;
+    }
+
+    int lCol = chunkColumn(lChunk, aColumn);
+    if(lCol < 0){
+      // Parameter wasn't around yet
+      fillMissing(&lVals[lRow], lN);
+    }
+    else{
+      decode(lChunk, lCol, lChunk.mBegin, lN, &lVals[lRow]);
+    }
+    lRow += lN;
+  }
+  return lVals;
+}
+
+//---------------------------------------------------------------------------
+ParameterHistory *HistoryFile::history(int aColumn)
+{
+  if(aColumn < 0 || aColumn >= mHistories.count()){
+    return NULL;
+  }
+
+  if(!mHistories[aColumn]){
+    // The data all count as logged before we 'attached'; the
+    // history itself doesn't own them
+    ParameterHistory *lHist = new ParameterHistory();
+    lHist->mPtrPreviousHistArray = gatherColumn(aColumn);
+    lHist->mPreviousHistArraySize = mNumRows;
+    mHistories[aColumn] = lHist;
+  }
+  return mHistories[aColumn];
+}
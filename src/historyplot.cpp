@@ -61,23 +61,51 @@
 #include <Q3Frame>
 #include "qprinter.h"
 #include "qinputdialog.h"
+#include "qregexp.h"
+#include "qdatetime.h"
+#include <QtAlgorithms>
 #include "qwt_symbol.h"
 #include "qwt_picker.h"
 #include "qwt_legend.h"
 #include "qwt_scale_div.h"
+#include "qwt_scale_widget.h"
 #include "q3filedialog.h"
-#include "q3textstream.h"
 #include <qmessagebox.h>
 #include "qcolor.h"
+#include <QtConcurrentMap>
 
 #include "buildconfig.h"
 #include "historysubplot.h"
 #include "historyplot.h"
 #include "parameterhistory.h"
+#include "exportthread.h"
+#include "historyfile.h"
 #include "debug.h"
 
 using namespace std;
 
+/// Functor used to decimate the curves of a HistoryPlot concurrently
+struct DecimateSubPlot
+{
+  typedef void result_type;
+
+  DecimateSubPlot(const SharedAbscissa *aHist, int aHistStart,
+		  const SharedAbscissa *aLive, int aLiveStart,
+		  bool aForceHist)
+    : mHist(aHist), mHistStart(aHistStart), mLive(aLive),
+      mLiveStart(aLiveStart), mForceHist(aForceHist) {}
+
+  void operator()(HistorySubPlot *&aPlot) const {
+    aPlot->decimate(*mHist, mHistStart, *mLive, mLiveStart, mForceHist);
+  }
+
+  const SharedAbscissa *mHist;
+  int mHistStart;
+  const SharedAbscissa *mLive;
+  int mLiveStart;
+  bool mForceHist;
+};
+
 HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
 			 ParameterHistory *_mYParamHist,
 			 const char *_lLabelx,
@@ -107,6 +135,14 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
   // y axis is inappropriate
   //mPlotter->setAxisTitle(mPlotter->yLeft, _lLabely);
 
+  // The legend scrolls once it fills the side of the plot and lets
+  // the user switch individual curves on and off
+  mLegend = new QwtLegend;
+  mLegend->setItemMode(QwtLegend::CheckableItem);
+  mPlotter->insertLegend(mLegend, QwtPlot::RightLegend);
+  connect(mPlotter, SIGNAL(legendChecked(QwtPlotItem *, bool)),
+	  this, SLOT(legendCheckedSlot(QwtPlotItem *, bool)));
+
   Q3VBoxLayout *tBL = new Q3VBoxLayout(this);
   mMenuBar = new QMenuBar(this, "menuBar");
 
@@ -147,6 +183,10 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
 					 Qt::ALT+Qt::Key_O);
   mGraphMenu->insertSeparator();
 
+  mFollowId = mGraphMenu->insertItem("&Follow latest data...", this,
+				     SLOT(followSlot()), Qt::ALT+Qt::Key_F);
+  mGraphMenu->insertSeparator();
+
   mShowSymbolsId = mGraphMenu->insertItem("Toggle &display of symbols", this,
 					  SLOT(graphDisplaySymbolsSlot()),
 					  Qt::ALT+Qt::Key_D);
@@ -155,6 +195,10 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
 					 SLOT(graphDisplayCurvesSlot()),
 					 Qt::ALT+Qt::Key_I);
 
+  mShowDensityId = mGraphMenu->insertItem("Toggle display of d&ensity", this,
+					  SLOT(graphDisplayDensitySlot()),
+					  Qt::ALT+Qt::Key_E);
+
   mGraphMenu->setItemChecked(mAutoYAxisId, true);
   mGraphMenu->setItemChecked(mAutoXAxisId, true);
   mGraphMenu->setItemEnabled(mYUpperBoundId, false);
@@ -165,6 +209,11 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
   mGraphMenu->setItemChecked(mShowCurvesId, true);
   mGraphMenu->setItemChecked(mToggleLogXId, false);
   mGraphMenu->setItemChecked(mToggleLogYId, false);
+  mGraphMenu->setItemChecked(mShowDensityId, false);
+  mGraphMenu->setItemChecked(mFollowId, false);
+  // A density plot only makes sense for parameter vs. parameter
+  mGraphMenu->setItemEnabled(mShowDensityId,
+			     strcmp(mLabelx, "SEQUENCE_NUM") != 0);
 
   mMenuBar->insertItem("&File", mFileMenu);
   mMenuBar->insertItem("&Graph", mGraphMenu);
@@ -186,6 +235,15 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
   mDisplaySymbolsSet = true;
   // Default to displaying a curve too
   mDisplayCurvesSet   = true;
+  // Draw individual points rather than their density to start with
+  mDisplayDensitySet  = false;
+  // Show the whole history to start with
+  mFollowMode = kFOLLOW_OFF;
+  mFollowSpan = 0.0;
+  mFollowXMin = mFollowXMax = 0.0;
+
+  mExportThread = NULL;
+  mHistoryFile = NULL;
 
   mPicker = new QwtPicker(mPlotter->canvas());
 
@@ -221,7 +279,7 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
   //    cout << *it << ":";
   //  }
   //cout << endl;
-  mColourIter = mColourList.begin();
+  mColourIndex = 0;
 
   // Create the HistorySubPlot object that will look after drawing this curve
   mSubPlotList.append(new HistorySubPlot(this, mPlotter,
@@ -229,9 +287,9 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
 					 _mYParamHist,
 					 QString(_lLabely),
 					 _yparamID,
-		                         *mColourIter));
-  ++mColourIter;
+					 nextColour()));
 
+  recordUpdateTime();
   doPlot();
 }
 
@@ -239,6 +297,12 @@ HistoryPlot::HistoryPlot(ParameterHistory *_mXParamHist,
 HistoryPlot::~HistoryPlot()
 {
   REG_DBGDST("HistoryPlot");
+  // The export only uses its own copies of the data so there's no
+  // harm in letting it finish
+  if(mExportThread){
+    mExportThread->wait();
+    delete mExportThread;
+  }
   delete mPicker;
 }
 
@@ -259,110 +323,201 @@ void HistoryPlot::filePrint(){
 //--------------------------------------------------------------------
 void HistoryPlot::fileSave(){
 
-  QString lFileName = Q3FileDialog::getSaveFileName(".", "Images (*.jpg)", 0,
-						   "save file dialog",
-						   "Choose a filename to save the image as");
+  QString lFilter;
+  QString lFileName = Q3FileDialog::getSaveFileName(".",
+			  "Images (*.png *.jpg);;Scalable Vector Graphics (*.svg)",
+			  0, "save file dialog",
+			  "Choose a filename to save the image as",
+			  &lFilter);
   // ensure the user gave us a sensible file
-  if (!lFileName.isNull()){
-    // ensure the file has a .jpg extension
-    if (!lFileName.endsWith(".jpg"))
-      lFileName.append(".jpg");
+  if (lFileName.isNull()){
+    return;
+  }
+  // ensure the file has a suitable extension
+  if (!lFileName.endsWith(".png") && !lFileName.endsWith(".jpg") &&
+      !lFileName.endsWith(".svg")){
+    lFileName.append(lFilter.contains("svg") ? ".svg" : ".png");
+  }
 
-    // spawn off a thread to take the screenshot, giving QT enough time
-    // to redraw the graph
-    ScreenGrabThread *lScreenGrabThread = new ScreenGrabThread(this,
-							       lFileName,
-							       mMenuBar);
-    lScreenGrabThread->start();
+  if (mExportThread){
+    QMessageBox::information( this, "Saving",
+			      "Please wait for the current save to finish." );
+    return;
+  }
+
+  QSize lSize = mPlotter->size();
+  if (!getExportSize(this, lSize)){
+    return;
   }
+
+  // Draw the plot ourselves rather than grabbing it from the screen
+  // so that any resolution may be had
+  ExportThread *lThread = new ExportThread(lFileName);
+  lThread->setImage(snapshot(lSize.width()), lSize);
+  startExport(lThread, "Saving image...");
 }
 
 //--------------------------------------------------------------------
-void HistoryPlot::fileDataSave(){
+bool HistoryPlot::getExportSize(QWidget *aParent, QSize &aSize){
+
+  bool lOk;
+  QRegExp lRegExp("^\\s*(\\d+)\\s*[xX]\\s*(\\d+)\\s*$");
+
+  while(true){
+    QString lText = QInputDialog::getText("Image size",
+			     "Width x height (pixels) of the image:",
+			     QLineEdit::Normal,
+			     QString("%1 x %2").arg(aSize.width()).arg(aSize.height()),
+			     &lOk, aParent);
+    if(!lOk){
+      return false;
+    }
+    if(lRegExp.indexIn(lText) == 0 &&
+       lRegExp.cap(1).toInt() > 0 && lRegExp.cap(2).toInt() > 0){
+      aSize = QSize(lRegExp.cap(1).toInt(), lRegExp.cap(2).toInt());
+      return true;
+    }
+  }
+}
+
+//--------------------------------------------------------------------
+PlotSnapshot HistoryPlot::snapshot(int aWidth){
 
-  int     i;
+  PlotSnapshot lSnapshot;
   HistorySubPlot *plot;
+  SharedAbscissa lHistAbscissa;
+  SharedAbscissa lLiveAbscissa;
+
+  lSnapshot.mTitle = caption();
+  lSnapshot.mXLabel = QString(mLabelx);
+  lSnapshot.mXMap = mPlotter->canvasMap(QwtPlot::xBottom);
+  lSnapshot.mYMap = mPlotter->canvasMap(QwtPlot::yLeft);
+  lSnapshot.mXDiv = *(mPlotter->axisScaleDiv(QwtPlot::xBottom));
+  lSnapshot.mYDiv = *(mPlotter->axisScaleDiv(QwtPlot::yLeft));
+  lSnapshot.mShowSymbols = mDisplaySymbolsSet;
+  lSnapshot.mShowLines = mDisplayCurvesSet;
+  lSnapshot.mShowDensity = mDisplayDensitySet;
+
+  // Decimate afresh for the width of the image rather than that
+  // of the window
+  lHistAbscissa.transform(mXParamHist->mPtrPreviousHistArray,
+			  mXParamHist->mPreviousHistArraySize, aWidth);
+  lLiveAbscissa.transform(mXParamHist->ptrToArray(),
+			  mXParamHist->mArrayPos, aWidth);
 
-  QString lFileName = Q3FileDialog::getSaveFileName(".", "Data (*.dat)", 0,
-						   "save file dialog",
-						   "Choose a name for the data file");
-  // ensure the user gave us a sensible file
-  if (!lFileName.isNull()){
+  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+    if(!plot->isVisible()){
+      continue;
+    }
+    if(mDisplayDensitySet){
+      // The last one drawn ends up on top
+      lSnapshot.mDensity = plot->density();
+      continue;
+    }
 
-    // ensure the file has a .dat extension
-    if (!lFileName.endsWith(".dat"))
-      lFileName.append(".dat");
+    PlotSnapshot::Curve lCurve;
+    lCurve.mLabel = plot->getCurveLabel();
+    lCurve.mColour = plot->getColour();
+    lHistAbscissa.reduce(plot->mYParamHist->mPtrPreviousHistArray,
+			 plot->mYParamHist->mPreviousHistArraySize,
+			 lCurve.mHistX, lCurve.mHistY);
+    lLiveAbscissa.reduce(plot->mYParamHist->ptrToArray(),
+			 plot->mYParamHist->mArrayPos,
+			 lCurve.mLiveX, lCurve.mLiveY);
+    lSnapshot.mCurves.append(lCurve);
+  }
 
-    QFile file(lFileName);
+  return lSnapshot;
+}
 
-    if( !file.open( QIODevice::WriteOnly ) ){
-      QMessageBox::warning( this, "Saving", "Failed to save file." );
-      return;
-    }
+//--------------------------------------------------------------------
+void HistoryPlot::fileDataSave(){
 
-    Q3TextStream ts( &file );
+  HistorySubPlot *plot;
+  QString lFilter;
+
+  QString lFileName = Q3FileDialog::getSaveFileName(".",
+			  "Data (*.dat);;Binary columns (*.bin);;"
+			  "Compressed binary columns (*.binz)", 0,
+			  "save file dialog",
+			  "Choose a name for the data file",
+			  &lFilter);
+  // ensure the user gave us a sensible file
+  if (lFileName.isNull()){
+    return;
+  }
 
-    // Header for data
-    ts << "# Data exported from RealityGrid Qt Steering Client" << endl;
-    ts << "# Seq no.";
-    plot = mSubPlotList.first();
-    while(plot){
-      ts << ", " << plot->getCurveLabel();
-      plot = mSubPlotList.next();
-    }
-    ts << endl;
-
-    // Work out how many points we've got of 'historical data' - compare
-    // the no. available for each ordinate and use the smaller of the two.
-    plot = mSubPlotList.first();
-    int lNumPts = plot->mYParamHist->mPreviousHistArraySize;
-    plot = mSubPlotList.next();
-    while(plot){
-      if(lNumPts > plot->mYParamHist->mPreviousHistArraySize){
-	lNumPts = plot->mYParamHist->mPreviousHistArraySize;
-      }
-      plot = mSubPlotList.next();
-    }
-    if(mXParamHist->mPreviousHistArraySize < lNumPts){
-      lNumPts = mXParamHist->mPreviousHistArraySize;
-    }
-    double *lX = mXParamHist->mPtrPreviousHistArray;
-
-    // The 'historical' data itself
-    for(i=0; i<lNumPts; i++){
-      ts << lX[i] ;
-      for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
-	ts << QString("  %1").arg((plot->mYParamHist->mPtrPreviousHistArray)[i],
-				  0, 'e', 8);
-      }
-      ts << endl;
-    }
+  // ensure the file has a .dat, .bin or .binz extension
+  if (!lFileName.endsWith(".dat") && !lFileName.endsWith(".bin") &&
+      !lFileName.endsWith(".binz")){
+    lFileName.append(lFilter.contains("binz") ? ".binz" :
+		     lFilter.contains("bin") ? ".bin" : ".dat");
+  }
 
-    // Now do the data we've collected whilst we've been attached
-    plot = mSubPlotList.first();
-    lNumPts = plot->mYParamHist->mArrayPos;
-    plot = mSubPlotList.next();
-    while(plot){
-      if(lNumPts > plot->mYParamHist->mArrayPos){
-	lNumPts = plot->mYParamHist->mArrayPos;
-      }
-      plot = mSubPlotList.next();
+  if (mExportThread){
+    QMessageBox::information( this, "Saving",
+			      "Please wait for the current save to finish." );
+    return;
+  }
+
+  ExportThread *lExporter = new ExportThread(lFileName);
+  QStringList lLabels("Seq no.");
+  QVector<const double *> lHist(1, mXParamHist->mPtrPreviousHistArray);
+  QVector<const double *> lLive(1, mXParamHist->ptrToArray());
+
+  // Work out how many points we've got both before and since we
+  // attached - use the smallest number available for any ordinate
+  int lNumHist = mXParamHist->mPreviousHistArraySize;
+  int lNumLive = mXParamHist->mArrayPos;
+  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+    lLabels.append(plot->getCurveLabel());
+    lHist.append(plot->mYParamHist->mPtrPreviousHistArray);
+    lLive.append(plot->mYParamHist->ptrToArray());
+    if(lNumHist > plot->mYParamHist->mPreviousHistArraySize){
+      lNumHist = plot->mYParamHist->mPreviousHistArraySize;
     }
-    if(mXParamHist->mArrayPos < lNumPts){
-      lNumPts = mXParamHist->mArrayPos;
+    if(lNumLive > plot->mYParamHist->mArrayPos){
+      lNumLive = plot->mYParamHist->mArrayPos;
     }
-    lX = mXParamHist->ptrToArray();
+  }
 
-    // The data itself
-    for(i=0; i<lNumPts; i++){
-      ts << lX[i];
-      for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
-	ts << QString("  %1").arg((plot->mYParamHist->ptrToArray())[i], 0, 'e', 8);
-      }
-      ts << endl;
-    }
+  lExporter->setComment("Data exported from RealityGrid Qt Steering Client");
+  lExporter->setLabels(lLabels);
+  // The 'historical' data then the data we've collected whilst
+  // we've been attached.  Copies are taken now so that new data can
+  // keep arriving while the file is written.
+  lExporter->addBlockCopy(lHist, lNumHist);
+  lExporter->addBlockCopy(lLive, lNumLive);
 
-    file.close();
+  startExport(lExporter, "Saving data...");
+}
+
+//--------------------------------------------------------------------
+/** Run an export on its own thread with a progress dialog that lets
+ *  the user cancel it.  Only this window is blocked while it runs.
+ */
+void HistoryPlot::startExport(ExportThread *aThread, const QString &aLabel){
+
+  mExportThread = aThread;
+  connect(mExportThread, SIGNAL(finished()),
+	  this, SLOT(exportFinishedSlot()));
+  mExportThread->startWithProgress(this, aLabel);
+}
+
+//--------------------------------------------------------------------
+void HistoryPlot::exportFinishedSlot(){
+
+  if(!mExportThread){
+    return;
+  }
+
+  bool lFailed = !mExportThread->succeeded() && !mExportThread->wasCancelled();
+
+  mExportThread->deleteLater();
+  mExportThread = NULL;
+
+  if(lFailed){
+    QMessageBox::warning( this, "Saving", "Failed to save file." );
   }
 }
 
@@ -376,10 +531,7 @@ void HistoryPlot::fileQuit(){
  */
 void HistoryPlot::doPlot(){
 
-  HistorySubPlot *plot;
-  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
-    plot->doPlot(mForceHistRedraw);
-  }
+  updateCurves();
 
   // allow the user to define the Y axis dims if desired
   if (mAutoYAxisSet){
@@ -398,6 +550,9 @@ void HistoryPlot::doPlot(){
     mPlotter->setAxisScale(mPlotter->xBottom, mXLowerBound, mXUpperBound);
   }
 
+  // In follow mode the automatic axes track the window instead
+  followAxes();
+
   // Insert a horizontal line at y = 0...
   //long mY = mPlotter->insertLineMarker("y = 0", QwtPlot::yLeft);
   //mPlotter->setMarkerYPos(mY, 0.0);
@@ -407,6 +562,301 @@ void HistoryPlot::doPlot(){
   return;
 }
 
+//--------------------------------------------------------------------
+/** Hand the latest data to each of the sub-plots, either as
+ *  decimated curves or as density plots
+ */
+void HistoryPlot::updateCurves(){
+
+  HistorySubPlot *plot;
+  HistorySubPlot *lTopPlot = NULL;
+
+  if(mDisplayDensitySet){
+    for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+      plot->doDensityPlot();
+      if(plot->isVisible()){
+	lTopPlot = plot;
+      }
+    }
+
+    // Colour bar for the density plot that ends up on top
+    if(lTopPlot){
+      QwtDoubleInterval lRange = lTopPlot->density().range();
+      mPlotter->axisWidget(QwtPlot::yRight)->setColorMap(lRange,
+				 DensityGrid::colourMap());
+      mPlotter->setAxisScale(QwtPlot::yRight,
+			     lRange.minValue(), lRange.maxValue());
+    }
+  }
+  else{
+    decimateCurves();
+
+    // A moving window means the older data have to be redone too
+    for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+      plot->doPlot(mForceHistRedraw || (mFollowMode != kFOLLOW_OFF));
+    }
+  }
+  mForceHistRedraw = false;
+}
+
+//--------------------------------------------------------------------
+/** Note when the latest data arrived so that follow mode can show
+ *  the last so-many seconds
+ */
+void HistoryPlot::recordUpdateTime(){
+
+  int lNum = mXParamHist->mArrayPos;
+
+  if(!mUpdateCounts.isEmpty() && mUpdateCounts.last() == lNum){
+    return;
+  }
+  QDateTime lNow = QDateTime::currentDateTime();
+  mUpdateTimes.append((double)lNow.toTime_t() + lNow.time().msec()/1000.0);
+  mUpdateCounts.append(lNum);
+}
+
+//--------------------------------------------------------------------
+/** Work out where the follow-mode window starts in the data logged
+ *  before and after we attached.  Everything is found by binary
+ *  search so the cost doesn't grow with the length of the run.
+ */
+void HistoryPlot::followWindow(int &aHistStart, int &aLiveStart){
+
+  int     lIndex;
+  int     lHistNum = mXParamHist->mPreviousHistArraySize;
+  int     lLiveNum = mXParamHist->mArrayPos;
+  double *lHist = mXParamHist->mPtrPreviousHistArray;
+  double *lLive = mXParamHist->ptrToArray();
+
+  if(!lHist){
+    lHistNum = 0;
+  }
+  aHistStart = 0;
+  aLiveStart = 0;
+  mFollowXMin = mFollowXMax = 0.0;
+
+  if(mFollowMode == kFOLLOW_SECONDS){
+    // There's no record of when the data from before we attached
+    // were logged so they're never in the window
+    aHistStart = lHistNum;
+
+    QDateTime lNow = QDateTime::currentDateTime();
+    double lFrom = (double)lNow.toTime_t() + lNow.time().msec()/1000.0 -
+      mFollowSpan;
+    lIndex = qLowerBound(mUpdateTimes.begin(), mUpdateTimes.end(), lFrom) -
+      mUpdateTimes.begin();
+    // Samples that had arrived before the first update in the window
+    // are out of it
+    if(lIndex > 0){
+      aLiveStart = mUpdateCounts[lIndex - 1];
+    }
+    if(aLiveStart > lLiveNum){
+      aLiveStart = lLiveNum;
+    }
+  }
+  else if(strcmp(mLabelx, "SEQUENCE_NUM") == 0){
+    // Sequence numbers increase so the window is a range of abscissa
+    if(lLiveNum > 0){
+      mFollowXMax = lLive[lLiveNum - 1];
+    }
+    else if(lHistNum > 0){
+      mFollowXMax = lHist[lHistNum - 1];
+    }
+    mFollowXMin = mFollowXMax - mFollowSpan;
+
+    aLiveStart = qLowerBound(lLive, lLive + lLiveNum, mFollowXMin) - lLive;
+    if(aLiveStart > 0 || !lHistNum){
+      aHistStart = lHistNum;
+    }
+    else{
+      aHistStart = qLowerBound(lHist, lHist + lHistNum, mFollowXMin) - lHist;
+    }
+  }
+  else{
+    // For anything else just take the last so-many samples
+    lIndex = (int)mFollowSpan;
+    aLiveStart = (lLiveNum > lIndex) ? (lLiveNum - lIndex) : 0;
+    lIndex -= (lLiveNum - aLiveStart);
+    aHistStart = (lHistNum > lIndex) ? (lHistNum - lIndex) : 0;
+  }
+}
+
+//--------------------------------------------------------------------
+/** In follow mode, set the range of the automatic axes from the
+ *  (decimated) data in the window rather than leaving Qwt to look
+ *  at everything
+ */
+void HistoryPlot::followAxes(){
+
+  HistorySubPlot *plot;
+  bool   lFound = false;
+  double lXMin = 0.0, lXMax = 0.0, lYMin = 0.0, lYMax = 0.0;
+  double lX0, lX1, lY0, lY1;
+
+  if(mFollowMode == kFOLLOW_OFF || mDisplayDensitySet){
+    return;
+  }
+
+  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+    if(!plot->getDataRange(lX0, lX1, lY0, lY1)){
+      continue;
+    }
+    if(!lFound){
+      lXMin = lX0; lXMax = lX1; lYMin = lY0; lYMax = lY1;
+      lFound = true;
+      continue;
+    }
+    if(lX0 < lXMin) lXMin = lX0;
+    if(lX1 > lXMax) lXMax = lX1;
+    if(lY0 < lYMin) lYMin = lY0;
+    if(lY1 > lYMax) lYMax = lY1;
+  }
+  if(!lFound){
+    return;
+  }
+
+  // Scroll smoothly rather than jumping with each new point
+  if(mFollowXMax > mFollowXMin){
+    lXMin = mFollowXMin;
+    lXMax = mFollowXMax;
+  }
+  if(lXMax <= lXMin){
+    lXMin -= 0.5;
+    lXMax += 0.5;
+  }
+  if(lYMax <= lYMin){
+    lY0 = (lYMin != 0.0) ? 0.05*fabs(lYMin) : 0.5;
+    lYMin -= lY0;
+    lYMax += lY0;
+  }
+
+  if(mAutoXAxisSet){
+    mPlotter->setAxisScale(QwtPlot::xBottom, lXMin, lXMax);
+  }
+  if(mAutoYAxisSet){
+    mPlotter->setAxisScale(QwtPlot::yLeft, lYMin, lYMax);
+  }
+}
+
+//--------------------------------------------------------------------
+/** Let the user choose how much of the data to show
+ */
+void HistoryPlot::followSlot(){
+
+  bool lOk;
+  QString lCurrent;
+  QRegExp lRegExp("^\\s*(\\d+(\\.\\d*)?)\\s*(s?)\\s*$");
+
+  if(mFollowMode == kFOLLOW_STEPS){
+    lCurrent = QString::number(mFollowSpan);
+  }
+  else if(mFollowMode == kFOLLOW_SECONDS){
+    lCurrent = QString::number(mFollowSpan) + "s";
+  }
+
+  QString lText = QInputDialog::getText("Follow latest data",
+		 "Show the last N steps (e.g. 1000) or the last T seconds\n"
+		 "(e.g. 60s).  Leave blank to show the whole history.",
+		 QLineEdit::Normal, lCurrent, &lOk, this);
+  if(!lOk){
+    return;
+  }
+
+  if(lText.trimmed().isEmpty()){
+    mFollowMode = kFOLLOW_OFF;
+  }
+  else if(lRegExp.indexIn(lText) == 0 && lRegExp.cap(1).toDouble() > 0.0){
+    mFollowSpan = lRegExp.cap(1).toDouble();
+    mFollowMode = lRegExp.cap(3).isEmpty() ? kFOLLOW_STEPS : kFOLLOW_SECONDS;
+  }
+  else{
+    QMessageBox::warning(this, "Follow latest data",
+			 "Please enter a number of steps or seconds.");
+    return;
+  }
+  mGraphMenu->setItemChecked(mFollowId, mFollowMode != kFOLLOW_OFF);
+
+  mForceHistRedraw = true;
+  // redraw the plot
+  doPlot();
+}
+
+//--------------------------------------------------------------------
+/** Transform the abscissae once and then reduce every curve onto
+ *  them.  With lots of curves the reduction is spread over all of
+ *  the available cores.
+ */
+void HistoryPlot::decimateCurves(){
+
+  // One bucket per pixel column of the canvas
+  int lNumBuckets = mPlotter->canvas()->contentsRect().width();
+  if(lNumBuckets < 100){
+    lNumBuckets = 100;
+  }
+
+  int lHistStart = 0;
+  int lLiveStart = 0;
+  bool lForceHist = mForceHistRedraw;
+
+  if(mFollowMode != kFOLLOW_OFF){
+    // Only the data in the window are looked at.  The window moves
+    // with every update so nothing can be carried over.
+    followWindow(lHistStart, lLiveStart);
+    mHistAbscissa.reset();
+    mLiveAbscissa.reset();
+    lForceHist = true;
+  }
+  else if(mForceHistRedraw){
+    mHistAbscissa.reset();
+  }
+
+  if(mXParamHist->mPtrPreviousHistArray){
+    mHistAbscissa.transform(mXParamHist->mPtrPreviousHistArray + lHistStart,
+			    mXParamHist->mPreviousHistArraySize - lHistStart,
+			    lNumBuckets);
+  }
+  else{
+    mHistAbscissa.reset();
+  }
+  mLiveAbscissa.transform(mXParamHist->ptrToArray() + lLiveStart,
+			  mXParamHist->mArrayPos - lLiveStart, lNumBuckets);
+
+  QList<HistorySubPlot *> lPlots;
+  HistorySubPlot *plot;
+  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+    lPlots.append(plot);
+  }
+
+  DecimateSubPlot lDecimate(&mHistAbscissa, lHistStart,
+			    &mLiveAbscissa, lLiveStart, lForceHist);
+  if(lPlots.count() > 1){
+    QtConcurrent::blockingMap(lPlots, lDecimate);
+  }
+  else if(lPlots.count() == 1){
+    lDecimate(lPlots.first());
+  }
+}
+
+//--------------------------------------------------------------------
+QColor HistoryPlot::nextColour(){
+
+  QColor lColour;
+
+  if(mColourIndex < (int)mColourList.count()){
+    lColour = QColor(mColourList[mColourIndex]);
+  }
+  else{
+    // Walk round the hue circle by the golden angle so that
+    // neighbouring curves are always easy to tell apart
+    int lHue = ((mColourIndex - mColourList.count())*137) % 360;
+    int lVal = 255 - 60*(((mColourIndex - mColourList.count())/360) % 3);
+    lColour.setHsv(lHue, 255, lVal);
+  }
+  mColourIndex++;
+
+  return lColour;
+}
+
 //--------------------------------------------------------------------
 /** Add another plot/curve to this history plot */
 void HistoryPlot::addPlot(ParameterHistory *_mYParamHist,
@@ -418,14 +868,45 @@ void HistoryPlot::addPlot(ParameterHistory *_mYParamHist,
 					 _mYParamHist,
 					 QString(_lLabely),
 					 _yparamID,
-		                         *mColourIter));
-  ++mColourIter;
+					 nextColour()));
+  mSubPlotList.last()->setDensityMode(mDisplayDensitySet);
 
   // redraw the plot
   mForceHistRedraw = true;
   doPlot();
 }
 
+//--------------------------------------------------------------------
+void HistoryPlot::setHistoryFile(HistoryFile *aFile)
+{
+  // Deleted (with the histories it owns) along with us
+  mHistoryFile = aFile;
+  mHistoryFile->setParent(this);
+
+  mGraphMenu->insertSeparator();
+  mGraphMenu->insertItem("Add &curve from file...", this,
+			 SLOT(addFileCurveSlot()), Qt::ALT+Qt::Key_C);
+}
+
+//--------------------------------------------------------------------
+/** Slot to let the user plot another column of the file this plot
+ *  was opened from
+ */
+void HistoryPlot::addFileCurveSlot(){
+
+  if(!mHistoryFile) return;
+
+  bool lOk = false;
+  QString lLabel = QInputDialog::getItem("Add curve",
+					 "Column to plot:",
+					 mHistoryFile->labels(), 0, false,
+					 &lOk, this);
+  if(!lOk) return;
+
+  int lColumn = mHistoryFile->labels().indexOf(lLabel);
+  addPlot(mHistoryFile->history(lColumn), lLabel.latin1(), lColumn);
+}
+
 //--------------------------------------------------------------------
 /** Slot to allow user to switch-on autoscaling for the y-axis
  *
@@ -609,6 +1090,33 @@ void HistoryPlot::graphDisplayCurvesSlot(){
   doPlot();
 }
 
+//--------------------------------------------------------------------
+/** Toggle between drawing each data point and drawing a density
+ *  plot (2D histogram) of the points
+ */
+void HistoryPlot::graphDisplayDensitySlot(){
+
+  mDisplayDensitySet = !mDisplayDensitySet;
+  mGraphMenu->setItemChecked(mShowDensityId, mDisplayDensitySet);
+  // Symbols and lines don't apply to a density plot
+  mGraphMenu->setItemEnabled(mShowSymbolsId, !mDisplayDensitySet);
+  mGraphMenu->setItemEnabled(mShowCurvesId, !mDisplayDensitySet);
+
+  HistorySubPlot *plot;
+  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+    plot->setDensityMode(mDisplayDensitySet);
+  }
+
+  QwtScaleWidget *lColourBar = mPlotter->axisWidget(QwtPlot::yRight);
+  lColourBar->setColorBarEnabled(mDisplayDensitySet);
+  lColourBar->setTitle(mDisplayDensitySet ? "log10(1 + count)" : "");
+  mPlotter->enableAxis(QwtPlot::yRight, mDisplayDensitySet);
+
+  mForceHistRedraw = true;
+  // redraw the plot
+  doPlot();
+}
+
 //--------------------------------------------------------------------
 /** Toggle use of log X axis
  */
@@ -659,10 +1167,10 @@ void HistoryPlot::toggleLogAxisYSlot(){
 /** Update the graph with new data
  */
 void HistoryPlot::updateSlot(){
-  HistorySubPlot *plot;
-  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
-    plot->update();
-  }
+
+  recordUpdateTime();
+  updateCurves();
+  followAxes();
 
   // Insert a horizontal line at y = 0...
   //long mY = mPlotter->insertLineMarker("y = 0", QwtPlot::yLeft);
@@ -682,6 +1190,24 @@ void HistoryPlot::updateSlot(){
   return;
 }
 
+//--------------------------------------------------------------------
+/** Called when the user clicks on a curve's entry in the legend
+ */
+void HistoryPlot::legendCheckedSlot(QwtPlotItem *aItem, bool aOn){
+
+  HistorySubPlot *plot;
+  for ( plot = mSubPlotList.first(); plot; plot = mSubPlotList.next() ){
+    if(plot->ownsCurve(aItem)){
+      plot->setVisible(aOn);
+      break;
+    }
+  }
+
+  // Hidden curves aren't kept up to date so redo everything
+  mForceHistRedraw = true;
+  doPlot();
+}
+
 //--------------------------------------------------------------------
 /** Override QWidget::closeEvent to catch the user clicking the close button
  *  in the window bar as well as them selecting Quit from the File menu.
@@ -65,20 +65,114 @@ HistorySubPlot::HistorySubPlot(HistoryPlot *lHistPlot,
 			       ParameterHistory *lYParamHist,
 			       const QString &lLabely,
 			       const int yparamID,
-			       const QString lColour)
+			       const QColor &lColour)
   : mHistPlot(lHistPlot), mPlotter(lPlotter), mXParamHist(lXParamHist),
-    mLabely(lLabely), mColour(lColour),
+    mLabely(lLabely), mColour(lColour), mVisible(true), mDensityMode(false),
+    mDensityLiveBinned(0), mDensityHistBinned(0),
     mYParamHist(lYParamHist),  mYparamID(yparamID)
 {
   mCurve           = new QwtPlotCurve(mLabely);
   mHistCurve       = new QwtPlotCurve(mLabely);
+  // One legend entry per parameter is plenty
+  mHistCurve->setItemAttribute(QwtPlotItem::Legend, false);
   mPreviousLogSize = 0;
+
+  mSpectrogram = new QwtPlotSpectrogram(mLabely);
+  mSpectrogram->setColorMap(DensityGrid::colourMap());
   //cout << "ARPDBG: HistorySubPlot: colour = " << mColour << endl;
 }
 
 //---------------------------------------------------------------------------
 HistorySubPlot::~HistorySubPlot()
 {
+  delete mSpectrogram;
+}
+
+//---------------------------------------------------------------------------
+void HistorySubPlot::decimate(const SharedAbscissa &aHistAbscissa,
+			      int aHistStart,
+			      const SharedAbscissa &aLiveAbscissa,
+			      int aLiveStart,
+			      bool lForceHistRedraw)
+{
+  // Nothing to do for curves the user has switched off
+  if(!mVisible){
+    return;
+  }
+
+  aLiveAbscissa.reduce(mYParamHist->ptrToArray() + aLiveStart,
+		       mYParamHist->mArrayPos - aLiveStart,
+		       mLiveX, mLiveY);
+
+  // The history from before we attached doesn't change unless it
+  // has been re-fetched
+  if(lForceHistRedraw ||
+     (mYParamHist->mPreviousHistArraySize != mPreviousLogSize)){
+    if(mYParamHist->mPtrPreviousHistArray){
+      aHistAbscissa.reduce(mYParamHist->mPtrPreviousHistArray + aHistStart,
+			   mYParamHist->mPreviousHistArraySize - aHistStart,
+			   mHistX, mHistY);
+    }
+    else{
+      mHistX.resize(0);
+      mHistY.resize(0);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+bool HistorySubPlot::getDataRange(double &aXMin, double &aXMax,
+				  double &aYMin, double &aYMax) const
+{
+  int  i;
+  bool lFound = false;
+  const QVector<double> *lX[2] = {&mHistX, &mLiveX};
+  const QVector<double> *lY[2] = {&mHistY, &mLiveY};
+
+  if(!mVisible){
+    return false;
+  }
+
+  // The decimated data keep the extremes of every bucket so this
+  // gives the same answer as looking at all of the data
+  for(int j = 0; j < 2; j++){
+    for(i = 0; i < lX[j]->size(); i++){
+      double lXVal = (*lX[j])[i];
+      double lYVal = (*lY[j])[i];
+      if(!lFound){
+	aXMin = aXMax = lXVal;
+	aYMin = aYMax = lYVal;
+	lFound = true;
+	continue;
+      }
+      if(lXVal < aXMin) aXMin = lXVal;
+      else if(lXVal > aXMax) aXMax = lXVal;
+      if(lYVal < aYMin) aYMin = lYVal;
+      else if(lYVal > aYMax) aYMax = lYVal;
+    }
+  }
+  return lFound;
+}
+
+//---------------------------------------------------------------------------
+void HistorySubPlot::attachCurve()
+{
+  if(mCurve->plot() != NULL) {
+    return;
+  }
+  mCurve->attach(mPlotter);
+  mCurve->setVisible(mVisible && !mDensityMode);
+  this->graphDisplayCurves();
+
+  // Make the new legend entry's check box show whether the curve
+  // is visible
+  if(mPlotter->legend()){
+    QwtLegendItem *lItem =
+      dynamic_cast<QwtLegendItem *>(mPlotter->legend()->find(mCurve));
+    if(lItem){
+      lItem->setChecked(mVisible);
+    }
+  }
 }
 
 //---------------------------------------------------------------------------
@@ -92,33 +186,17 @@ void HistorySubPlot::doPlot(bool lForceHistRedraw=false)
   mPreviousLogSize = mYParamHist->mPreviousHistArraySize;
 
   // Insert new curves if any
-  if(mCurve->plot() == NULL) {
-    mCurve->attach(mPlotter);
-    this->graphDisplayCurves();
-  }
-
-//   if(mCurveID == CURVE_UNSET){
-//     mCurveID = mPlotter->insertCurve(mLabely);
-//     if( !(mPlotter->legendEnabled(mCurveID)) ){
-//       // Only do this if not already enabled so as to prevent flicker
-//       mPlotter->enableLegend(true, mCurveID);
-//       mPlotter->legend()->setDisplayPolicy(QwtLegend::FixedIdentifier,
-// 					   (QwtLegendItem::ShowLine |
-// 					    QwtLegendItem::ShowText));
-//     }
-//     this->graphDisplayCurves();
-//   }
+  attachCurve();
 
   if(mHistCurve->plot() == NULL && mYParamHist->mPreviousHistArraySize > 0) {
     mHistCurve->attach(mPlotter);
+    mHistCurve->setVisible(mVisible && !mDensityMode);
     this->graphDisplayCurves();
   }
 
-//   if(mHistCurveID == CURVE_UNSET &&
-//      mYParamHist->mPreviousHistArraySize > 0){
-//     mHistCurveID = mPlotter->insertCurve(mLabely);
-//     this->graphDisplayCurves();
-//   }
+  if(!mVisible){
+    return;
+  }
 
   // Work out how many points we've got - compare the no. available
   // for each ordinate and use the smaller of the two.
@@ -160,25 +238,74 @@ void HistorySubPlot::doPlot(bool lForceHistRedraw=false)
       mHistCurve->setSymbol(lPlotSymbol);
   }
 
-  nPoints = mYParamHist->mArrayPos;
-  if(mXParamHist->mArrayPos < nPoints){
-    nPoints = mXParamHist->mArrayPos;
+  // Qwt takes a copy of the (decimated) data so our buffers are
+  // free to be refilled on the next update
+  mCurve->setData(mLiveX.data(), mLiveY.data(), mLiveX.size());
+
+  if(lReplotHistory) {
+    mHistCurve->setData(mHistX.data(), mHistY.data(), mHistX.size());
+  }
+}
+
+//---------------------------------------------------------------------------
+void HistorySubPlot::doDensityPlot()
+{
+  int lNum;
+
+  // The curve is kept for the sake of its legend entry
+  attachCurve();
+
+  // The history from before we attached only changes when it's
+  // re-fetched, in which case everything has to be binned again
+  lNum = mYParamHist->mPreviousHistArraySize;
+  if(mXParamHist->mPreviousHistArraySize < lNum){
+    lNum = mXParamHist->mPreviousHistArraySize;
+  }
+  if(lNum != mDensityHistBinned){
+    mDensity.clear();
+    mDensity.addPoints(mXParamHist->mPtrPreviousHistArray,
+		       mYParamHist->mPtrPreviousHistArray, lNum);
+    mDensityHistBinned = lNum;
+    mDensityLiveBinned = 0;
+  }
+
+  // Only the samples that have arrived since the last call
+  // need binning
+  lNum = mYParamHist->mArrayPos;
+  if(mXParamHist->mArrayPos < lNum){
+    lNum = mXParamHist->mArrayPos;
+  }
+  if(lNum > mDensityLiveBinned){
+    mDensity.addPoints(mXParamHist->ptrToArray() + mDensityLiveBinned,
+		       mYParamHist->ptrToArray() + mDensityLiveBinned,
+		       lNum - mDensityLiveBinned);
+    mDensityLiveBinned = lNum;
+  }
+
+  if(mSpectrogram->plot() == NULL){
+    mSpectrogram->attach(mPlotter);
   }
+  mSpectrogram->setVisible(mVisible);
+  mSpectrogram->setData(mDensity);
+}
 
-  // Shallow copy of data for plot
-  mCurve->setRawData(mXParamHist->ptrToArray(),
-		     mYParamHist->ptrToArray(), nPoints);
+//---------------------------------------------------------------------------
+void HistorySubPlot::setDensityMode(bool aOn)
+{
+  mDensityMode = aOn;
 
-  if(lReplotHistory) {
-    nPoints = mYParamHist->mPreviousHistArraySize;
-    if(mXParamHist->mPreviousHistArraySize < nPoints) {
-      nPoints = mXParamHist->mPreviousHistArraySize;
-    }
-    if(nPoints) {
-      mHistCurve->setRawData(mXParamHist->mPtrPreviousHistArray,
-			     mYParamHist->mPtrPreviousHistArray, nPoints);
-    }
+  if(!aOn && mSpectrogram->plot() != NULL){
+    mSpectrogram->detach();
   }
+  // The curves stay attached so that they keep their legend entries
+  mCurve->setVisible(mVisible && !aOn);
+  mHistCurve->setVisible(mVisible && !aOn);
+}
+
+//---------------------------------------------------------------------------
+const DensityGrid &HistorySubPlot::density() const
+{
+  return mDensity;
 }
 
 //---------------------------------------------------------------------------
@@ -262,3 +389,30 @@ QString HistorySubPlot::getCurveLabel()
 {
   return mLabely;
 }
+
+//---------------------------------------------------------------------------
+QColor HistorySubPlot::getColour() const
+{
+  return mColour;
+}
+
+//---------------------------------------------------------------------------
+void HistorySubPlot::setVisible(bool aVisible)
+{
+  mVisible = aVisible;
+  mCurve->setVisible(aVisible && !mDensityMode);
+  mHistCurve->setVisible(aVisible && !mDensityMode);
+  mSpectrogram->setVisible(aVisible);
+}
+
+//---------------------------------------------------------------------------
+bool HistorySubPlot::isVisible() const
+{
+  return mVisible;
+}
+
+//---------------------------------------------------------------------------
+bool HistorySubPlot::ownsCurve(const QwtPlotItem *aItem) const
+{
+  return (aItem == mCurve || aItem == mHistCurve);
+}
@@ -61,7 +61,8 @@
 #include "iotype.h"
 
 IOType::IOType(int aId, int aIOTypeType)
-  : mId(aId), mType(aIOTypeType), mNewFrequency(kNULL_FREQ)
+  : mId(aId), mType(aIOTypeType), mNewFrequency(kNULL_FREQ),
+    mCurrentFrequency(kNULL_FREQ)
 {
   REG_DBGCON("IOType");
   // Create an iotype object - this holds information about a sample or checkpont IOType.
@@ -119,6 +120,18 @@ IOType::getFrequency() const
   return mNewFrequency;
 }
 
+int
+IOType::getCurrentFrequency() const
+{
+  return mCurrentFrequency;
+}
+
+void
+IOType::setCurrentFrequency(const int aFreq)
+{
+  mCurrentFrequency = aFreq;
+}
+
 void
 IOType::setIndex(const int aRowIndex)
 {
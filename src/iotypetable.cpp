@@ -65,6 +65,7 @@
 #include "chkptform.h"
 #include "exception.h"
 #include "iotypetable.h"
+#include "steeringcommandbuilder.h"
 
 IOTypeTable::IOTypeTable(QWidget *aParent, const char *aName, int aSimHandle,
 			 QMutex *aMutex, bool aChkPtType)
@@ -172,50 +173,22 @@ IOTypeTable::getNumIOTypes() const
 int
 IOTypeTable::findIOTypeRowIndex(int aId) // SMR XXX used???
 {
-  // search iotype list to find iotype with aId.
-  // return the mRowIndex for that iotype - i.e. which row in
+  // return the mRowIndex for the iotype with aId - i.e. which row in
   // the table represents that iotype
   // return -1 if iotype not found
 
-  IOType *lIOTypePtr;
-
-  Q3PtrListIterator<IOType> mIOTypeIterator( mIOTypeList );
-  mIOTypeIterator.toFirst();
-  while ( (lIOTypePtr = mIOTypeIterator.current()) != 0)
-  {
-    if (lIOTypePtr->getId() == aId)
-    {
-      return lIOTypePtr->getRowIndex();
-    }
-    ++mIOTypeIterator;
-  }
-
-  return -1;
+  IOType *lIOTypePtr = mIOTypeByHandle.value(aId);
 
+  return lIOTypePtr ? lIOTypePtr->getRowIndex() : -1;
 }
 
 IOType *
 IOTypeTable::findIOType(int aId)
 {
-  // search iotype list to find iotype with aId.
-  // return pointer to that iotype
+  // return pointer to the iotype with aId
   // return kNULL is iotype not in list
 
-  IOType *lIOTypePtr;
-
-  Q3PtrListIterator<IOType> mIOTypeIterator( mIOTypeList );
-  mIOTypeIterator.toFirst();
-  while ( (lIOTypePtr = mIOTypeIterator.current()) != 0)
-  {
-    if (lIOTypePtr->getId() == aId)
-    {
-      return lIOTypePtr;
-    }
-    ++mIOTypeIterator;
-  }
-
-  return kNULL;
-
+  return mIOTypeByHandle.value(aId);
 }
 
 bool
@@ -228,7 +201,12 @@ IOTypeTable::updateRow(const int lHandle, const int lVal)
   IOType	*lIOTypePtr;
   if ((lIOTypePtr = findIOType(lHandle)) != kNULL)
   {
+    // Frequencies hardly ever change - leave the table alone if not
+    if (lIOTypePtr->getCurrentFrequency() == lVal)
+      return true;
+
     int lRowIndex = lIOTypePtr->getRowIndex();
+    lIOTypePtr->setCurrentFrequency(lVal);
     item(lRowIndex,kIO_VALUE_COLUMN)->setText(QString::number(lVal));
     updateCell(lRowIndex, kIO_VALUE_COLUMN);
     return true;
@@ -237,6 +215,33 @@ IOTypeTable::updateRow(const int lHandle, const int lVal)
   return false;
 }
 
+void
+IOTypeTable::updateRows(const int aNum, const int *aHandles, char **aLabels,
+			const int *aVals, const int *aTypes)
+{
+  // Cheap check for the usual case of nothing having changed since
+  // the last status message
+  if (mLastHandles.count() == aNum &&
+      !memcmp(mLastHandles.constData(), aHandles, aNum*sizeof(int)) &&
+      !memcmp(mLastVals.constData(), aVals, aNum*sizeof(int)))
+    return;
+
+  for (int i=0; i<aNum; i++)
+  {
+    //check if already exists - if so only update frequency value
+    if (!updateRow(aHandles[i], aVals[i]))
+    {
+      // new IOType so add it
+      addRow(aHandles[i], aLabels[i], aVals[i], aTypes[i]);
+    }
+  }
+
+  mLastHandles.resize(aNum);
+  memcpy(mLastHandles.data(), aHandles, aNum*sizeof(int));
+  mLastVals.resize(aNum);
+  memcpy(mLastVals.data(), aVals, aNum*sizeof(int));
+}
+
 
 void
 IOTypeTable::addRow(const int lHandle, const char *lLabel, const int lVal, const int lType)
@@ -294,7 +299,9 @@ IOTypeTable::addRow(const int lHandle, const char *lLabel, const int lVal, const
   }
 
   lIOTypePtr->setIndex(lRowIndex);
+  lIOTypePtr->setCurrentFrequency(lVal);
   mIOTypeList.append(lIOTypePtr);
+  mIOTypeByHandle.insert(lHandle, lIOTypePtr);
   incrementRowIndex();
 
 }
@@ -434,107 +441,37 @@ IOTypeTable::validateValueSlot( int aRow, int aCol )
 
 
 int
-IOTypeTable::setNewFreqValuesInLib()
+IOTypeTable::addNewFrequencies(SteeringCommandBuilder *aBuilder)
 {
-  // call ReG library function to set the new frequency values as per set in the GUI
+  // add the new frequency values set in the GUI to the builder
   // get the value direct from gui table
-  // clear all new value cells in table once values have been set
-  // return the number of values set
+  // return the number of values added
 
-  // Note: this only sets the values in the library - the "emit" of the new values
-  // to the steered application is done elsewhere via Emit_control()
+  // Note: the cells are only cleared (by clearNewValues) once the
+  // builder has sent the values
 
   if (getMaxRowIndex()==0)
     return 0;
 
-
   IOType *lIOTypePtr;
   int lCount = 0;
   Q3PtrListIterator<IOType> mIOTypeIterator( mIOTypeList );
-  int *lHandles = kNULL;
-  int *lFreqs = kNULL;
-  int lIndex=0;
 
-  try
+  mIOTypeIterator.toFirst();
+  while ( (lIOTypePtr = mIOTypeIterator.current()) != 0)
   {
-
-    // count the number of not empty frequency cells
-    mIOTypeIterator.toFirst();
-    while ( (lIOTypePtr = mIOTypeIterator.current()) != 0)
-    {
-      if (lIOTypePtr->getFrequency() > kNULL_FREQ)
-	lCount++;
-
-      ++mIOTypeIterator;
-    }
-
-    if (lCount>0)
+    if (lIOTypePtr->getFrequency() > kNULL_FREQ)
     {
-      // set up arrays for ReG libary call
-      lHandles = new int [lCount];
-      lFreqs = new int [lCount];
-
-      mIOTypeIterator.toFirst();
-      while ( ((lIOTypePtr = mIOTypeIterator.current()) != 0) &&
-	      (lIndex <lCount) )
-      {
-	if (lIOTypePtr->getFrequency() > kNULL_FREQ)
-	{
-	  lHandles[lIndex] = lIOTypePtr->getId();
-	  lFreqs[lIndex] = lIOTypePtr->getAndResetFrequency();
-	  lIndex++;
-	}
-	++mIOTypeIterator;
-
-      }
-
-      int lReGStatus = REG_FAILURE;
-
-      mMutexPtr->lock();
-
-      if (mChkPtTypeFlag){
-	lReGStatus = Set_chktype_freq(getSimHandle(), //ReG library
-				     lIndex,
-				     lHandles,
-				     lFreqs);
-      }
-      else{
-	lReGStatus = Set_iotype_freq(getSimHandle(),  //ReG library
-				     lIndex,
-				     lHandles,
-				     lFreqs);
-      }
-      mMutexPtr->unlock();
-
-      // set the values in the steering library
-      if (lReGStatus != REG_SUCCESS)
-      {
-	THROWEXCEPTION("Set_iotype_freq");
-      }
-
-      // clear the cells in the table
-      clearNewValues();
-
-      // clean up
-      delete [] lHandles;
-      delete [] lFreqs;
-
+      aBuilder->addFrequency(mChkPtTypeFlag, lIOTypePtr->getId(),
+			     lIOTypePtr->getAndResetFrequency());
+      lCount++;
     }
-
-  } //try
-
-  catch (SteererException StEx)
-    {
-      // clean up
-    delete [] lHandles;
-    delete [] lFreqs;
-
-    throw StEx;
+    ++mIOTypeIterator;
   }
 
-  REG_DBGMSG1("do set_iottype_freq ",lIndex);
+  REG_DBGMSG1("addNewFrequencies ",lCount);
 
-  return lIndex;
+  return lCount;
 
 }
 
@@ -545,23 +482,15 @@ IOTypeTable::emitValuesSlot()
   // and "emit" these to the steered application
   // the new value cells in the table will be cleared as part of this
   // ready for user to enter the next values
-  int lReGStatus = REG_FAILURE;
+  SteeringCommandBuilder *lBuilder = commandBuilder();
 
   try
   {
-
-    if (setNewFreqValuesInLib() > 0)
+    lBuilder->reset();
+    if (addNewFrequencies(lBuilder) > 0)
     {
-      mMutexPtr->lock();
-      // "emit" values to steered application
-      lReGStatus = Emit_control(getSimHandle(),	       	//ReG library
-				0,
-				NULL,
-				NULL);
-      mMutexPtr->unlock();
-
-      if (lReGStatus != REG_SUCCESS)
-	THROWEXCEPTION("Emit_contol");
+      lBuilder->send();
+      clearNewValues();
     }
     else {
       REG_DBGMSG("No new freq to send");
@@ -710,93 +639,29 @@ void IOTypeTable::setCreateRestartButtonStates(){
 }
 
 
-/** MR: replaces the getCommandReqestCount method
- */
-int IOTypeTable::getCommandRequestsCountNew(){
-  int lCount = 0;
-
-  for (int i=0; i<numRows(); i++){
-    if (isRowSelected(i))
-      lCount++;
-  }
-
-  return lCount;
-}
-
-/** MR: simple method to count the number of Input or Output
- *      entries in the Sample IOType table / Data IO
- */
-int IOTypeTable::getCommandRequestsCountOfType(const int aType){
-  int result = 0;
-  QString comparisonTestString;
-
-  if (aType == REG_IO_IN)
-    comparisonTestString = "Input";
-  else if (aType == REG_IO_OUT)
-    comparisonTestString = "Output";
-  else return result;
-
-  for (int i=0; i<numRows(); i++){
-    if (isRowSelected(i) && text(i, kIO_REQUEST_COLUMN).compare(comparisonTestString) == 0)
-      result++;
-  }
-
-  return result;
-}
-
 /** MR: this slot will replace the current emitCommandsSlot
  */
 void IOTypeTable::createButtonPressedSlot(){
-  int i;
-
   // this slot will get called for the SampleIOTypes table "Tell Req"
   // button as well, so ignore those events
   if (!mChkPtTypeFlag)
     return;
 
-  int lCount = 0;
-  int *lCommandArray = kNULL;
-  char **lCmdParamArray = kNULL;
+  SteeringCommandBuilder *lBuilder = commandBuilder();
 
   try {
-    lCount = getCommandRequestsCountNew();
-
-    if (lCount > 0){
-      // populate the array of commands of command parameters
-      lCommandArray = new int[lCount];
-      lCmdParamArray = new char*[lCount];
-      for (i=0; i<lCount; i++){
-        lCmdParamArray[i] = new char[kCHKPT_PARAM_LEN];
-        strcpy(lCmdParamArray[i], " ");
-      }
-
-      int lNumAdded = populateCommandRequestArrayNew(lCommandArray, lCmdParamArray, lCount, 0);
+    lBuilder->reset();
+    int lNumAdded = addCommandRequests(lBuilder);
 
-      // library call to emit application
-      if (lNumAdded >0){
-        if (Emit_control(getSimHandle(), lNumAdded, lCommandArray, lCmdParamArray) != REG_SUCCESS){
-          THROWEXCEPTION("Emit_control");
-        }
-      }
-      REG_DBGMSG1("Sent Sample Commands", lCount);
-
-      // clean up
-      delete[] lCommandArray;
-      for (int i=0; i<lCount; i++)
-        delete[] lCmdParamArray[i];
-      delete [] lCmdParamArray;
-
-    } // if lcount > 0
+    // library call to emit application
+    if (lNumAdded > 0){
+      lBuilder->send();
+      REG_DBGMSG1("Sent ChkPt Commands", lNumAdded);
+    }
   } // try
   catch (SteererException StEx){
     StEx.print();
 
-    // clean up
-    delete[] lCommandArray;
-    for (i=0; i<lCount; i++)
-      delete[] lCmdParamArray[i];
-    delete [] lCmdParamArray;
-
     emit detachFromApplicationForErrorSignal();
     QMessageBox::warning(0, "Steerer Error",
 			 "Failed to emit commands to create "
@@ -811,20 +676,13 @@ void IOTypeTable::createButtonPressedSlot(){
 void IOTypeTable::restartButtonPressedSlot(){
   // this slot will only get called for the Create button form,
   // so no need to worry about the other table
-  int *lCommandArray = kNULL;
-  char **lCmdParamArray = kNULL;
   ChkPtForm *lChkPtForm = kNULL;
+  SteeringCommandBuilder *lBuilder = commandBuilder();
 
   try {
     REG_DBGMSG1("populate: mRestartrowIndex is", mRestartRowIndexNew);
 
     if (mRestartRowIndexNew > kNULL_INDX){
-      // populate the array of commands and array of command parameters
-      lCommandArray = new int[1];
-      lCmdParamArray = new char*[1];
-      lCmdParamArray[0] = new char[kCHKPT_PARAM_LEN];
-      strcpy(lCmdParamArray[0], " ");
-
       bool lOk = false;
 
       // actually need to be a little smarter here - need to check that the particular row is restartable...
@@ -832,8 +690,6 @@ void IOTypeTable::restartButtonPressedSlot(){
         // find the cmdid for this row
         int lCmdId = this->text(mRestartRowIndexNew, kIO_ID_COLUMN).toInt(&lOk);
         if (lOk){
-          lCommandArray[0] = lCmdId;
-
           // Get number log entries for this checkpoint
           int lNumEntries = 0;
           mMutexPtr->lock();
@@ -851,13 +707,13 @@ void IOTypeTable::restartButtonPressedSlot(){
               if (lChkPtForm->exec() == QDialog::Accepted){
                 REG_DBGMSG1("ChkPt accepted, tag = ",
 			lChkPtForm->getChkTagSelected());
-                sprintf(lCmdParamArray[0], "IN %s",
-			lChkPtForm->getChkTagSelected());
+                char lCmdParam[kCHKPT_PARAM_LEN];
+                snprintf(lCmdParam, sizeof(lCmdParam), "IN %s",
+			 lChkPtForm->getChkTagSelected());
 
-                if (Emit_control(getSimHandle(), 1, lCommandArray,
-				 lCmdParamArray) != REG_SUCCESS){
-                  THROWEXCEPTION("Emit_control");
-                }
+                lBuilder->reset();
+                lBuilder->addCommand(lCmdId, lCmdParam);
+                lBuilder->send();
                 REG_DBGMSG("Sent Restart Commands");
               } // QDialog::Accepted
               else {
@@ -893,11 +749,6 @@ void IOTypeTable::restartButtonPressedSlot(){
       //  lCheckItem->setChecked(false)
       mRestartRowIndexNew = kNULL_INDX;
 
-      // clean up
-      delete[] lCommandArray;
-      delete[] lCmdParamArray[0];
-      delete[] lCmdParamArray;
-
     } // if mRestartRowIndexNew > kNULL_INDX
     else {
       QMessageBox::information(0, "Steerer Restart Functionality",
@@ -912,9 +763,6 @@ void IOTypeTable::restartButtonPressedSlot(){
     StEx.print();
 
     // clean up
-    delete[] lCommandArray;
-    delete[] lCmdParamArray[0];
-    delete[] lCmdParamArray;
     delete lChkPtForm;
 
     emit detachFromApplicationForErrorSignal();
@@ -926,73 +774,60 @@ void IOTypeTable::restartButtonPressedSlot(){
 
 }
 
-/** Replaces the original populateCommandRequestArray method with a version
- *  that doesn't rely on the checkboxes...
+/** The commands are taken from the selected rows of the table (not
+ *  from checkboxes)
  */
-int IOTypeTable::populateCommandRequestArrayNew(int *aCmdArray, char **aCmdParamArray, const int aMaxCmds, const int aStartIndex)
+int IOTypeTable::addCommandRequests(SteeringCommandBuilder *aBuilder)
 {
-  // populate the array aCmdIds with the commands to be send starting at array index aStartIndex
-  // there should be exactly aMaxCmds to add - do not add any more as array not sized to hold an more
-  // note any not added will remain checked on GUI indicating that not been sent so no need to throw excp.
+  // add a command to aBuilder for each selected row, skipping
+  // checkpoint types that can only be read
+  // return the number of commands added
 
-  //QCheckTableItem *lCheckItem;
   IOType *lIOTypePtr;
   Q3PtrListIterator<IOType> mIOTypeIterator( mIOTypeList );
 
   int lNumAdded = 0;
-  int lIndex = aStartIndex;
 
   mIOTypeIterator.toFirst();
-  while ( ((lIOTypePtr = mIOTypeIterator.current()) != 0) && (lNumAdded  <= aMaxCmds)){
+  while ( (lIOTypePtr = mIOTypeIterator.current()) != 0 ){
     if (!(mChkPtTypeFlag && lIOTypePtr->getType() == REG_IO_IN)){
 
-      //lCheckItem = (QCheckTableItem *) this->item(lIOTypePtr->getRowIndex(), kIO_REQUEST_COLUMN);
       if (isRowSelected(lIOTypePtr->getRowIndex())){
-        aCmdArray[lIndex] = lIOTypePtr->getId();
-        if (mChkPtTypeFlag) // this should always be the case
-          strcpy(aCmdParamArray[lIndex], "OUT 1");
-        lIndex++;
+        // this should always be a checkpoint table
+        aBuilder->addCommand(lIOTypePtr->getId(),
+			     mChkPtTypeFlag ? "OUT 1" : " ");
         lNumAdded++;
       }
     }
     ++mIOTypeIterator;
   }
 
-  if (aMaxCmds != lNumAdded) {
-    REG_DBGMSG("Num iotype-commands sent not same as num expected ");
-  }
-
   // return the actual number of commands added
   return lNumAdded;
 
 }
 
-int IOTypeTable::populateCommandRequestArrayOfType(int *aCmdArray, char **aCmdParamArray, const int aMaxCmds, const int aStartIndex, const int aType)
+int IOTypeTable::addCommandRequestsOfType(SteeringCommandBuilder *aBuilder,
+					  const int aType)
 {
-  // populate the array aCmdIds with the commands to be sent starting at array index aStartIndex
-  // there should be exactly aMaxCmds to add - do not add any more as array not sized to hold an more
-  // note any not added will remain checked on GUI indicating that not been sent so no need to throw excp.
+  // add a command to aBuilder for each selected row of type aType
+  // in the Sample IOType / Data IO Table
+  // return the number of commands added
 
   IOType *lIOTypePtr;
   Q3PtrListIterator<IOType> mIOTypeIterator( mIOTypeList );
 
   int lNumAdded = 0;
-  int lIndex = aStartIndex;
 
   mIOTypeIterator.toFirst();
-  while ( ((lIOTypePtr = mIOTypeIterator.current()) != 0) && (lNumAdded  <= aMaxCmds)){
+  while ( (lIOTypePtr = mIOTypeIterator.current()) != 0 ){
 
-    //if (! (mChkPtTypeFlag && lIOTypePtr->getType() == REG_IO_IN) ){
     // Check to see if we've found a row matching the passed
     // type in the Sample IOType / Data IO Table
     if (!mChkPtTypeFlag && lIOTypePtr->getType() == aType){
 
       if (isRowSelected(lIOTypePtr->getRowIndex())){
-        aCmdArray[lIndex] = lIOTypePtr->getId();
-        if (mChkPtTypeFlag) // this should always be the case
-          strcpy(aCmdParamArray[lIndex], "OUT 1");
-
-        lIndex++;
+        aBuilder->addCommand(lIOTypePtr->getId(), " ");
         lNumAdded++;
       }
 
@@ -1001,18 +836,12 @@ int IOTypeTable::populateCommandRequestArrayOfType(int *aCmdArray, char **aCmdPa
     ++mIOTypeIterator;
   }
 
-  if (aMaxCmds != lNumAdded) {
-    REG_DBGMSG("Num iotype-commands sent not same as num expected ");
-  }
-
   // return the actual number of commands added
   return lNumAdded;
 
 }
 
 void IOTypeTable::consumeButtonPressedSlot(){
-  int i;
-
   // search through the table and find any highlighted entries,
   // read in data for those
   REG_DBGMSG("consumeButtonPressedSlot");
@@ -1022,52 +851,22 @@ void IOTypeTable::consumeButtonPressedSlot(){
   if (mChkPtTypeFlag)
     return;
 
-  int lCount = 0;
-  int *lCommandArray = kNULL;
-  char **lCmdParamArray = kNULL;
+  SteeringCommandBuilder *lBuilder = commandBuilder();
 
   try {
-    lCount = getCommandRequestsCountOfType(REG_IO_IN);
-
-    if (lCount > 0){
-      lCommandArray = new int[lCount];
-      lCmdParamArray = new char*[lCount];
+    lBuilder->reset();
+    int lNumAdded = addCommandRequestsOfType(lBuilder, REG_IO_IN);
 
-      for (i=0; i<lCount; i++){
-        lCmdParamArray[i] = new char[kCHKPT_PARAM_LEN];
-        strcpy(lCmdParamArray[i], " ");
-      }
-
-      int lNumAdded = populateCommandRequestArrayOfType(lCommandArray, lCmdParamArray, lCount, 0, REG_IO_IN);
-
-      // library call to emit application
-      if (lNumAdded > 0){
-        if (Emit_control(getSimHandle(), lNumAdded, lCommandArray, lCmdParamArray) != REG_SUCCESS){
-          THROWEXCEPTION("Emit_control");
-        }
-      }
-      REG_DBGMSG1("Sent Sample Commands", lCount);
-
-      // clean up
-      delete[] lCommandArray;
-      for (int i=0; i<lCount; i++){
-        delete[] lCmdParamArray[i];
-      }
-      delete[] lCmdParamArray;
-
-    } // if lCount > 0
+    // library call to emit application
+    if (lNumAdded > 0){
+      lBuilder->send();
+      REG_DBGMSG1("Sent Sample Commands", lNumAdded);
+    }
 
   } // try
   catch (SteererException StEx){
     StEx.print();
 
-    // clean up
-    delete[] lCommandArray;
-    for (i=0; i<lCount; i++){
-      delete[] lCmdParamArray[i];
-    }
-    delete[] lCmdParamArray;
-
     emit detachFromApplicationForErrorSignal();
     QMessageBox::warning(0, "Steerer Error",
 			 "Internal library error - detaching from application",
@@ -1078,8 +877,6 @@ void IOTypeTable::consumeButtonPressedSlot(){
 }
 
 void IOTypeTable::emitButtonPressedSlot(){
-  int i;
-
   // search through the table and find any highlighted entries,
   // write data out for those
   REG_DBGMSG("emitButtonPressedSlot");
@@ -1089,55 +886,22 @@ void IOTypeTable::emitButtonPressedSlot(){
   if (mChkPtTypeFlag)
     return;
 
-  int lCount = 0;
-  int *lCommandArray = kNULL;
-  char **lCmdParamArray = kNULL;
+  SteeringCommandBuilder *lBuilder = commandBuilder();
 
   try {
-    lCount = getCommandRequestsCountOfType(REG_IO_OUT);
+    lBuilder->reset();
+    int lNumAdded = addCommandRequestsOfType(lBuilder, REG_IO_OUT);
 
-    if (lCount > 0){
-      lCommandArray = new int[lCount];
-      lCmdParamArray = new char*[lCount];
-
-      for (i=0; i<lCount; i++){
-        lCmdParamArray[i] = new char[kCHKPT_PARAM_LEN];
-        strcpy(lCmdParamArray[i], " ");
-      }
-
-      int lNumAdded = populateCommandRequestArrayOfType(lCommandArray,
-							lCmdParamArray,
-							lCount, 0,
-							REG_IO_OUT);
-      // library call to emit application
-      if (lNumAdded > 0){
-        if (Emit_control(getSimHandle(), lNumAdded, lCommandArray,
-			 lCmdParamArray) != REG_SUCCESS){
-          THROWEXCEPTION("Emit_control");
-        }
-      }
-      REG_DBGMSG1("Sent Sample Commands", lCount);
-
-      // clean up
-      delete[] lCommandArray;
-      for (i=0; i<lCount; i++){
-        delete[] lCmdParamArray[i];
-      }
-      delete[] lCmdParamArray;
-
-    } // if lCount > 0
+    // library call to emit application
+    if (lNumAdded > 0){
+      lBuilder->send();
+      REG_DBGMSG1("Sent Sample Commands", lNumAdded);
+    }
 
   } // try
   catch (SteererException StEx){
     StEx.print();
 
-    // clean up
-    delete[] lCommandArray;
-    for (i=0; i<lCount; i++){
-      delete[] lCmdParamArray[i];
-    }
-    delete[] lCmdParamArray;
-
     emit detachFromApplicationForErrorSignal();
     QMessageBox::warning(0, "Steerer Error",
 			 "Failed to emit commands - detaching from application",
@@ -0,0 +1,120 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file marshalarena.cpp
+    @brief Implementation of the MarshalArena class - reusable buffers
+    for calls to the steering library */
+
+#include "buildconfig.h"
+#include "marshalarena.h"
+#include "debug.h"
+
+MarshalArena::MarshalArena()
+{
+  REG_DBGCON("MarshalArena");
+
+  for(int i = 0; i < kNUM_STRING_BUFFERS; i++){
+    mStringLength[i] = 0;
+  }
+}
+
+//---------------------------------------------------------------------------
+MarshalArena::~MarshalArena()
+{
+  REG_DBGDST("MarshalArena");
+}
+
+//---------------------------------------------------------------------------
+Param_details_struct *MarshalArena::paramDetails(int aCount)
+{
+  if(mParamDetails.count() < aCount){
+    mParamDetails.resize(aCount);
+  }
+  return mParamDetails.data();
+}
+
+//---------------------------------------------------------------------------
+int *MarshalArena::ints(IntBuffer aBuffer, int aCount)
+{
+  QVector<int> &lInts = mInts[aBuffer];
+
+  if(lInts.count() < aCount){
+    lInts.resize(aCount);
+  }
+  return lInts.data();
+}
+
+//---------------------------------------------------------------------------
+char **MarshalArena::strings(StringBuffer aBuffer, int aCount, int aLength)
+{
+  QVector<char> &lStore = mStringStore[aBuffer];
+  QVector<char *> &lStrings = mStrings[aBuffer];
+  const char *lOldStore = lStore.constData();
+  int lOldSize = lStore.count();
+  int lFirst = lStrings.count();
+
+  if(lStore.count() < aCount*aLength){
+    lStore.resize(aCount*aLength);
+  }
+  if(lStrings.count() < aCount){
+    lStrings.resize(aCount);
+  }
+
+  // All of the pointers have to be redone if the store has moved,
+  // grown or the strings have changed length, otherwise just any new
+  // ones.  Any beyond what the store has room for (left from a
+  // request for more, shorter strings) are nulled - and are filled in
+  // again when the store grows, even if it grows in place.
+  if(aLength != mStringLength[aBuffer] || lStore.constData() != lOldStore ||
+     lStore.count() != lOldSize){
+    mStringLength[aBuffer] = aLength;
+    lFirst = 0;
+  }
+  for(int i = lFirst; i < lStrings.count(); i++){
+    lStrings[i] = (i+1)*aLength <= lStore.count() ?
+      lStore.data() + i*aLength : 0;
+  }
+  return lStrings.data();
+}
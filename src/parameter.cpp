@@ -63,6 +63,7 @@
 #include "parameter.h"
 #include "types.h"
 #include "debug.h"
+#include "exception.h"
 
 Parameter::Parameter(int aId, int aType, bool aSteerable,
 		     QString aLabel)
@@ -172,3 +173,89 @@ QString Parameter::getMaxString(){
 QString Parameter::getLabel(){
   return mLabel;
 }
+
+bool Parameter::isValidValue(const QString &aVal) const{
+  // empty means no new value so is always allowed
+  if(aVal.isEmpty()){
+    return true;
+  }
+
+  bool lOk = true;
+  bool lHaveMin = (mMinStr != "--");
+  bool lHaveMax = (mMaxStr != "--");
+
+  switch(mType){
+
+  case REG_INT:
+    {
+      int lNew = aVal.toInt(&lOk);
+      if(lOk && lHaveMin && lNew < mMinStr.toInt())
+	lOk = false;
+      if(lOk && lHaveMax && lNew > mMaxStr.toInt())
+	lOk = false;
+      break;
+    }
+
+  case REG_FLOAT:
+    {
+      float lNew = aVal.toFloat(&lOk);
+      if(lOk && lHaveMin && lNew < mMinStr.toFloat())
+	lOk = false;
+      if(lOk && lHaveMax && lNew > mMaxStr.toFloat())
+	lOk = false;
+      break;
+    }
+
+  case REG_DBL:
+    {
+      double lNew = aVal.toDouble(&lOk);
+      if(lOk && lHaveMin && lNew < mMinStr.toDouble())
+	lOk = false;
+      if(lOk && lHaveMax && lNew > mMaxStr.toDouble())
+	lOk = false;
+      break;
+    }
+
+  case REG_CHAR:
+    break;
+
+  default:
+    THROWEXCEPTION("Unknown parameter type");
+  }
+
+  return lOk;
+}
+
+double Parameter::clampValue(double aVal, const QString &aMin,
+			     const QString &aMax, bool *aClamped){
+  double lVal = aVal;
+
+  if(!aMin.isEmpty() && aMin != "--" && lVal < aMin.toDouble())
+    lVal = aMin.toDouble();
+  if(!aMax.isEmpty() && aMax != "--" && lVal > aMax.toDouble())
+    lVal = aMax.toDouble();
+
+  if(aClamped)
+    *aClamped = (lVal != aVal);
+  return lVal;
+}
+
+bool Parameter::updateValue(const char *aVal){
+  if(mValue == aVal){
+    return false;
+  }
+  mValue = aVal;
+  return true;
+}
+
+const QByteArray &Parameter::getValue() const{
+  return mValue;
+}
+
+QString Parameter::getNewValueString() const{
+  return mNewValue;
+}
+
+void Parameter::setNewValueString(const QString &aVal){
+  mNewValue = aVal;
+}
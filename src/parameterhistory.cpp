@@ -58,6 +58,11 @@ ParameterHistory::ParameterHistory(){
   mParamHistArray = (double *)malloc(mArraySize*sizeof(double));
   mPtrPreviousHistArray = NULL;
   mPreviousHistArraySize = 0;
+  mSparkStart = 0;
+  mSparkCount = 0;
+  mSparkStride = 1;
+  mSparkSum = 0.0;
+  mSparkPending = 0;
 }
 
 ParameterHistory::~ParameterHistory(){
@@ -67,10 +72,11 @@ ParameterHistory::~ParameterHistory(){
 // Bear in mind that the current implementation will just sit
 // eating up memory until the job is over... need to do something
 // a bit better and spool to file
-void ParameterHistory::updateParameter(const char* lVal){
+bool ParameterHistory::updateParameter(const char* lVal){
   if(lVal[0] != '\0'){
+    double lVal_d = (double)atof(lVal);
     if(mArrayPos < mArraySize){
-      mParamHistArray[mArrayPos++] = (double)atof(lVal);
+      mParamHistArray[mArrayPos++] = lVal_d;
     }
     else{
       void *dum = realloc((void *)mParamHistArray,
@@ -78,10 +84,50 @@ void ParameterHistory::updateParameter(const char* lVal){
       if(dum){
 	mParamHistArray = (double *)dum;
 	mArraySize += mArrayChunkSize;
-	mParamHistArray[mArrayPos++] = (double)atof(lVal);
+	mParamHistArray[mArrayPos++] = lVal_d;
       }
     }
+    return appendSparkline(lVal_d);
   }
+  return false;
+}
+
+bool ParameterHistory::appendSparkline(double aVal){
+
+  mSparkSum += aVal;
+  if(++mSparkPending < mSparkStride){
+    return false;
+  }
+  float lPoint = (float)(mSparkSum/mSparkPending);
+  mSparkSum = 0.0;
+  mSparkPending = 0;
+
+  if(mSparkCount == kSPARKLINE_POINTS){
+    if(mSparkStride < kMAX_SPARKLINE_STRIDE){
+      // Merge pairs of points.  Points are only dropped once the
+      // stride has stopped growing so mSparkStart is still zero.
+      for(int i = 0; i < kSPARKLINE_POINTS/2; i++){
+	mSpark[i] = 0.5f*(mSpark[2*i] + mSpark[2*i + 1]);
+      }
+      mSparkCount = kSPARKLINE_POINTS/2;
+      mSparkStride *= 2;
+    }
+    else{
+      // Drop the oldest point
+      mSparkStart = (mSparkStart + 1) % kSPARKLINE_POINTS;
+      mSparkCount--;
+    }
+  }
+  mSpark[(mSparkStart + mSparkCount++) % kSPARKLINE_POINTS] = lPoint;
+  return true;
+}
+
+int ParameterHistory::getSparkline(float *aPoints) const{
+
+  for(int i = 0; i < mSparkCount; i++){
+    aPoints[i] = mSpark[(mSparkStart + i) % kSPARKLINE_POINTS];
+  }
+  return mSparkCount;
 }
 
 const float ParameterHistory::elementAt(int index){
@@ -59,6 +59,9 @@
 #include <qtooltip.h>
 #include <q3popupmenu.h>
 #include <qinputdialog.h>
+#include <qlineedit.h>
+#include <qpainter.h>
+#include <q3header.h>
 
 #include "buildconfig.h"
 #include "historyplot.h"
@@ -68,13 +71,15 @@
 #include "parametertable.h"
 #include "application.h"
 #include "controlform.h"
+#include "steeringcommandbuilder.h"
 
 #include "ReG_Steer_Steerside.h"
 
 ParameterTable::ParameterTable(QWidget *aParent, const char *aName,
 			       int aSimHandle, QMutex *aMutex)
-  : Table(aParent, aName, aSimHandle), mMutexPtr(aMutex),
-    mParent((ControlForm*)aParent)
+  : Table(aParent, aName, aSimHandle), mInBatch(false), mRowsAdded(false),
+    mSparklineColumn(-1), mSparklinesShown(false), mFilterIsRegExp(false),
+    mMutexPtr(aMutex), mParent((ControlForm*)aParent)
 {
   REG_DBGCON("ParameterTable");
 
@@ -124,12 +129,18 @@ ParameterTable::initTable()
   horizontalHeader()->setLabel(kNAME_COLUMN, "Name");
   horizontalHeader()->setLabel(kREG_COLUMN, "Registered?");
   horizontalHeader()->setLabel(kVALUE_COLUMN, "Value");
+  horizontalHeader()->setLabel(kMON_SPARKLINE_COLUMN, "Trend");
 
   hideColumn(kID_COLUMN);
   hideColumn(kREG_COLUMN);
   setColumnWidth(kREG_COLUMN, 90);
   setColumnWidth(kNAME_COLUMN, 200);
   setColumnWidth(kVALUE_COLUMN, 85);
+  setColumnWidth(kMON_SPARKLINE_COLUMN, 2*kSPARKLINE_POINTS);
+
+  // Sparklines are off until asked for
+  mSparklineColumn = kMON_SPARKLINE_COLUMN;
+  hideColumn(kMON_SPARKLINE_COLUMN);
 
   // MR: add a context menu so that we can right click on a cell to
   // draw a graph of that parameter's history
@@ -153,35 +164,32 @@ ParameterTable::updateRow(const int lHandle, const char *lVal,
   Parameter *lParamPtr;
   if ((lParamPtr = findParameter(lHandle)) != kNULL)
   {
-    // update the parameter value and call updateCell to make sure
-    // display is updated immediately
-    // Note: we could make the QTableItem displayed in this cell a
-    // member of parameter class  and just update that each time
-    // SMR XXX to check.
-    if((lVal[0] != '\0') &&
-       (lParamPtr->getType()==REG_FLOAT || lParamPtr->getType()==REG_DBL)){
-      double lTmp;
-      if(sscanf(lVal, "%lf", &lTmp) == 1){
-	// We do this to improve the formatting of floating point numbers
-	// - removes excessive decimal places.
-	item(lParamPtr->getRowIndex(),
-	     kVALUE_COLUMN)->setText(QString::number(lTmp));
-      }
-      else{
-	item(lParamPtr->getRowIndex(),
-	     kVALUE_COLUMN)->setText(QString(" "));
-      }
-    }
-    else{
-      item(lParamPtr->getRowIndex(), kVALUE_COLUMN)->setText(QString( lVal));
-    }
-
-    updateCell(lParamPtr->getRowIndex(),kVALUE_COLUMN);
-
     // If this update is a result of a status message then log values
     // of all parameters except those that are strings
+    bool lSparkChanged = false;
     if( isStatusMsg && (lParamPtr->getType() != REG_CHAR) ){
-      lParamPtr->mParamHist->updateParameter(lVal);
+      lSparkChanged = lParamPtr->mParamHist->updateParameter(lVal) &&
+	mSparklinesShown;
+    }
+
+    // Most values don't change from one message to the next - leave
+    // the table alone for those (and for rows that are filtered out)
+    bool lValChanged = lParamPtr->updateValue(lVal);
+    int lRow = lParamPtr->getRowIndex();
+    if(isFilteredOut(lRow)){
+      return true;
+    }
+
+    // the cells read the new value from the parameter - call
+    // updateCell to make sure display is updated (at the end of the
+    // batch if in one)
+    if(mInBatch){
+      if(lValChanged) mChangedRows.insert(lRow);
+      if(lSparkChanged) mChangedSparkRows.insert(lRow);
+    }
+    else{
+      if(lValChanged) updateCell(lRow, kVALUE_COLUMN);
+      if(lSparkChanged) updateCell(lRow, mSparklineColumn);
     }
 
     return true;
@@ -202,35 +210,20 @@ ParameterTable::addRow(const int lHandle,
 
   int lRowIndex = getMaxRowIndex();
 
-  // MR: removed - was causing problems, and giving no noticeable benefit
-  //if (lRowIndex >= getNumInitRows())
-  insertRows(lRowIndex);
+  // Rows are only ever appended.  The cells have no items - their
+  // contents come from the Parameter (see text())
+  setNumRows(lRowIndex + 1);
 
   Parameter *lParamPtr = new Parameter(lHandle, lType, false,
 				       QString(lLabel));
-
-  setText(lRowIndex, kID_COLUMN,
-	  QString::number(lHandle) );
-  setText(lRowIndex, kNAME_COLUMN, lLabel);
-  setText(lRowIndex, kREG_COLUMN, "Yes");
-
-  if( (lVal[0] != '\0') && (lType == REG_FLOAT || lType == REG_DBL) ){
-    double lTmp;
-    sscanf(lVal, "%lf", &lTmp);
-    setItem(lRowIndex, kVALUE_COLUMN,
-	    new Q3TableItem(this, Q3TableItem::Never,  QString::number(lTmp)));
-  }
-  else{
-    setItem(lRowIndex, kVALUE_COLUMN,
-	    new Q3TableItem(this, Q3TableItem::Never,  QString( lVal)));
-  }
   lParamPtr->setIndex(lRowIndex);
 
   // Don't store this initial value in the parameter's history because
   // it's often meaningless since the library hasn't yet got an
   // up-to-date value.
+  lParamPtr->updateValue(lVal);
 
-  mParamList.append(lParamPtr);
+  appendParameter(lParamPtr);
   incrementRowIndex();
 
   REG_DBGMSG1("mMaxRowIndexPtr", getMaxRowIndex());
@@ -239,75 +232,155 @@ ParameterTable::addRow(const int lHandle,
 
 
 //------------------------------------------------------------------------
-int
-ParameterTable::findParameterRowIndex(int aId)  // SMR XXX used anywhere??
+void
+ParameterTable::appendParameter(Parameter *aParam)
 {
-  // search parameter list to find parameter with aId.
-  // return the mRowIndex for that parameter - i.e. which row in
-  // the table represents that parameter
-  // return -1 if parameter not found
+  // Adding rows changes the whole table so hold off repainting until
+  // the end of the batch
+  if(mInBatch && !mRowsAdded){
+    setUpdatesEnabled(false);
+  }
+  mRowsAdded = true;
+
+  mParamList.append(aParam);
+  mParamByHandle.insert(aParam->getId(), aParam);
+  mParamByRow.insert(aParam->getRowIndex(), aParam);
+  // As with a search of the list, the first of any duplicates wins
+  if(!mParamByLabel.contains(aParam->getLabel())){
+    mParamByLabel.insert(aParam->getLabel(), aParam);
+  }
 
-  Parameter *lParamPtr;
+  // Keep the filter index up to date, and hide the new row if it
+  // doesn't pass the filter
+  int lRow = aParam->getRowIndex();
+  QString lLabel = aParam->getLabel().toLower();
+  if(mFilterLabels.size() <= lRow){
+    mFilterLabels.resize(lRow + 1);
+    mFilteredOut.resize(lRow + 1);
+  }
+  mFilterLabels[lRow] = lLabel;
+  if(matchesFilter(lLabel)){
+    mFilterMatches.append(lRow);
+  }
+  else{
+    mFilteredOut.setBit(lRow);
+    hideRow(lRow);
+  }
+}
 
-  Q3PtrListIterator<Parameter> mParamIterator( mParamList );
-  mParamIterator.toFirst();
-  while ( (lParamPtr = mParamIterator.current()) != 0)
-  {
-    if (lParamPtr->getId() == aId)
-    {
-      return lParamPtr->getRowIndex();
+//------------------------------------------------------------------------
+bool
+ParameterTable::matchesFilter(const QString &aLowerLabel) const
+{
+  if(mFilterIsRegExp){
+    return mFilterRegExp.indexIn(aLowerLabel) != -1;
+  }
+  return aLowerLabel.contains(mFilter);
+}
+
+//------------------------------------------------------------------------
+bool
+ParameterTable::isFilteredOut(int aRow) const
+{
+  return aRow < mFilteredOut.size() && mFilteredOut.testBit(aRow);
+}
+
+//------------------------------------------------------------------------
+bool
+ParameterTable::setFilter(const QString &aPattern, bool aRegExp)
+{
+  QRegExp lRegExp;
+  if(aRegExp){
+    lRegExp = QRegExp(aPattern, Qt::CaseInsensitive);
+    if(!lRegExp.isValid()){
+      return false;
     }
-    ++mParamIterator;
   }
 
-  return -1;
+  // Typing another character into a substring filter can only remove
+  // matches, so then only the current matches need checking
+  QString lFilter = aRegExp ? aPattern : aPattern.toLower();
+  bool lNarrowing = !aRegExp && !mFilterIsRegExp && lFilter.contains(mFilter);
+
+  if(!aRegExp && !mFilterIsRegExp && lFilter == mFilter){
+    return true;
+  }
+  mFilter = lFilter;
+  mFilterIsRegExp = aRegExp;
+  mFilterRegExp = lRegExp;
+
+  // Hiding and showing rows relays out the table - do it in one go
+  bool lUpdates = updatesEnabled();
+  setUpdatesEnabled(false);
+
+  QVector<int> lMatches;
+  if(lNarrowing){
+    for(int i = 0; i < mFilterMatches.count(); i++){
+      int lRow = mFilterMatches[i];
+      if(matchesFilter(mFilterLabels[lRow])){
+	lMatches.append(lRow);
+      }
+      else{
+	mFilteredOut.setBit(lRow);
+	hideRow(lRow);
+      }
+    }
+  }
+  else{
+    for(int lRow = 0; lRow < mFilterLabels.count(); lRow++){
+      bool lMatch = matchesFilter(mFilterLabels[lRow]);
+      if(lMatch){
+	lMatches.append(lRow);
+      }
+      if(lMatch == mFilteredOut.testBit(lRow)){
+	// Values of hidden rows may have changed since - showRow()
+	// repaints the row from the Parameter
+	mFilteredOut.setBit(lRow, !lMatch);
+	if(lMatch){
+	  showRow(lRow);
+	}
+	else{
+	  hideRow(lRow);
+	}
+      }
+    }
+  }
+  mFilterMatches = lMatches;
+
+  setUpdatesEnabled(lUpdates);
+  return true;
+}
+
+//------------------------------------------------------------------------
+int
+ParameterTable::findParameterRowIndex(int aId)  // SMR XXX used anywhere??
+{
+  // return the mRowIndex for the parameter with aId - i.e. which row
+  // in the table represents that parameter
+  // return -1 if parameter not found
+
+  Parameter *lParamPtr = mParamByHandle.value(aId);
 
+  return lParamPtr ? lParamPtr->getRowIndex() : -1;
 }
 
 //--------------------------------------------------------------------
 Parameter *
 ParameterTable::findParameter(int aId)
 {
-  // search parameter list to find parameter with aId.
-  // return pointer to that parameter
+  // return pointer to the parameter with aId
   // return kNULL if parameter not in list
 
-  Parameter *lParamPtr;
-
-  Q3PtrListIterator<Parameter> mParamIterator( mParamList );
-  mParamIterator.toFirst();
-  while ( (lParamPtr = mParamIterator.current()) != 0)
-  {
-    if (lParamPtr->getId() == aId)
-    {
-      return lParamPtr;
-    }
-    ++mParamIterator;
-  }
-
-  return kNULL;
+  return mParamByHandle.value(aId);
 }
 
 //-----------------------------------------------------------------
 // MR: reverse lookup of parameter ID
 Parameter* ParameterTable::findParameterHandleFromRow(int row){
-  // search through the parameter list for the parameter which
-  // has the given row index
-  // return the id of that parameter
+  // return the parameter which has the given row index
   // return kNULL if parameter is not in the list
 
-  Parameter *lParamPtr;
-
-  Q3PtrListIterator<Parameter> mParamIterator( mParamList );
-  mParamIterator.toFirst();
-  while ( (lParamPtr = mParamIterator.current()) != 0){
-    if (lParamPtr->getRowIndex() == row){
-      return lParamPtr;
-    }
-    ++mParamIterator;
-  }
-
-  return kNULL;
+  return mParamByRow.value(row);
 }
 
 //------------------------------------------------------------------
@@ -318,25 +391,14 @@ Parameter* ParameterTable::findParameterFromLabel(const QString &label)
   SteeredParameterTable *lSteeredTable;
 
   if( (lMonTable = mParent->getMonParamTable()) ){
-
-    Q3PtrListIterator<Parameter> lParamIterator( lMonTable->mParamList );
-    lParamIterator.toFirst();
-    while ( (lParamPtr = lParamIterator.current()) != 0){
-      if (lParamPtr->getLabel() == label){
-	return lParamPtr;
-      }
-      ++lParamIterator;
+    if( (lParamPtr = lMonTable->mParamByLabel.value(label)) ){
+      return lParamPtr;
     }
   }
 
   if( (lSteeredTable = mParent->getSteeredParamTable()) ){
-    Q3PtrListIterator<Parameter> lSteerParamIterator( lSteeredTable->mParamList );
-    lSteerParamIterator.toFirst();
-    while ( (lParamPtr = lSteerParamIterator.current()) != 0){
-      if (lParamPtr->getLabel() == label){
-	return lParamPtr;
-      }
-      ++lSteerParamIterator;
+    if( (lParamPtr = lSteeredTable->mParamByLabel.value(label)) ){
+      return lParamPtr;
     }
   }
 
@@ -344,6 +406,315 @@ Parameter* ParameterTable::findParameterFromLabel(const QString &label)
   return kNULL;
 }
 
+//-------------------------------------------------------------------
+void ParameterTable::beginUpdate()
+{
+  if(mInBatch){
+    return;
+  }
+  mInBatch = true;
+  mRowsAdded = false;
+  mChangedRows.clear();
+  mChangedSparkRows.clear();
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::endUpdate()
+{
+  if(!mInBatch){
+    return;
+  }
+  mInBatch = false;
+
+  if(mRowsAdded){
+    // Re-enabling updates repaints everything - and the column holding
+    // the labels may need to be wider
+    adjustColumn(0);
+    setUpdatesEnabled(true);
+    mRowsAdded = false;
+  }
+  else{
+    QSet<int>::const_iterator lIt;
+    for(lIt = mChangedRows.constBegin(); lIt != mChangedRows.constEnd();
+	++lIt){
+      updateCell(*lIt, kVALUE_COLUMN);
+    }
+    // Q3Table only repaints cells that are within the viewport
+    for(lIt = mChangedSparkRows.constBegin();
+	lIt != mChangedSparkRows.constEnd(); ++lIt){
+      updateCell(*lIt, mSparklineColumn);
+    }
+  }
+  mChangedRows.clear();
+  mChangedSparkRows.clear();
+}
+
+//-------------------------------------------------------------------
+QString ParameterTable::displayValue(Parameter *aParam) const
+{
+  const QByteArray &lVal = aParam->getValue();
+
+  if(!lVal.isEmpty() &&
+     (aParam->getType() == REG_FLOAT || aParam->getType() == REG_DBL)){
+    double lTmp;
+    if(sscanf(lVal.constData(), "%lf", &lTmp) == 1){
+      // We do this to improve the formatting of floating point numbers
+      // - removes excessive decimal places.
+      return QString::number(lTmp);
+    }
+    return QString(" ");
+  }
+  return QString(lVal);
+}
+
+//-------------------------------------------------------------------
+QString ParameterTable::text(int aRow, int aCol) const
+{
+  Parameter *lParamPtr = mParamByRow.value(aRow);
+
+  if(!lParamPtr){
+    return QString::null;
+  }
+
+  // Sparklines are drawn by paintCell()
+  if(aCol == mSparklineColumn){
+    return QString::null;
+  }
+
+  switch(aCol){
+  case kID_COLUMN:
+    return QString::number(lParamPtr->getId());
+  case kNAME_COLUMN:
+    return lParamPtr->getLabel();
+  case kREG_COLUMN:
+    return lParamPtr->isRegistered() ? "Yes" : "No";
+  case kVALUE_COLUMN:
+    return displayValue(lParamPtr);
+  case kNEWVALUE_COLUMN:
+    return lParamPtr->getNewValueString();
+  }
+  return QString::null;
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::setText(int aRow, int aCol, const QString &aText)
+{
+  Parameter *lParamPtr = mParamByRow.value(aRow);
+
+  if(!lParamPtr){
+    return;
+  }
+
+  // Only the registration status and new values can be changed
+  if(aCol == kREG_COLUMN && aText == "No"){
+    lParamPtr->unRegister();
+  }
+  else if(aCol == kNEWVALUE_COLUMN){
+    lParamPtr->setNewValueString(aText);
+  }
+  else{
+    return;
+  }
+  updateCell(aRow, aCol);
+}
+
+//-------------------------------------------------------------------
+Q3TableItem *ParameterTable::item(int aRow, int aCol) const
+{
+  return 0;
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::setItem(int aRow, int aCol, Q3TableItem *aItem)
+{
+  // Nowhere to keep it - take the text and drop the item
+  if(aItem){
+    setText(aRow, aCol, aItem->text());
+    delete aItem;
+  }
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::takeItem(Q3TableItem *aItem)
+{
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::clearCell(int aRow, int aCol)
+{
+  setText(aRow, aCol, QString::null);
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::resizeData(int aLen)
+{
+  // No per-cell storage to resize
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::insertWidget(int aRow, int aCol, QWidget *aWidget)
+{
+  if(aWidget){
+    mCellWidgets.insert(aRow*numCols() + aCol, aWidget);
+  }
+}
+
+//-------------------------------------------------------------------
+QWidget *ParameterTable::cellWidget(int aRow, int aCol) const
+{
+  return mCellWidgets.value(aRow*numCols() + aCol);
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::clearCellWidget(int aRow, int aCol)
+{
+  QWidget *lWidget = mCellWidgets.take(aRow*numCols() + aCol);
+
+  if(lWidget){
+    lWidget->removeEventFilter(this);
+    lWidget->hide();
+    lWidget->deleteLater();
+  }
+}
+
+//-------------------------------------------------------------------
+QWidget *ParameterTable::createEditor(int aRow, int aCol,
+				      bool aInitFromCell) const
+{
+  QWidget *lEditor = Q3Table::createEditor(aRow, aCol, aInitFromCell);
+
+  // Without an item the base class can't fill the editor in
+  QLineEdit *lLineEdit = qobject_cast<QLineEdit *>(lEditor);
+  if(lLineEdit && aInitFromCell){
+    lLineEdit->setText(text(aRow, aCol));
+  }
+  return lEditor;
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::setCellContentFromEditor(int aRow, int aCol)
+{
+  QLineEdit *lLineEdit = qobject_cast<QLineEdit *>(cellWidget(aRow, aCol));
+
+  if(lLineEdit){
+    setText(aRow, aCol, lLineEdit->text());
+  }
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::paintCell(QPainter *aPainter, int aRow, int aCol,
+			       const QRect &aRect, bool aSelected,
+			       const QColorGroup &aGroup)
+{
+  // Background (and grid) as for an empty cell
+  Q3Table::paintCell(aPainter, aRow, aCol, aRect, aSelected, aGroup);
+
+  if(aCol == mSparklineColumn){
+    Parameter *lParamPtr = mParamByRow.value(aRow);
+    if(lParamPtr){
+      paintSparkline(aPainter, lParamPtr, aRect, aSelected, aGroup);
+    }
+    return;
+  }
+
+  QString lText = text(aRow, aCol);
+  if(lText.isEmpty()){
+    return;
+  }
+
+  // Numbers are right-aligned, as they would be by a Q3TableItem
+  bool lIsNumber = false;
+  lText.toDouble(&lIsNumber);
+
+  aPainter->setPen(aSelected ? aGroup.highlightedText() : aGroup.text());
+  aPainter->drawText(2, 0, aRect.width() - 4, aRect.height(),
+		     (lIsNumber ? Qt::AlignRight : Qt::AlignLeft) |
+		     Qt::AlignVCenter, lText);
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::paintSparkline(QPainter *aPainter, Parameter *aParam,
+				    const QRect &aRect, bool aSelected,
+				    const QColorGroup &aGroup)
+{
+  float lPoints[kSPARKLINE_POINTS];
+  int lCount = aParam->mParamHist->getSparkline(lPoints);
+
+  if(lCount < 2){
+    return;
+  }
+
+  float lMin = lPoints[0];
+  float lMax = lPoints[0];
+  for(int i = 1; i < lCount; i++){
+    lMin = qMin(lMin, lPoints[i]);
+    lMax = qMax(lMax, lPoints[i]);
+  }
+
+  // Leave a margin of two pixels and draw a flat line through the
+  // middle if the parameter hasn't changed
+  int lWidth = aRect.width() - 4;
+  int lHeight = aRect.height() - 4;
+  float lRange = lMax - lMin;
+
+  QPolygon lLine(lCount);
+  for(int i = 0; i < lCount; i++){
+    int lY = lRange > 0.0f ?
+      (int)((lMax - lPoints[i])*(lHeight - 1)/lRange) : lHeight/2;
+    lLine.setPoint(i, 2 + (i*(lWidth - 1))/(kSPARKLINE_POINTS - 1), 2 + lY);
+  }
+
+  aPainter->setPen(aSelected ? aGroup.highlightedText() : aGroup.text());
+  aPainter->drawPolyline(lLine);
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::setSparklinesShown(bool aShown)
+{
+  if(mSparklineColumn < 0 || aShown == mSparklinesShown){
+    return;
+  }
+  mSparklinesShown = aShown;
+
+  // The sparklines are kept up to date regardless, so showing the
+  // column draws them as they are now
+  if(aShown){
+    showColumn(mSparklineColumn);
+    setColumnWidth(mSparklineColumn, 2*kSPARKLINE_POINTS);
+  }
+  else{
+    hideColumn(mSparklineColumn);
+  }
+}
+
+//-------------------------------------------------------------------
+void ParameterTable::adjustColumn(int aCol)
+{
+  // The base class only measures items
+  QFontMetrics lMetrics = fontMetrics();
+  int lWidth = lMetrics.width(horizontalHeader()->label(aCol)) + 10;
+
+  for(int i = 0; i < numRows(); i++){
+    lWidth = qMax(lWidth, lMetrics.width(text(i, aCol)) + 6);
+  }
+  setColumnWidth(aCol, lWidth);
+}
+
+//-------------------------------------------------------------------
+QStringList ParameterTable::getParameterLabels()
+{
+  QStringList lLabels;
+  Parameter *lParamPtr;
+
+  Q3PtrListIterator<Parameter> lParamIterator( mParamList );
+  lParamIterator.toFirst();
+  while ( (lParamPtr = lParamIterator.current()) != 0){
+    lLabels.append(lParamPtr->getLabel());
+    ++lParamIterator;
+  }
+  return lLabels;
+}
+
 //-------------------------------------------------------------------
 void
 ParameterTable::clearAndDisableForDetach(const bool aUnRegister)
@@ -580,6 +951,8 @@ SteeredParameterTable::initTable()
   // set up the steered parameters table - columns headings, readonly status of columns etc.
 
   setNumCols(kNUM_STEER_COLUMNS);
+  // No sparklines - the last column is for new values
+  mSparklineColumn = -1;
 
   setShowGrid(FALSE);
   verticalHeader()->hide();
@@ -649,84 +1022,12 @@ SteeredParameterTable::validateValueSlot( int aRow, int aCol )
     if  (lParamPtr == kNULL)
       THROWEXCEPTION("Failed to find parameter in list");
 
-    bool noMinValue = false;
-    bool noMaxValue = false;
-    const char *minString = lParamPtr->getMinString().latin1();
-    const char *maxString = lParamPtr->getMaxString().latin1();
-    if (strcmp(minString, "--") == 0)
-      noMinValue = true;
-    if (strcmp(maxString, "--") == 0)
-      noMaxValue = true;
-
-    // validate what user has entered - currently just validate it is correct type
-    // SMR XXX future - add more validation when range supported - will mean calling parameter member func
-    // as ranges will be held on parameter class
+    // validate what user has entered - its type and, if the
+    // parameter has them, its range
     if (lOk)
     {
       // always allow empty entry - means user is clearing the cell.
-      if (!newVal.isEmpty())
-      {
-        // MR: contains tests to check if the new values are legal
-        switch(lParamPtr->getType())
-        {
-            case REG_INT:
-            {
-              int newInt = newVal.toInt( &lOk );
-              // Now check to see if the values the user's entered are legal
-              if (lOk && !noMinValue){
-                 int min = atoi(minString);
-                 if (newInt < min)
-                   lOk = false;
-              }
-              if (lOk && !noMaxValue){
-                int max = atoi(maxString);
-                if (newInt > max)
-                  lOk = false;
-              }
-              break;
-            }
-
-            case REG_FLOAT:
-            {
-              float newFloat = newVal.toFloat( &lOk );
-              // Now check to see if the values the user's entered are legal
-              if (lOk && !noMinValue){
-                 float min = float(atof(minString));
-                 if (newFloat < min)
-                   lOk = false;
-              }
-              if (lOk && !noMaxValue){
-                float max = float(atof(maxString));
-                if (newFloat > max)
-                  lOk = false;
-              }
-              break;
-            }
-
-            case REG_DBL:
-            {
-              double newDouble = newVal.toDouble( &lOk );
-              // Now check to see if the values the user's entered are legal
-              if (lOk && !noMinValue){
-                 double min = atof(minString);
-                 if (newDouble < min)
-                   lOk = false;
-              }
-              if (lOk && !noMaxValue){
-                double max = atof(maxString);
-                if (newDouble > max)
-                  lOk = false;
-              }
-              break;
-            }
-
-            case REG_CHAR:
-              break;
-
-            default:
-              THROWEXCEPTION("Unknown parameter type");
-        }
-      }
+      lOk = lParamPtr->isValidValue(newVal);
 
       if (!lOk)
       {
@@ -777,28 +1078,18 @@ SteeredParameterTable::addRow(const int lHandle, const char *lLabel, const char
   if (lRowIndex==0)
     emit enableButtonsSignal();
 
-  // MR: removed - was causing problems, and giving no noticeable benefit
-  //if (lRowIndex >= getNumInitRows())
-    insertRows(lRowIndex);
-  //else
-  //  setRowReadOnly(lRowIndex, FALSE);  // set true in initTable SMR XXX rm when initRows goes
+  // Rows are only ever appended.  The cells have no items - their
+  // contents (including any new value the user types) are held by
+  // the Parameter
+  setNumRows(lRowIndex + 1);
 
   Parameter *lParamPtr = new Parameter(lHandle, lType, true,
 				       QString(lLabel));
   lParamPtr->setMinMaxStrings(lMinVal, lMaxVal);
 
-  setText(lRowIndex, kID_COLUMN,
-	     QString::number(lHandle) );
-  setText(lRowIndex, kNAME_COLUMN, lLabel);
-  setText(lRowIndex, kREG_COLUMN, "Yes");
-
-  setItem(lRowIndex, kVALUE_COLUMN,
-	     new Q3TableItem(this, Q3TableItem::Never,  QString( lVal)));
-  setItem(lRowIndex, kNEWVALUE_COLUMN,
-	     new Q3TableItem(this, Q3TableItem::OnTyping,  QString::null));
-
   lParamPtr->setIndex(lRowIndex);
-  mParamList.append(lParamPtr);
+  lParamPtr->updateValue(lVal);
+  appendParameter(lParamPtr);
   incrementRowIndex();
 
   REG_DBGMSG1("Steer MaxRowIndex Ptr", getMaxRowIndex());
@@ -807,16 +1098,14 @@ SteeredParameterTable::addRow(const int lHandle, const char *lLabel, const char
 
 //----------------------------------------------------------------------
 int
-SteeredParameterTable::setNewParamValuesInLib()
+SteeredParameterTable::addNewParamValues(SteeringCommandBuilder *aBuilder)
 {
-  // call ReG library function to set the new parameter values as
-  // per set in the GUI
+  // add the new parameter values set in the GUI to the builder
   // get the value direct from gui table
-  // clear all new value cells in table once values have been set
-  // return the number of parameters set
+  // return the number of parameters added
 
-  // Note: this only sets the values in the library - the "emit" of the new values
-  // to the steered application is done elsewhere via Emit_control()
+  // Note: the cells are only cleared (by clearNewValues) once the
+  // builder has sent the values
 
   if (getMaxRowIndex()==0)
     return 0;
@@ -826,98 +1115,64 @@ SteeredParameterTable::setNewParamValuesInLib()
   Q3PtrListIterator<Parameter> mParamIterator( mParamList );
   mParamIterator.toFirst();
 
-  int *lHandles = kNULL;
-  char  **lVals = kNULL;
-  int lIndex=0;
-
-  try
+  while ( (lParamPtr = mParamIterator.current()) != 0)
   {
-
-    // count up parameters that have new values
-    while ( (lParamPtr = mParamIterator.current()) != 0)
+    // SMR XXX - note empty string will not be counted as new value - isEmpty is true for empty string
+    // this means never possible to set string parameter to empty string - may need revisit
+    if (lParamPtr->isSteerable())
     {
-      if (lParamPtr->isSteerable())
+      QString lNewVal = text(lParamPtr->getRowIndex(), kNEWVALUE_COLUMN);
+      if (!lNewVal.isEmpty())
       {
-	// SMR XXX - note empty string will not be counted as new value - isEmpty is true for empty string
-	// this means never possible to set string parameter to empty string - may need revisit
-	if (!(text(lParamPtr->getRowIndex(), kNEWVALUE_COLUMN).isEmpty()))
+	aBuilder->addParamValue(lParamPtr->getId(), lParamPtr->getLabel(),
+				lNewVal);
 	lCount++;
       }
-      ++mParamIterator;
     }
+    ++mParamIterator;
+  }
 
+  REG_DBGMSG1("addNewParamValues, lCount = ", lCount);
+  return lCount;
 
-    if (lCount >0)
-    {
-      // populate arrays for ReG library call Set_param_values
-      lHandles = new int [lCount];
-      lVals = new char *[lCount];
-
-      int lLength=0;
-      mParamIterator.toFirst();
-      while ( (lParamPtr = mParamIterator.current()) != 0)
-      {
-	if (lParamPtr->isSteerable() &&
-	    !(this->text(lParamPtr->getRowIndex(), kNEWVALUE_COLUMN).isEmpty()))
-	{
-	  lHandles[lIndex] = lParamPtr->getId();
-	  lLength = this->text(lParamPtr->getRowIndex(), kNEWVALUE_COLUMN).length();
-	  lVals[lIndex] = new char[lLength + 1];
-
-	  sprintf(lVals[lIndex], "%s",
-		  this->text(lParamPtr->getRowIndex(), kNEWVALUE_COLUMN).latin1());
-
-	  lIndex++;
-	}
-
-	++mParamIterator;
-      }
-
-      int lReGStatus = REG_FAILURE;
-
-      mMutexPtr->lock();
-      // set the values in the steering library
-      lReGStatus = Set_param_values(getSimHandle(), //ReG library
-				    lIndex,
-				    lHandles,
-				    lVals);
-      mMutexPtr->unlock();
-
-      if (lReGStatus != REG_SUCCESS)
-      {
-	THROWEXCEPTION("Set_param_values");
-      }
-
-      // clear the cells in the table
-      clearNewValues();
-
-      // clean up
-      delete [] lHandles;
-      for(int i=0; i<lIndex; i++){
-	delete [] lVals[i];
-      }
-      delete [] lVals;
-
-    } // if lCount>0
+} // ::addNewParamValues()
 
-  } //try
+//----------------------------------------------------------------------
+int
+SteeredParameterTable::addPresetValues(const ParameterPreset &aPreset,
+				       SteeringCommandBuilder *aBuilder,
+				       QStringList &aRejected)
+{
+  int lCount = 0;
 
-  catch (SteererException StEx)
+  for (int i=0; i<aPreset.count(); i++)
   {
-    // clean up
-    delete [] lHandles;
-    for(int i=0; i<lIndex; i++){
-      delete [] lVals[i];
-    }
-    delete [] lVals;
+    const QString &lLabel = aPreset[i].first;
+    const QString &lValue = aPreset[i].second;
+    // Only this table's own parameters - a monitored parameter may
+    // have the same label
+    Parameter *lParamPtr = mParamByLabel.value(lLabel);
 
-    throw StEx;
+    if (!lParamPtr || !lParamPtr->isSteerable())
+    {
+      aRejected.append(lLabel + " is not steerable");
+    }
+    else if (lValue.isEmpty() || !lParamPtr->isValidValue(lValue))
+    {
+      aRejected.append(lValue + " is not a valid value of " + lLabel +
+		       " (range " + lParamPtr->getMinString() + " to " +
+		       lParamPtr->getMaxString() + ")");
+    }
+    else
+    {
+      aBuilder->addParamValue(lParamPtr->getId(), lLabel, lValue);
+      lCount++;
+    }
   }
 
-  REG_DBGMSG1("setNewParamValues, lCount = ", lCount);
-  return lIndex;
+  return lCount;
 
-} // ::setNewParamValuesInLib()
+} // ::addPresetValues()
 
 //--------------------------------------------------------------------
 void SteeredParameterTable::emitValuesSlot()
@@ -927,30 +1182,20 @@ void SteeredParameterTable::emitValuesSlot()
   // the new value cells in the table will be cleared as part of this
   // ready for user to enter the next values
 
-  int lReGStatus = REG_FAILURE;
+  SteeringCommandBuilder *lBuilder = commandBuilder();
+
   try
   {
-
-    // set the values in the library
-    if (setNewParamValuesInLib() > 0)
+    lBuilder->reset();
+    if (addNewParamValues(lBuilder) > 0)
     {
-
-      mMutexPtr->lock();
-      // call ReG library function to "emit" values to steered application
-      lReGStatus = Emit_control(getSimHandle(),		//ReG library
-				0,
-				NULL,
-				NULL);
-      mMutexPtr->unlock();
-
-      if (lReGStatus != REG_SUCCESS)
-	THROWEXCEPTION("Emit_contol");
+      lBuilder->send();
+      clearNewValues();
 
       // note: steerer has no control over when the application will actually read these new values
       // thus there will be an indeterminate delay between emitting the values and the steerer gui
       // showing that value as the parameters current value
       // logging of what has been emitted would be very useful for the user here. SMR XXX
-
     }
 
   } //try
@@ -987,7 +1232,7 @@ SteeredParameterTable::clearNewValues()
   while ( (lParamPtr = mParamIterator.current()) != 0)
   {
     int lRowIndex = lParamPtr->getRowIndex();
-    item(lRowIndex, kNEWVALUE_COLUMN)->setText(QString::null);
+    setText(lRowIndex, kNEWVALUE_COLUMN, QString::null);
     updateCell(lRowIndex, kNEWVALUE_COLUMN);
     ++mParamIterator;
   }
@@ -1022,7 +1267,7 @@ SteeredParameterTable::clearAndDisableForDetach(const bool aUnRegister)
       setCurrentCell(0, kNAME_COLUMN);
 
     // clear new value cells
-    item(lRowIndex, kNEWVALUE_COLUMN)->setText(QString::null);
+    setText(lRowIndex, kNEWVALUE_COLUMN, QString::null);
     updateCell(lRowIndex, kNEWVALUE_COLUMN);
     ++mParamIterator;
   }
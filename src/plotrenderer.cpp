@@ -0,0 +1,304 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file plotrenderer.cpp
+    @brief Implementation of the PlotRenderer class - off-screen drawing
+    of history plots */
+
+#include <qfontmetrics.h>
+#include <qimage.h>
+#include <qpainter.h>
+#include <qpen.h>
+#include <QPolygon>
+#include <QSvgGenerator>
+
+#include "buildconfig.h"
+#include "plotrenderer.h"
+
+PlotSnapshot::PlotSnapshot()
+  : mShowSymbols(true), mShowLines(true), mShowDensity(false)
+{
+}
+
+//---------------------------------------------------------------------------
+bool renderPlotExportJob(const PlotExportJob &aJob)
+{
+  return PlotRenderer::renderToFile(aJob.mSnapshot, aJob.mFileName,
+				    aJob.mSize);
+}
+
+//---------------------------------------------------------------------------
+bool PlotRenderer::renderToFile(const PlotSnapshot &aSnapshot,
+				const QString &aFileName, const QSize &aSize)
+{
+  QPainter lPainter;
+
+  if(aFileName.endsWith(".svg", Qt::CaseInsensitive)){
+    QSvgGenerator lGenerator;
+    lGenerator.setFileName(aFileName);
+    lGenerator.setSize(aSize);
+    if(!lPainter.begin(&lGenerator)){
+      return false;
+    }
+    render(aSnapshot, &lPainter, QRect(QPoint(0, 0), aSize));
+    return lPainter.end();
+  }
+
+  QImage lImage(aSize, QImage::Format_ARGB32_Premultiplied);
+  lImage.fill(QColor(Qt::white).rgb());
+  if(!lPainter.begin(&lImage)){
+    return false;
+  }
+  lPainter.setRenderHint(QPainter::Antialiasing);
+  render(aSnapshot, &lPainter, lImage.rect());
+  lPainter.end();
+
+  return lImage.save(aFileName);
+}
+
+//---------------------------------------------------------------------------
+void PlotRenderer::render(const PlotSnapshot &aSnapshot, QPainter *aPainter,
+			  const QRect &aRect)
+{
+  int i, lPos, lNumPoints, lSymbolSize;
+  QFontMetrics lMetrics = aPainter->fontMetrics();
+  int lLineHeight = lMetrics.height();
+  int lLeft, lRight, lTop, lBottom;
+
+  QwtValueList lXTicks = aSnapshot.mXDiv.ticks(QwtScaleDiv::MajorTick);
+  QwtValueList lYTicks = aSnapshot.mYDiv.ticks(QwtScaleDiv::MajorTick);
+
+  // Work out how much room the tick labels, title and legend need
+  lLeft = 0;
+  for(i = 0; i < lYTicks.count(); i++){
+    lPos = lMetrics.width(QString::number(lYTicks[i], 'g', 6));
+    if(lPos > lLeft) lLeft = lPos;
+  }
+  lLeft += lLineHeight;
+
+  lRight = 0;
+  if(aSnapshot.mShowDensity){
+    lRight = 2*lLineHeight + lMetrics.width("0.000000");
+  }
+  else{
+    for(i = 0; i < aSnapshot.mCurves.count(); i++){
+      lPos = lMetrics.width(aSnapshot.mCurves[i].mLabel);
+      if(lPos > lRight) lRight = lPos;
+    }
+    lRight += 3*lLineHeight;
+  }
+
+  lTop = 2*lLineHeight;
+  lBottom = 3*lLineHeight;
+
+  QRect lCanvas(aRect.left() + lLeft, aRect.top() + lTop,
+		aRect.width() - lLeft - lRight,
+		aRect.height() - lTop - lBottom);
+  if(lCanvas.width() < 1 || lCanvas.height() < 1){
+    return;
+  }
+
+  QwtScaleMap lXMap = aSnapshot.mXMap;
+  QwtScaleMap lYMap = aSnapshot.mYMap;
+  lXMap.setPaintInterval(lCanvas.left(), lCanvas.right());
+  lYMap.setPaintInterval(lCanvas.bottom(), lCanvas.top());
+
+  aPainter->save();
+
+  // Title
+  aPainter->setPen(Qt::black);
+  aPainter->drawText(QRect(aRect.left(), aRect.top(), aRect.width(), lTop),
+		     Qt::AlignCenter, aSnapshot.mTitle);
+
+  // Canvas
+  aPainter->fillRect(lCanvas, Qt::darkGray);
+  aPainter->setClipRect(lCanvas);
+  if(aSnapshot.mShowDensity){
+    drawDensity(aPainter, aSnapshot, lXMap, lYMap, lCanvas);
+  }
+  else{
+    // Size symbols on the same basis as HistorySubPlot::doPlot
+    lSymbolSize = 0;
+    if(aSnapshot.mShowSymbols){
+      lNumPoints = 0;
+      for(i = 0; i < aSnapshot.mCurves.count(); i++){
+	lPos = aSnapshot.mCurves[i].mLiveX.size() +
+	  aSnapshot.mCurves[i].mHistX.size();
+	if(lPos > lNumPoints) lNumPoints = lPos;
+      }
+      lSymbolSize = (int)((float)lCanvas.width()/(float)((lNumPoints + 1)*3));
+      if(lSymbolSize > 0 && lSymbolSize < 3) lSymbolSize = 3;
+      if(lSymbolSize > 15) lSymbolSize = 15;
+    }
+
+    for(i = 0; i < aSnapshot.mCurves.count(); i++){
+      const PlotSnapshot::Curve &lCurve = aSnapshot.mCurves[i];
+      aPainter->setPen(QPen(lCurve.mColour));
+      aPainter->setBrush(lCurve.mColour);
+      drawCurve(aPainter, lXMap, lYMap, lCurve.mHistX, lCurve.mHistY,
+		lSymbolSize, aSnapshot.mShowLines);
+      drawCurve(aPainter, lXMap, lYMap, lCurve.mLiveX, lCurve.mLiveY,
+		lSymbolSize, aSnapshot.mShowLines);
+    }
+  }
+  aPainter->setClipping(false);
+
+  // Axes
+  aPainter->setPen(Qt::black);
+  aPainter->setBrush(Qt::NoBrush);
+  aPainter->drawRect(lCanvas);
+  for(i = 0; i < lXTicks.count(); i++){
+    lPos = lXMap.transform(lXTicks[i]);
+    if(lPos < lCanvas.left() || lPos > lCanvas.right()) continue;
+    aPainter->drawLine(lPos, lCanvas.bottom(), lPos, lCanvas.bottom() + 4);
+    aPainter->drawText(QRect(lPos - 100, lCanvas.bottom() + 4, 200, lLineHeight),
+		       Qt::AlignHCenter | Qt::AlignTop,
+		       QString::number(lXTicks[i], 'g', 6));
+  }
+  for(i = 0; i < lYTicks.count(); i++){
+    lPos = lYMap.transform(lYTicks[i]);
+    if(lPos < lCanvas.top() || lPos > lCanvas.bottom()) continue;
+    aPainter->drawLine(lCanvas.left() - 4, lPos, lCanvas.left(), lPos);
+    aPainter->drawText(QRect(aRect.left(), lPos - lLineHeight/2,
+			     lLeft - 6, lLineHeight),
+		       Qt::AlignRight | Qt::AlignVCenter,
+		       QString::number(lYTicks[i], 'g', 6));
+  }
+  aPainter->drawText(QRect(lCanvas.left(), lCanvas.bottom() + 4 + lLineHeight,
+			   lCanvas.width(), 2*lLineHeight),
+		     Qt::AlignCenter, aSnapshot.mXLabel);
+
+  // Legend or colour bar
+  lPos = lCanvas.top();
+  if(aSnapshot.mShowDensity){
+    QwtDoubleInterval lRange = aSnapshot.mDensity.range();
+    QwtLinearColorMap lColourMap = DensityGrid::colourMap();
+    QRect lBar(lCanvas.right() + lLineHeight, lCanvas.top(),
+	       lLineHeight, lCanvas.height());
+    for(i = 0; i < lBar.height(); i++){
+      double lVal = lRange.maxValue() -
+	(lRange.maxValue() - lRange.minValue())*i/(double)lBar.height();
+      aPainter->setPen(QColor(lColourMap.rgb(lRange, lVal)));
+      aPainter->drawLine(lBar.left(), lBar.top() + i, lBar.right(), lBar.top() + i);
+    }
+    aPainter->setPen(Qt::black);
+    aPainter->drawText(lBar.right() + 4, lBar.top() + lMetrics.ascent(),
+		       QString::number(lRange.maxValue(), 'g', 4));
+    aPainter->drawText(lBar.right() + 4, lBar.bottom(),
+		       QString::number(lRange.minValue(), 'g', 4));
+  }
+  else{
+    for(i = 0; i < aSnapshot.mCurves.count(); i++){
+      const PlotSnapshot::Curve &lCurve = aSnapshot.mCurves[i];
+      lPos += lLineHeight;
+      aPainter->setPen(QPen(lCurve.mColour, 2));
+      aPainter->drawLine(lCanvas.right() + lLineHeight/2, lPos - lLineHeight/3,
+			 lCanvas.right() + 2*lLineHeight, lPos - lLineHeight/3);
+      aPainter->setPen(Qt::black);
+      aPainter->drawText(lCanvas.right() + 5*lLineHeight/2, lPos, lCurve.mLabel);
+    }
+  }
+
+  aPainter->restore();
+}
+
+//---------------------------------------------------------------------------
+void PlotRenderer::drawCurve(QPainter *aPainter, const QwtScaleMap &aXMap,
+			     const QwtScaleMap &aYMap,
+			     const QVector<double> &aX,
+			     const QVector<double> &aY,
+			     int aSymbolSize, bool aShowLines)
+{
+  int i, lX, lY;
+  int lNum = aX.size() < aY.size() ? aX.size() : aY.size();
+  int lHalf = aSymbolSize/2;
+  QPolygon lPoints(lNum);
+  QPolygon lDiamond(4);
+
+  for(i = 0; i < lNum; i++){
+    lPoints.setPoint(i, aXMap.transform(aX[i]), aYMap.transform(aY[i]));
+  }
+
+  if(aShowLines && lNum > 1){
+    aPainter->drawPolyline(lPoints);
+  }
+
+  if(aSymbolSize > 0){
+    for(i = 0; i < lNum; i++){
+      lX = lPoints[i].x();
+      lY = lPoints[i].y();
+      lDiamond.setPoints(4, lX, lY - lHalf, lX + lHalf, lY,
+			 lX, lY + lHalf, lX - lHalf, lY);
+      aPainter->drawPolygon(lDiamond);
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void PlotRenderer::drawDensity(QPainter *aPainter,
+			       const PlotSnapshot &aSnapshot,
+			       const QwtScaleMap &aXMap,
+			       const QwtScaleMap &aYMap,
+			       const QRect &aCanvas)
+{
+  int i, j;
+  double lX, lY, lVal;
+  QwtDoubleInterval lRange = aSnapshot.mDensity.range();
+  QwtLinearColorMap lColourMap = DensityGrid::colourMap();
+  QImage lImage(aCanvas.size(), QImage::Format_RGB32);
+
+  // One lookup per output pixel, however many samples were binned
+  for(j = 0; j < aCanvas.height(); j++){
+    QRgb *lLine = (QRgb *)lImage.scanLine(j);
+    lY = aYMap.invTransform(aCanvas.top() + j);
+    for(i = 0; i < aCanvas.width(); i++){
+      lX = aXMap.invTransform(aCanvas.left() + i);
+      lVal = aSnapshot.mDensity.value(lX, lY);
+      lLine[i] = lColourMap.rgb(lRange, lVal);
+    }
+  }
+
+  aPainter->drawImage(aCanvas.topLeft(), lImage);
+}
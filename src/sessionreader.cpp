@@ -0,0 +1,300 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sessionreader.cpp
+    @brief Implementation of the SessionReader class - reads back the
+    logs written by SessionRecorder */
+
+#include <QtEndian>
+
+#include "buildconfig.h"
+#include "sessionreader.h"
+#include "debug.h"
+
+//---------------------------------------------------------------------------
+static qint32 int32At(const QByteArray &aBuf, int aPos)
+{
+  return qFromLittleEndian<qint32>((const uchar *)aBuf.constData() + aPos);
+}
+
+//---------------------------------------------------------------------------
+/// Copy aNum little-endian doubles from aBuf into aVals
+static void doublesAt(const QByteArray &aBuf, int aPos, double *aVals,
+		      int aNum)
+{
+  const char *lSrc = aBuf.constData() + aPos;
+
+  if(QSysInfo::ByteOrder == QSysInfo::LittleEndian){
+    memcpy(aVals, lSrc, aNum*sizeof(double));
+    return;
+  }
+  for(int i = 0; i < aNum; i++){
+    quint64 lBits = qFromLittleEndian<quint64>((const uchar *)lSrc + 8*i);
+    memcpy(&aVals[i], &lBits, sizeof(double));
+  }
+}
+
+//---------------------------------------------------------------------------
+SessionReader::SessionReader(const QString &aFileName)
+  : mFile(aFileName), mDataStart(0)
+{
+  REG_DBGCON("SessionReader");
+}
+
+//---------------------------------------------------------------------------
+SessionReader::~SessionReader()
+{
+  REG_DBGDST("SessionReader");
+}
+
+//---------------------------------------------------------------------------
+bool SessionReader::open()
+{
+  if(!mFile.open(QIODevice::ReadOnly)){
+    return false;
+  }
+
+  QString lLine = QString(mFile.readLine(256)).stripWhiteSpace();
+  if(lLine != "RGSTEER-SESSION 1"){
+    mFile.close();
+    return false;
+  }
+
+  while(!mFile.atEnd()){
+    lLine = QString(mFile.readLine(1024)).stripWhiteSpace();
+    if(lLine == "end"){
+      mDataStart = mFile.pos();
+      return true;
+    }
+    if(lLine.startsWith("application ")){
+      mAppName = lLine.mid(12);
+    }
+    else if(lLine.startsWith("endian ") && lLine != "endian little"){
+      break;
+    }
+  }
+  mFile.close();
+  return false;
+}
+
+//---------------------------------------------------------------------------
+QString SessionReader::fileName() const
+{
+  return mFile.fileName();
+}
+
+//---------------------------------------------------------------------------
+QString SessionReader::applicationName() const
+{
+  return mAppName;
+}
+
+//---------------------------------------------------------------------------
+const QHash<int, SessionReader::Param> &SessionReader::parameters() const
+{
+  return mParams;
+}
+
+//---------------------------------------------------------------------------
+const QList<SessionReader::Command> &SessionReader::commands() const
+{
+  return mCommands;
+}
+
+//---------------------------------------------------------------------------
+void SessionReader::rewind()
+{
+  mCommands.clear();
+  mFile.seek(mDataStart);
+}
+
+//---------------------------------------------------------------------------
+bool SessionReader::readRecord(QByteArray &aTag, QByteArray &aPayload)
+{
+  QByteArray lHead = mFile.read(8);
+  if(lHead.size() != 8){
+    return false;
+  }
+  aTag = lHead.left(4);
+  qint32 lLen = int32At(lHead, 4);
+  if(lLen < 0 || (lLen % 8)){
+    return false;
+  }
+  aPayload = mFile.read(lLen);
+
+  // A record cut short means the recording was still being written
+  // (or the steerer died) - treat it as the end
+  return (aPayload.size() == lLen);
+}
+
+//---------------------------------------------------------------------------
+bool SessionReader::nextChunk(Chunk &aChunk)
+{
+  QByteArray lTag;
+  QByteArray lPayload;
+
+  if(!mFile.isOpen()){
+    return false;
+  }
+
+  while(readRecord(lTag, lPayload)){
+
+    if(lTag == "ROWS"){
+      return parseChunk(lPayload, aChunk);
+    }
+    else if(lTag == "ZROW"){
+      return parseCompressedChunk(lPayload, aChunk);
+    }
+    else if(lTag == "PARM" && lPayload.size() >= 12){
+      Param lParam;
+      lParam.mHandle = int32At(lPayload, 0);
+      lParam.mType = int32At(lPayload, 4);
+      lParam.mSteerable = (int32At(lPayload, 8) != 0);
+      // Label is NUL-padded
+      lParam.mLabel = QString(lPayload.mid(12).constData());
+      mParams.insert(lParam.mHandle, lParam);
+    }
+    else if(lTag == "CMND" && lPayload.size() >= 16){
+      double lSeqTime[2];
+      doublesAt(lPayload, 0, lSeqTime, 2);
+      Command lCmd;
+      lCmd.mSeqNum = lSeqTime[0];
+      lCmd.mTime = lSeqTime[1];
+      lCmd.mText = QString::fromUtf8(lPayload.mid(16).constData());
+      mCommands.append(lCmd);
+    }
+    // Anything else is from a later version - skip it
+  }
+  return false;
+}
+
+//---------------------------------------------------------------------------
+bool SessionReader::parseChunk(const QByteArray &aPayload, Chunk &aChunk)
+{
+  if(aPayload.size() < 8){
+    return false;
+  }
+  int lNumRows = int32At(aPayload, 0);
+  int lNumCols = int32At(aPayload, 4);
+  if(lNumRows < 0 || lNumCols < 0){
+    return false;
+  }
+  // In 64 bits so that a damaged record can't overflow its way past
+  // the check
+  qint64 lHeader = 8 + 4*(qint64)lNumCols;
+  lHeader += (8 - lHeader % 8) % 8;
+  if(aPayload.size() < lHeader + 8*(qint64)lNumRows*(2 + lNumCols)){
+    return false;
+  }
+  int lPos = (int)lHeader;
+
+  aChunk.mNumRows = lNumRows;
+  aChunk.mHandles.resize(lNumCols);
+  for(int j = 0; j < lNumCols; j++){
+    aChunk.mHandles[j] = int32At(aPayload, 8 + 4*j);
+  }
+  aChunk.mSeqNums.resize(lNumRows);
+  doublesAt(aPayload, lPos, aChunk.mSeqNums.data(), lNumRows);
+  lPos += 8*lNumRows;
+  aChunk.mTimes.resize(lNumRows);
+  doublesAt(aPayload, lPos, aChunk.mTimes.data(), lNumRows);
+  lPos += 8*lNumRows;
+
+  aChunk.mColumns.resize(lNumCols);
+  for(int j = 0; j < lNumCols; j++){
+    aChunk.mColumns[j].resize(lNumRows);
+    doublesAt(aPayload, lPos, aChunk.mColumns[j].data(), lNumRows);
+    lPos += 8*lNumRows;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool SessionReader::parseCompressedChunk(const QByteArray &aPayload,
+					 Chunk &aChunk)
+{
+  int j;
+
+  if(aPayload.size() < 8){
+    return false;
+  }
+  int lNumRows = int32At(aPayload, 0);
+  int lNumCols = int32At(aPayload, 4);
+  if(lNumRows < 0 || lNumCols < 0){
+    return false;
+  }
+  // Handles, then the sizes of the sequence numbers, times and columns
+  qint64 lHeader = 8 + 4*(qint64)lNumCols + 4*(2 + (qint64)lNumCols);
+  lHeader += (8 - lHeader % 8) % 8;
+  if(aPayload.size() < lHeader){
+    return false;
+  }
+  qint64 lPos = lHeader;
+
+  aChunk.mNumRows = lNumRows;
+  aChunk.mHandles.resize(lNumCols);
+  for(j = 0; j < lNumCols; j++){
+    aChunk.mHandles[j] = int32At(aPayload, 8 + 4*j);
+  }
+  aChunk.mColumns.resize(lNumCols);
+
+  for(j = -2; j < lNumCols; j++){
+    int lSize = int32At(aPayload, 8 + 4*lNumCols + 4*(j + 2));
+    if(lSize < 0 || aPayload.size() < lPos + lSize){
+      return false;
+    }
+    QByteArray lRaw = qUncompress((const uchar *)aPayload.constData() + lPos,
+				  lSize);
+    if(lRaw.size() != 8*(qint64)lNumRows){
+      return false;
+    }
+    QVector<double> &lVals = (j == -2) ? aChunk.mSeqNums :
+      (j == -1) ? aChunk.mTimes : aChunk.mColumns[j];
+    lVals.resize(lNumRows);
+    doublesAt(lRaw, 0, lVals.data(), lNumRows);
+    lPos += lSize + (8 - lSize % 8) % 8;
+  }
+  return true;
+}
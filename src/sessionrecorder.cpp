@@ -0,0 +1,437 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sessionrecorder.cpp
+    @brief Implementation of the SessionRecorder class - continuous
+    recording of status data and steering commands */
+
+#include <qdatetime.h>
+#include <qtimer.h>
+#include <QtEndian>
+#include <QtConcurrentRun>
+#include <limits>
+#ifdef _MSC_VER
+#include <io.h>
+#endif
+
+#include "buildconfig.h"
+#include "sessionrecorder.h"
+#include "debug.h"
+
+#include "ReG_Steer_Steerside.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+static void appendInt32(QByteArray &aBuf, qint32 aVal)
+{
+  uchar lBytes[4];
+  qToLittleEndian<qint32>(aVal, lBytes);
+  aBuf.append((const char *)lBytes, 4);
+}
+
+//---------------------------------------------------------------------------
+static void appendInt64(QByteArray &aBuf, qint64 aVal)
+{
+  uchar lBytes[8];
+  qToLittleEndian<qint64>(aVal, lBytes);
+  aBuf.append((const char *)lBytes, 8);
+}
+
+//---------------------------------------------------------------------------
+static void appendDoubles(QByteArray &aBuf, const double *aVals, int aNum)
+{
+  if(QSysInfo::ByteOrder == QSysInfo::LittleEndian){
+    aBuf.append((const char *)aVals, aNum*sizeof(double));
+    return;
+  }
+  for(int i = 0; i < aNum; i++){
+    quint64 lBits;
+    memcpy(&lBits, &aVals[i], sizeof(double));
+    appendInt64(aBuf, (qint64)lBits);
+  }
+}
+
+//---------------------------------------------------------------------------
+static void padTo8(QByteArray &aBuf)
+{
+  while(aBuf.size() % 8){
+    aBuf.append('\0');
+  }
+}
+
+//---------------------------------------------------------------------------
+/// Build the payload of a ZROW record - runs on a worker thread
+/// @param aHead N, M and the M handles
+/// @param aColumns Sequence numbers, times and values (little-endian)
+static QByteArray compressChunk(QByteArray aHead, QList<QByteArray> aColumns,
+				int aLevel)
+{
+  int i;
+  QList<QByteArray> lBlobs;
+
+  for(i = 0; i < aColumns.count(); i++){
+    lBlobs.append(qCompress(aColumns[i], aLevel));
+  }
+
+  QByteArray lPayload = aHead;
+  for(i = 0; i < lBlobs.count(); i++){
+    appendInt32(lPayload, lBlobs[i].size());
+  }
+  padTo8(lPayload);
+  for(i = 0; i < lBlobs.count(); i++){
+    lPayload.append(lBlobs[i]);
+    padTo8(lPayload);
+  }
+  return lPayload;
+}
+
+//---------------------------------------------------------------------------
+static double timeNow()
+{
+  QDateTime lNow = QDateTime::currentDateTime();
+  return (double)lNow.toTime_t() + 0.001*lNow.time().msec();
+}
+
+//---------------------------------------------------------------------------
+static void syncToDisk(QFile &aFile)
+{
+  aFile.flush();
+#ifndef _MSC_VER
+  fsync(aFile.handle());
+#else
+  _commit(aFile.handle());
+#endif
+}
+
+//---------------------------------------------------------------------------
+SessionRecorder::SessionRecorder(const QString &aFileName,
+				 const QString &aAppName,
+				 int aSyncSecs, int aCompression,
+				 QObject *aParent)
+  : QObject(aParent), mFile(aFileName), mIndexFile(aFileName + ".idx"),
+    mSyncTimer(NULL), mDirty(false), mCompression(aCompression),
+    mNumRows(0), mRowOpen(false), mLastSeqNum(-1)
+{
+  REG_DBGCON("SessionRecorder");
+
+  if(!mFile.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+    cout << "SessionRecorder: failed to open " << aFileName.ascii() << endl;
+    return;
+  }
+  if(!mIndexFile.open(QIODevice::WriteOnly | QIODevice::Truncate)){
+    cout << "SessionRecorder: failed to open index for " <<
+      aFileName.ascii() << endl;
+    mFile.close();
+    return;
+  }
+
+  QString lName = aAppName;
+  lName.replace('\n', ' ');
+  QByteArray lHeader = QString("RGSTEER-SESSION 1\nendian little\n"
+			       "application " + lName +
+			       "\nend\n").toLatin1();
+  while(lHeader.size() % 8){
+    lHeader.insert(lHeader.size() - 1, ' ');
+  }
+  mFile.write(lHeader);
+  mDirty = true;
+
+  mSeqNums.reserve(kSESSION_CHUNK_ROWS);
+  mTimes.reserve(kSESSION_CHUNK_ROWS);
+
+  mSyncTimer = new QTimer(this);
+  connect(mSyncTimer, SIGNAL(timeout()), this, SLOT(syncSlot()));
+  mSyncTimer->start(1000*(aSyncSecs > 0 ? aSyncSecs : 1));
+}
+
+//---------------------------------------------------------------------------
+SessionRecorder::~SessionRecorder()
+{
+  REG_DBGDST("SessionRecorder");
+  if(isOpen()){
+    // Nothing may be left behind on the worker threads
+    writeChunk();
+    writePending(true);
+    flush();
+    mFile.close();
+    mIndexFile.close();
+  }
+}
+
+//---------------------------------------------------------------------------
+bool SessionRecorder::isOpen() const
+{
+  return mFile.isOpen();
+}
+
+//---------------------------------------------------------------------------
+QString SessionRecorder::fileName() const
+{
+  return mFile.fileName();
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::beginRow(int aSeqNum)
+{
+  if(!isOpen()){
+    return;
+  }
+  if(mRowOpen){
+    endRow();
+  }
+
+  // Every column gets a value for this row - missing until we're
+  // told otherwise
+  const double lMissing = std::numeric_limits<double>::quiet_NaN();
+  for(int i = 0; i < mColumns.count(); i++){
+    mColumns[i].append(lMissing);
+  }
+  mSeqNums.append((double)aSeqNum);
+  mTimes.append(timeNow());
+  mLastSeqNum = aSeqNum;
+  mRowOpen = true;
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::addValue(int aHandle, int aType, bool aSteerable,
+			       const char *aLabel, const char *aValue)
+{
+  double lVal;
+
+  if(!mRowOpen || aType == REG_CHAR){
+    return;
+  }
+  if(sscanf(aValue, "%lf", &lVal) != 1){
+    return;
+  }
+
+  QHash<int, int>::const_iterator lIt = mColumnOfHandle.find(aHandle);
+  if(lIt != mColumnOfHandle.end()){
+    mColumns[lIt.value()][mNumRows] = lVal;
+    return;
+  }
+
+  // First time we've seen this parameter - describe it in the log
+  // and give it a column, missing for any earlier rows in the chunk
+  QByteArray lPayload;
+  appendInt32(lPayload, aHandle);
+  appendInt32(lPayload, aType);
+  appendInt32(lPayload, aSteerable ? 1 : 0);
+  lPayload.append(aLabel);
+  padTo8(lPayload);
+  writeRecord("PARM", lPayload);
+
+  mColumnOfHandle.insert(aHandle, mColumns.count());
+  mHandles.append(aHandle);
+  QVector<double> lColumn(mNumRows + 1,
+			  std::numeric_limits<double>::quiet_NaN());
+  lColumn.reserve(kSESSION_CHUNK_ROWS);
+  lColumn[mNumRows] = lVal;
+  mColumns.append(lColumn);
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::endRow()
+{
+  if(!mRowOpen){
+    return;
+  }
+  mRowOpen = false;
+  if(++mNumRows >= kSESSION_CHUNK_ROWS){
+    writeChunk();
+  }
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::recordCommand(const QString &aCommand)
+{
+  if(!isOpen()){
+    return;
+  }
+
+  double lSeqTime[2];
+  lSeqTime[0] = (double)mLastSeqNum;
+  lSeqTime[1] = timeNow();
+
+  QByteArray lPayload;
+  appendDoubles(lPayload, lSeqTime, 2);
+  lPayload.append(aCommand.toUtf8());
+  padTo8(lPayload);
+  writeRecord("CMND", lPayload);
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::writeRecord(const char *aTag, const QByteArray &aPayload)
+{
+  PendingRecord lRecord;
+  lRecord.mTag = QByteArray(aTag, 4);
+  lRecord.mPayload = aPayload;
+  lRecord.mCompressing = false;
+  lRecord.mIsChunk = false;
+  mPending.append(lRecord);
+
+  writePending(false);
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::writePending(bool aWait)
+{
+  while(!mPending.isEmpty()){
+    PendingRecord &lRecord = mPending.first();
+
+    if(lRecord.mCompressing){
+      if(!aWait && !lRecord.mCompressed.isFinished()){
+	return;
+      }
+      lRecord.mPayload = lRecord.mCompressed.result();
+    }
+
+    // Where the record starts, for the index
+    qint64 lOffset = mFile.pos();
+
+    QByteArray lHead = lRecord.mTag;
+    appendInt32(lHead, lRecord.mPayload.size());
+    mFile.write(lHead);
+    mFile.write(lRecord.mPayload);
+
+    if(lRecord.mIsChunk){
+      QByteArray lEntry;
+      appendInt64(lEntry, lRecord.mFirstSeqNum);
+      appendInt64(lEntry, lRecord.mLastSeqNum);
+      appendInt64(lEntry, lOffset);
+      mIndexFile.write(lEntry);
+    }
+    mDirty = true;
+    mPending.removeFirst();
+  }
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::writeChunk()
+{
+  int i;
+
+  if(mNumRows == 0){
+    return;
+  }
+
+  QByteArray lHead;
+  appendInt32(lHead, mNumRows);
+  appendInt32(lHead, mHandles.count());
+  for(i = 0; i < mHandles.count(); i++){
+    appendInt32(lHead, mHandles[i]);
+  }
+
+  PendingRecord lRecord;
+  lRecord.mIsChunk = true;
+  lRecord.mFirstSeqNum = (qint64)mSeqNums.first();
+  lRecord.mLastSeqNum = (qint64)mSeqNums[mNumRows - 1];
+
+  if(mCompression){
+    // Each column is compressed on its own so that readers can pick
+    // out the ones they want
+    QList<QByteArray> lColumns;
+    for(i = -2; i < mColumns.count(); i++){
+      const double *lVals = (i == -2) ? mSeqNums.constData() :
+	(i == -1) ? mTimes.constData() : mColumns[i].constData();
+      QByteArray lColumn;
+      appendDoubles(lColumn, lVals, mNumRows);
+      lColumns.append(lColumn);
+    }
+    lRecord.mTag = "ZROW";
+    lRecord.mCompressing = true;
+    lRecord.mCompressed = QtConcurrent::run(compressChunk, lHead, lColumns,
+					    mCompression);
+  }
+  else{
+    QByteArray &lPayload = lRecord.mPayload;
+    lPayload = lHead;
+    lPayload.reserve(lHead.size() + 8*mNumRows*(2 + mColumns.count()) + 8);
+    padTo8(lPayload);
+    appendDoubles(lPayload, mSeqNums.constData(), mNumRows);
+    appendDoubles(lPayload, mTimes.constData(), mNumRows);
+    for(i = 0; i < mColumns.count(); i++){
+      appendDoubles(lPayload, mColumns[i].constData(), mNumRows);
+    }
+    lRecord.mTag = "ROWS";
+    lRecord.mCompressing = false;
+  }
+  mPending.append(lRecord);
+  writePending(false);
+
+  // Keep the columns (and their storage) for the next chunk.  A row
+  // may be in progress if we're being flushed by the timer.
+  int lKeep = mRowOpen ? 1 : 0;
+  mSeqNums.remove(0, mNumRows);
+  mTimes.remove(0, mNumRows);
+  for(i = 0; i < mColumns.count(); i++){
+    mColumns[i].remove(0, mNumRows);
+  }
+  mNumRows = 0;
+  Q_ASSERT(mSeqNums.count() == lKeep);
+  Q_UNUSED(lKeep);
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::flush()
+{
+  if(!isOpen()){
+    return;
+  }
+  writeChunk();
+  writePending(false);
+  if(mDirty){
+    syncToDisk(mFile);
+    syncToDisk(mIndexFile);
+    mDirty = false;
+  }
+}
+
+//---------------------------------------------------------------------------
+void SessionRecorder::syncSlot()
+{
+  flush();
+}
@@ -0,0 +1,242 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sessionreplayer.cpp
+    @brief Implementation of the SessionReplayer class - replays a
+    recorded session through the normal GUI */
+
+#include <qtimer.h>
+
+#include "buildconfig.h"
+#include "sessionreplayer.h"
+#include "application.h"
+#include "controlform.h"
+#include "steerermainwindow.h"
+#include "debug.h"
+
+using namespace std;
+
+SessionReplayer::SessionReplayer(SessionReader *aReader, Application *aApp,
+				 SteererMainWindow *aSteerer, double aSpeed)
+  : QObject(aApp), mReader(aReader), mApp(aApp), mSteerer(aSteerer),
+    mSpeed(aSpeed), mRow(0), mNextCommand(0), mMonDetails(NULL),
+    mSteeredDetails(NULL), mDetailsSize(0), mStartTime(0.0),
+    mNumReplayed(0), mLastReport(0)
+{
+  REG_DBGCON("SessionReplayer");
+
+  mChunk.mNumRows = 0;
+
+  mTimer = new QTimer(this);
+  mTimer->setSingleShot(true);
+  connect(mTimer, SIGNAL(timeout()), this, SLOT(nextRowSlot()));
+}
+
+SessionReplayer::~SessionReplayer()
+{
+  REG_DBGDST("SessionReplayer");
+  delete mReader;
+  delete [] mMonDetails;
+  delete [] mSteeredDetails;
+}
+
+//---------------------------------------------------------------------------
+void SessionReplayer::start()
+{
+  mClock.start();
+  mTimer->start(0);
+}
+
+//---------------------------------------------------------------------------
+void SessionReplayer::stop()
+{
+  mTimer->stop();
+}
+
+//---------------------------------------------------------------------------
+int SessionReplayer::numReplayed() const
+{
+  return mNumReplayed;
+}
+
+//---------------------------------------------------------------------------
+double SessionReplayer::rate() const
+{
+  int lMSecs = mClock.elapsed();
+  return (lMSecs > 0) ? (1000.0*mNumReplayed)/lMSecs : 0.0;
+}
+
+//---------------------------------------------------------------------------
+/** Make sure that mRow refers to a row of mChunk, reading the next
+ *  chunk if necessary.
+ *  @returns false once the recording is exhausted */
+bool SessionReplayer::haveRow()
+{
+  while(mRow >= mChunk.mNumRows){
+    if(!mReader->nextChunk(mChunk)){
+      return false;
+    }
+    mRow = 0;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void SessionReplayer::nextRowSlot()
+{
+  if(!haveRow()){
+    reportProgress(true);
+    return;
+  }
+
+  replayRow();
+  mRow++;
+
+  if(mClock.elapsed() - mLastReport >= 1000){
+    reportProgress(false);
+  }
+
+  if(!haveRow()){
+    reportProgress(true);
+    return;
+  }
+
+  // Schedule the next row relative to the start of the replay so
+  // that delays in the GUI don't accumulate
+  int lDelay = 0;
+  if(mSpeed > 0.0){
+    lDelay = (int)(1000.0*(mChunk.mTimes[mRow] - mStartTime)/mSpeed) -
+      mClock.elapsed();
+    if(lDelay < 0) lDelay = 0;
+  }
+  mTimer->start(lDelay);
+}
+
+//---------------------------------------------------------------------------
+void SessionReplayer::replayRow()
+{
+  int lNumCols = mChunk.mHandles.count();
+  int lNumMon = 0;
+  int lNumSteered = 0;
+
+  if(mNumReplayed == 0){
+    mStartTime = mChunk.mTimes[mRow];
+    mClock.restart();
+  }
+  showCommands(mChunk.mTimes[mRow]);
+
+  if(lNumCols > mDetailsSize){
+    delete [] mMonDetails;
+    delete [] mSteeredDetails;
+    mDetailsSize = lNumCols;
+    mMonDetails = new Param_details_struct[mDetailsSize];
+    mSteeredDetails = new Param_details_struct[mDetailsSize];
+    memset(mMonDetails, 0, mDetailsSize*sizeof(Param_details_struct));
+    memset(mSteeredDetails, 0, mDetailsSize*sizeof(Param_details_struct));
+  }
+
+  const QHash<int, SessionReader::Param> &lParams = mReader->parameters();
+
+  for(int j = 0; j < lNumCols; j++){
+    double lVal = mChunk.mColumns[j][mRow];
+    // NaN - parameter wasn't in this status message
+    if(lVal != lVal){
+      continue;
+    }
+    QHash<int, SessionReader::Param>::const_iterator lIt =
+      lParams.find(mChunk.mHandles[j]);
+    if(lIt == lParams.end()){
+      continue;
+    }
+
+    Param_details_struct *lDetails = lIt.value().mSteerable ?
+      &mSteeredDetails[lNumSteered++] : &mMonDetails[lNumMon++];
+
+    lDetails->handle = lIt.value().mHandle;
+    lDetails->type = lIt.value().mType;
+    snprintf(lDetails->label, sizeof(lDetails->label), "%s",
+	     lIt.value().mLabel.latin1());
+    snprintf(lDetails->value, sizeof(lDetails->value), "%.17g", lVal);
+  }
+
+  mApp->getControlForm()->replayParameters(mMonDetails, lNumMon,
+					   mSteeredDetails, lNumSteered);
+  mNumReplayed++;
+}
+
+//---------------------------------------------------------------------------
+/** Show any commands that were sent before the given time */
+void SessionReplayer::showCommands(double aTime)
+{
+  const QList<SessionReader::Command> &lCmds = mReader->commands();
+
+  while(mNextCommand < lCmds.count() &&
+	lCmds[mNextCommand].mTime <= aTime){
+    QString lMsg = "Replaying - command sent: " + lCmds[mNextCommand].mText;
+    mSteerer->statusBarMessageSlot(mApp, lMsg);
+    mNextCommand++;
+    // Don't immediately overwrite it with the progress report
+    mLastReport = mClock.elapsed();
+  }
+}
+
+//---------------------------------------------------------------------------
+void SessionReplayer::reportProgress(bool aFinished)
+{
+  QString lMsg;
+
+  mLastReport = mClock.elapsed();
+  if(aFinished){
+    lMsg = QString("Replay finished - %1 status messages in %2 s "
+		   "(%3 per second)").arg(mNumReplayed).
+      arg(0.001*mLastReport, 0, 'f', 1).arg(rate(), 0, 'f', 1);
+    cout << "SessionReplayer: " << lMsg.ascii() << endl;
+  }
+  else{
+    lMsg = QString("Replaying - %1 status messages (%2 per second)").
+      arg(mNumReplayed).arg(rate(), 0, 'f', 1);
+  }
+  mSteerer->statusBarMessageSlot(mApp, lMsg);
+}
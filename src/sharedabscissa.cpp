@@ -0,0 +1,183 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sharedabscissa.cpp
+    @brief Implementation of the SharedAbscissa class - per pixel-column
+    min/max reduction of history data for plotting */
+
+#include <string.h>
+
+#include "buildconfig.h"
+#include "sharedabscissa.h"
+
+SharedAbscissa::SharedAbscissa()
+  : mX(NULL), mNum(0), mCheckedUpTo(0), mMonotonic(true),
+    mDecimating(false)
+{
+}
+
+SharedAbscissa::~SharedAbscissa()
+{
+}
+
+//---------------------------------------------------------------------------
+void SharedAbscissa::reset()
+{
+  mX = NULL;
+  mNum = 0;
+  mCheckedUpTo = 0;
+  mMonotonic = true;
+  mDecimating = false;
+  mBucketStarts.resize(0);
+}
+
+//---------------------------------------------------------------------------
+void SharedAbscissa::transform(const double *aX, int aNum, int aNumBuckets)
+{
+  int i;
+
+  // Histories only ever grow so, unless we've been handed less data
+  // than last time, only the new points need checking.  The array may
+  // have been realloc'd but its contents are unchanged.
+  if(aNum < mCheckedUpTo){
+    reset();
+  }
+  mX = aX;
+  mNum = aNum;
+
+  if(mMonotonic){
+    for(i = (mCheckedUpTo > 0 ? mCheckedUpTo : 1); i < aNum; i++){
+      if(aX[i] < aX[i-1]){
+	mMonotonic = false;
+	break;
+      }
+    }
+  }
+  mCheckedUpTo = aNum;
+
+  // A handful of points per pixel isn't worth reducing and
+  // bucketing scattered data would join up unrelated points
+  if(aNumBuckets < 1 || !mMonotonic || aNum <= 4*aNumBuckets){
+    mDecimating = false;
+    return;
+  }
+
+  mDecimating = true;
+  mBucketStarts.resize(aNumBuckets + 1);
+  for(i = 0; i <= aNumBuckets; i++){
+    mBucketStarts[i] = (int)(((long long)i * aNum)/aNumBuckets);
+  }
+}
+
+//---------------------------------------------------------------------------
+void SharedAbscissa::reduce(const double *aY, int aNum,
+			    QVector<double> &aOutX,
+			    QVector<double> &aOutY) const
+{
+  int i, k, lStart, lEnd, lMin, lMax;
+  int lIdx[4];
+  int lNumIdx;
+
+  if(aNum > mNum){
+    aNum = mNum;
+  }
+
+  aOutX.resize(0);
+  aOutY.resize(0);
+  if(aNum <= 0 || !mX || !aY){
+    return;
+  }
+
+  if(!mDecimating){
+    aOutX.resize(aNum);
+    aOutY.resize(aNum);
+    memcpy(aOutX.data(), mX, aNum*sizeof(double));
+    memcpy(aOutY.data(), aY, aNum*sizeof(double));
+    return;
+  }
+
+  aOutX.reserve(4*(mBucketStarts.size() - 1));
+  aOutY.reserve(4*(mBucketStarts.size() - 1));
+
+  for(k = 0; k < mBucketStarts.size() - 1; k++){
+    lStart = mBucketStarts[k];
+    lEnd = mBucketStarts[k+1];
+    if(lEnd > aNum){
+      lEnd = aNum;
+    }
+    if(lStart >= lEnd){
+      break;
+    }
+
+    lMin = lMax = lStart;
+    for(i = lStart + 1; i < lEnd; i++){
+      if(aY[i] < aY[lMin]){
+	lMin = i;
+      }
+      else if(aY[i] > aY[lMax]){
+	lMax = i;
+      }
+    }
+
+    // Emit first, extrema and last in the order they occur so the
+    // line drawn through them looks the same as the full data would
+    lNumIdx = 0;
+    lIdx[lNumIdx++] = lStart;
+    if(lMin < lMax){
+      if(lMin != lStart) lIdx[lNumIdx++] = lMin;
+      if(lMax != lStart) lIdx[lNumIdx++] = lMax;
+    }
+    else{
+      if(lMax != lStart) lIdx[lNumIdx++] = lMax;
+      if(lMin != lStart && lMin != lMax) lIdx[lNumIdx++] = lMin;
+    }
+    if(lIdx[lNumIdx-1] != lEnd - 1) lIdx[lNumIdx++] = lEnd - 1;
+
+    for(i = 0; i < lNumIdx; i++){
+      aOutX.append(mX[lIdx[i]]);
+      aOutY.append(aY[lIdx[i]]);
+    }
+  }
+}
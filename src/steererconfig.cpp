@@ -61,6 +61,7 @@
 #include "buildconfig.h"
 #include "debug.h"
 #include "steererconfig.h"
+#include "types.h"
 
 using namespace std;
 
@@ -74,6 +75,12 @@ SteererConfig::SteererConfig(){
   mShowSteerParamTable = true;
   mShowIOTypeTable = true;
   mShowChkTypeTable = true;
+  mShowSparklines = false;
+  mDisplayRefreshRate = 10;
+  mRecordSessions = false;
+  mSessionDirectory = QDir::homeDirPath() + "/.realitygrid/sessions";
+  mSessionSyncSecs = 5;
+  mSessionCompression = 0;
 
   Wipe_security_info(&mRegistrySecurity);
 }
@@ -193,6 +200,57 @@ void SteererConfig::readConfig(QString fileName){
     } else {
       REG_DBGMSG("Display of ChkTypes table is OFF");
     }
+
+    // Sparklines of monitored parameters (optional)
+    flag = getElementAttrValue(nodeList.item(0).toElement(),
+			       "showSparklines");
+    mShowSparklines = (flag.contains("on") == 1);
+
+    // Maximum refreshes per second (optional)
+    flag = getElementAttrValue(nodeList.item(0).toElement(),
+			       "refreshRate");
+    if(!flag.isEmpty()){
+      mDisplayRefreshRate = flag.toInt();
+      if(mDisplayRefreshRate < 0){
+	mDisplayRefreshRate = 0;
+      }
+      else if(mDisplayRefreshRate > kMAX_REFRESH_RATE){
+	mDisplayRefreshRate = kMAX_REFRESH_RATE;
+      }
+    }
+    REG_DBGMSG1("Display refresh rate is ", mDisplayRefreshRate);
+  }
+
+  // Session recording section (optional)
+  nodeList = docElem.elementsByTagName("Recording");
+  if(nodeList.count() == 1){
+    flag = getElementAttrValue(nodeList.item(0).toElement(),
+			       "recordSessions");
+    mRecordSessions = (flag.contains("on") == 1);
+
+    flag = getElementAttrValue(nodeList.item(0).toElement(),
+			       "directory");
+    if(!flag.isEmpty()){
+      mSessionDirectory = flag;
+    }
+
+    flag = getElementAttrValue(nodeList.item(0).toElement(),
+			       "syncInterval");
+    if(flag.toInt() > 0){
+      mSessionSyncSecs = flag.toInt();
+    }
+
+    // "on" for zlib's default level, or a level from 1 to 9
+    flag = getElementAttrValue(nodeList.item(0).toElement(),
+			       "compression");
+    if(flag.contains("on") == 1){
+      mSessionCompression = -1;
+    }
+    else if(flag.toInt() >= 1 && flag.toInt() <= 9){
+      mSessionCompression = flag.toInt();
+    }
+    REG_DBGMSG1("Session recording directory is ",
+		mSessionDirectory.ascii());
   }
 
   return;
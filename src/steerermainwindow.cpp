@@ -57,14 +57,18 @@
 #include <qaction.h>
 #include <qapplication.h>
 #include <qcombobox.h>
+#include <qdatetime.h>
+#include <qfileinfo.h>
 #include <qinputdialog.h>
 #include <q3filedialog.h>
 #include <qlabel.h>
 #include <qlayout.h>
 #include <qlineedit.h>
+#include <qmap.h>
 #include <qmenubar.h>
 #include <qmessagebox.h>
 #include <qpixmap.h>
+#include <qregexp.h>
 #include <q3popupmenu.h>
 #include <qpushbutton.h>
 #include <qstatusbar.h>
@@ -77,6 +81,7 @@
 #include <Q3HBoxLayout>
 #include <QEvent>
 #include <Q3Action>
+#include <QtConcurrentMap>
 
 #include "buildconfig.h"
 #include "types.h"
@@ -88,6 +93,17 @@
 #include "attachform.h"
 #include "attachsockets.h"
 #include "configform.h"
+#include "controlform.h"
+#include "historyfile.h"
+#include "historyplot.h"
+#include "ensembleplot.h"
+#include "broadcastform.h"
+#include "steeringtimeline.h"
+#include "steeringrules.h"
+#include "parameter.h"
+#include "parametertable.h"
+#include "plotrenderer.h"
+#include "sessionreader.h"
 
 #include "ReG_Steer_Steerside.h"
 
@@ -100,8 +116,11 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
     mStackLogoLabel(kNULL), mStackLogoPixMap(kNULL),
     mCommsThread(kNULL),
     mSetCheckIntervalAction(kNULL), mToggleAutoPollAction(kNULL),
-    mAttachAction(kNULL),
-    mQuitAction(kNULL)
+    mToggleRecordAction(kNULL), mReplayAction(kNULL),
+    mOpenHistoryAction(kNULL), mAttachAction(kNULL),
+    mQuitAction(kNULL), mExportPlotsAction(kNULL),
+    mEnsemblePlotAction(kNULL), mExportAppAction(kNULL),
+    mNextReplayHandle(-1000)
 
 {
   REG_DBGCON("SteererMainWindow");
@@ -131,6 +150,31 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
   connect(mToggleAutoPollAction, SIGNAL(activated()), this,
 	  SLOT(toggleAutoPollSlot()));
 
+  mToggleRecordAction = new Q3Action("Start recording sessions",
+				     "Start &recording sessions",
+				     0, this, "togglerecordaction");
+  mToggleRecordAction->setToolTip(QString("Toggle recording of all data "
+					  "from newly-attached applications"));
+  connect(mToggleRecordAction, SIGNAL(activated()), this,
+	  SLOT(toggleRecordSessionsSlot()));
+
+  mReplayAction = new Q3Action("Replay a recorded session",
+			       "Re&play session...", 0, this,
+			       "replayaction");
+  mReplayAction->setToolTip(QString("Replay a recorded session as if it "
+				    "were a running application"));
+  connect(mReplayAction, SIGNAL(activated()), this,
+	  SLOT(replaySessionSlot()));
+
+  mOpenHistoryAction = new Q3Action("Plot an exported or recorded history",
+				    "Open &history file...", 0, this,
+				    "openhistoryaction");
+  mOpenHistoryAction->setToolTip(QString("Plot the data in a binary export "
+					 "or recorded session without "
+					 "attaching"));
+  connect(mOpenHistoryAction, SIGNAL(activated()), this,
+	  SLOT(openHistoryFileSlot()));
+
   mAttachAction = new Q3Action("Attach to an application", "&Attach",
 			       Qt::CTRL+Qt::Key_A, this, "attachaction");
   mAttachAction->setToolTip(QString("Attach to an app"));
@@ -144,6 +188,55 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
   connect( mSetTabTitleAction, SIGNAL(activated()), this,
 	   SLOT(editTabTitleSlot()) );
 
+  mExportPlotsAction = new Q3Action("Export all plots", "E&xport all plots...",
+				    0, this, "exportplotsaction");
+  mExportPlotsAction->setToolTip(QString("Save every graph of every "
+					 "application as an image"));
+  connect( mExportPlotsAction, SIGNAL(activated()), this,
+	   SLOT(exportAllPlotsSlot()) );
+  connect( &mExportWatcher, SIGNAL(finished()), this,
+	   SLOT(exportAllPlotsDoneSlot()) );
+
+  mExportAppAction = new Q3Action("Export all parameters of application",
+				  "Export application &data...", 0, this,
+				  "exportappaction");
+  mExportAppAction->setToolTip(QString("Save every parameter of the current "
+				       "application, a row per sequence "
+				       "number"));
+  connect( mExportAppAction, SIGNAL(activated()), this,
+	   SLOT(exportApplicationSlot()) );
+
+  mEnsemblePlotAction = new Q3Action("Plot a parameter across applications",
+				     "E&nsemble plot...", 0, this,
+				     "ensembleplotaction");
+  mEnsemblePlotAction->setToolTip(QString("Overlay a parameter from every "
+					  "application that has it"));
+  connect( mEnsemblePlotAction, SIGNAL(activated()), this,
+	   SLOT(ensemblePlotSlot()) );
+
+  mTimelineAction = new Q3Action("Steering timeline of application",
+				 "Steering &timeline...", 0, this,
+				 "timelineaction");
+  mTimelineAction->setToolTip(QString("Load a file of steering actions to "
+				      "send at given sequence numbers"));
+  connect( mTimelineAction, SIGNAL(activated()), this,
+	   SLOT(steeringTimelineSlot()) );
+
+  mRulesAction = new Q3Action("Steering rules of application",
+			      "Steering &rules...", 0, this, "rulesaction");
+  mRulesAction->setToolTip(QString("Load rules that steer the application "
+				   "automatically as its status arrives"));
+  connect( mRulesAction, SIGNAL(activated()), this,
+	   SLOT(steeringRulesSlot()) );
+
+  mBroadcastAction = new Q3Action("Steer several applications at once",
+				  "&Broadcast steering...", Qt::CTRL+Qt::Key_B,
+				  this, "broadcastaction");
+  mBroadcastAction->setToolTip(QString("Send the same parameter values to "
+				       "a group of applications"));
+  connect( mBroadcastAction, SIGNAL(activated()), this,
+	   SLOT(broadcastSlot()) );
+
   mQuitAction =  new Q3Action("Quit (& detach)", "&Quit",
 			      Qt::CTRL+Qt::Key_Q, this, "quitaction");
   mQuitAction->setToolTip(QString("Quit (& detach)"));
@@ -155,7 +248,16 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
   mAttachAction->addTo(lConfigMenu);
   mSetCheckIntervalAction->addTo(lConfigMenu);
   mToggleAutoPollAction->addTo(lConfigMenu);
+  mToggleRecordAction->addTo(lConfigMenu);
+  mReplayAction->addTo(lConfigMenu);
+  mOpenHistoryAction->addTo(lConfigMenu);
   mSetTabTitleAction->addTo(lConfigMenu);
+  mExportPlotsAction->addTo(lConfigMenu);
+  mExportAppAction->addTo(lConfigMenu);
+  mEnsemblePlotAction->addTo(lConfigMenu);
+  mTimelineAction->addTo(lConfigMenu);
+  mRulesAction->addTo(lConfigMenu);
+  mBroadcastAction->addTo(lConfigMenu);
   mQuitAction->addTo(lConfigMenu);
 
   mSetCheckIntervalAction->setEnabled(FALSE);
@@ -226,6 +328,27 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
 	  SLOT(hideMonTableSlot()));
   mHideMonTableAction->addTo(lViewMenu);
 
+  mToggleSparklinesAction = new Q3Action("Show trend sparklines",
+					 "Show &trend sparklines", 0, this,
+					 "togglesparklinesaction");
+  mToggleSparklinesAction->setToolTip(QString("Show a small graph of the "
+					      "recent history of each "
+					      "monitored parameter"));
+  connect(mToggleSparklinesAction, SIGNAL(activated()), this,
+	  SLOT(toggleSparklinesSlot()));
+  mToggleSparklinesAction->addTo(lViewMenu);
+
+  mDisplayStatsAction = new Q3Action("Show display statistics",
+				     "Display s&tatistics...", 0, this,
+				     "displaystatsaction");
+  mDisplayStatsAction->setToolTip(QString("Show the time spent redrawing "
+					  "each application and that saved "
+					  "while its tab was hidden"));
+  connect(mDisplayStatsAction, SIGNAL(activated()), this,
+	  SLOT(displayStatisticsSlot()));
+  lViewMenu->insertSeparator();
+  mDisplayStatsAction->addTo(lViewMenu);
+
   // Catch tab changes so we can keep the status bar relevant
   connect(mAppTabs, SIGNAL(currentChanged(int)), this,
 	  SLOT(tabChangedSlot(int)));
@@ -247,6 +370,10 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
 				       "/.realitygrid/security.conf");
   }
 
+  if(mSteererConfig->mRecordSessions){
+    mToggleRecordAction->setMenuText(QString("Stop &recording sessions"));
+  }
+
   // create commsthread so can set checkinterval
   // - thread is started on first attach
   mCommsThread = new CommsThread(this, &mReGMutex,
@@ -272,6 +399,8 @@ SteererMainWindow::SteererMainWindow(bool autoConnect, const char *aSGS)
   mSteerType = new QString(Get_steering_transport_string());
 
   mAppList.setAutoDelete(TRUE);
+  mEnsemblePlotList.setAutoDelete(TRUE);
+  mFilePlotList.setAutoDelete(TRUE);
 }
 
 
@@ -559,9 +688,23 @@ SteererMainWindow::closeApplicationSlot(int aSimHandle)
 
   REG_DBGMSG("closeApplicationSlot: deleting Application...");
 
+  // Nothing more is to be sent to it
+  if(mCommsThread){
+    mCommsThread->setTimeline(aSimHandle, kNULL);
+    mCommsThread->setRules(aSimHandle, kNULL);
+  }
+
   for(i=0; i<mAppList.count(); i++){
     if(aSimHandle == mAppList.at(i)->getHandle()){
 
+      // Ensemble plots hold on to this application's parameter
+      // histories so must let go of them first
+      EnsemblePlot *lEnsemble;
+      for(lEnsemble = mEnsemblePlotList.first(); lEnsemble;
+	  lEnsemble = mEnsemblePlotList.next()){
+	lEnsemble->removeApplication(mAppList.at(i));
+      }
+
       mAppTabs->removePage(mAppList.at(i));
       // Autodelete takes care of deleting this object - we just
       // have to remove it from the list
@@ -599,6 +742,339 @@ SteererMainWindow::editTabTitleSlot()
   }
 }
 
+void
+SteererMainWindow::exportAllPlotsSlot()
+{
+  unsigned int i, j;
+  HistoryPlot *lPlot;
+  QList<PlotExportJob> lJobs;
+
+  if(mExportWatcher.isRunning()){
+    QMessageBox::information(this, "Export all plots",
+			     "The previous export is still in progress.");
+    return;
+  }
+
+  QString lDir = Q3FileDialog::getExistingDirectory(".", this,
+			      "export dir dialog",
+			      "Choose a directory to save the plots in");
+  if(lDir.isNull()){
+    return;
+  }
+
+  QSize lSize(800, 600);
+  if(!HistoryPlot::getExportSize(this, lSize)){
+    return;
+  }
+
+  // Snapshots are taken here on the GUI thread; the drawing and
+  // encoding happen on worker threads and never touch the windows
+  for(i=0; i<mAppList.count(); i++){
+    Application *lApp = mAppList.at(i);
+    QString lAppName = mAppTabs->tabLabel(lApp);
+    lAppName.replace(QRegExp("[^A-Za-z0-9_\\-]"), "_");
+
+    Q3PtrList<HistoryPlot> &lPlots = lApp->getControlForm()->mHistoryPlotList;
+    for(j=0, lPlot = lPlots.first(); lPlot; j++, lPlot = lPlots.next()){
+      PlotExportJob lJob;
+      lJob.mSnapshot = lPlot->snapshot(lSize.width());
+      lJob.mFileName = QString("%1/%2_plot%3.png").arg(lDir).arg(lAppName).arg(j);
+      lJob.mSize = lSize;
+      lJobs.append(lJob);
+    }
+  }
+
+  if(lJobs.isEmpty()){
+    statusBar()->message("No plots to export");
+    return;
+  }
+
+  statusBar()->message(QString("Exporting %1 plots...").arg(lJobs.count()));
+  mExportWatcher.setFuture(QtConcurrent::mapped(lJobs, renderPlotExportJob));
+}
+
+void
+SteererMainWindow::exportAllPlotsDoneSlot()
+{
+  int i, lNumFailed = 0;
+  QFuture<bool> lFuture = mExportWatcher.future();
+
+  for(i=0; i<lFuture.resultCount(); i++){
+    if(!lFuture.resultAt(i)){
+      lNumFailed++;
+    }
+  }
+
+  if(lNumFailed){
+    QMessageBox::warning(this, "Export all plots",
+			 QString("Failed to save %1 of %2 plots.")
+			 .arg(lNumFailed).arg(lFuture.resultCount()));
+  }
+  statusBar()->message(QString("Exported %1 plots")
+		       .arg(lFuture.resultCount() - lNumFailed));
+}
+
+void
+SteererMainWindow::ensemblePlotSlot()
+{
+  unsigned int i;
+  bool ok;
+  QMap<QString, int> lLabelCounts;
+  QStringList lLabels;
+
+  // Offer every parameter that more than one application has
+  for(i=0; i<mAppList.count(); i++){
+    lLabels = mAppList.at(i)->getControlForm()->getParameterLabels();
+    for(QStringList::Iterator it = lLabels.begin(); it != lLabels.end(); ++it){
+      lLabelCounts[*it]++;
+    }
+  }
+  lLabels.clear();
+  for(QMap<QString, int>::Iterator it = lLabelCounts.begin();
+      it != lLabelCounts.end(); ++it){
+    if(it.value() > 1 && it.key() != "SEQUENCE_NUM"){
+      lLabels.append(it.key());
+    }
+  }
+
+  if(lLabels.isEmpty()){
+    QMessageBox::information(this, "Ensemble plot",
+			     "There are no parameters common to two or "
+			     "more applications.");
+    return;
+  }
+
+  QString lLabel = QInputDialog::getItem("Ensemble plot",
+					 "Parameter to plot:",
+					 lLabels, 0, false, &ok, this);
+  if(!ok){
+    return;
+  }
+
+  // Collect the applications that have both this parameter and a
+  // sequence number to line them up by
+  QList<Application *> lApps;
+  for(i=0; i<mAppList.count(); i++){
+    ControlForm *lForm = mAppList.at(i)->getControlForm();
+    if(lForm->findParameterFromLabel(lLabel) &&
+       lForm->findParameterFromLabel("SEQUENCE_NUM")){
+      lApps.append(mAppList.at(i));
+    }
+  }
+
+  if(lApps.isEmpty()){
+    QMessageBox::information(this, "Ensemble plot",
+			     "No application logs both " + lLabel +
+			     " and SEQUENCE_NUM.");
+    return;
+  }
+
+  EnsemblePlot *lPlot = new EnsemblePlot(lLabel, lApps.count());
+  for(int j=0; j<lApps.count(); j++){
+    ControlForm *lForm = lApps[j]->getControlForm();
+    lPlot->addMember(lApps[j], mAppTabs->tabLabel(lApps[j]),
+		     lForm->findParameterFromLabel("SEQUENCE_NUM")->mParamHist,
+		     lForm->findParameterFromLabel(lLabel)->mParamHist);
+    connect(lForm, SIGNAL(paramUpdateSignal()), lPlot, SLOT(updateSlot()));
+    connect(lApps[j], SIGNAL(finishedSignal(Application*)), lPlot,
+	    SLOT(retireApplicationSlot(Application*)));
+    if(lApps[j]->isFinished()){
+      lPlot->retireApplicationSlot(lApps[j]);
+    }
+  }
+  mEnsemblePlotList.append(lPlot);
+  connect(lPlot, SIGNAL(ensemblePlotClosedSignal(EnsemblePlot*)), this,
+	  SLOT(ensemblePlotClosedSlot(EnsemblePlot*)));
+  lPlot->show();
+}
+
+void
+SteererMainWindow::exportApplicationSlot()
+{
+  Application *lApp = (Application *)mAppTabs->currentPage();
+
+  if(mAppList.count() == 0 || !lApp){
+    QMessageBox::information(this, "Export",
+			     "There is no application to export.");
+    return;
+  }
+  lApp->getControlForm()->exportParameters();
+}
+
+void
+SteererMainWindow::ensemblePlotClosedSlot(EnsemblePlot *ptr)
+{
+  // Auto delete means the plot is destroyed once it's off the list
+  mEnsemblePlotList.removeRef(ptr);
+}
+
+void
+SteererMainWindow::steeringRulesSlot()
+{
+  Application *lApp = (Application *)mAppTabs->currentPage();
+
+  if(mAppList.count() == 0 || !lApp || lApp->isReplay() || !mCommsThread){
+    QMessageBox::information(this, "Steering rules",
+			     "There is no application to steer.");
+    return;
+  }
+
+  // The comms thread applies the rules so it's the one to ask
+  QString lCurrent = mCommsThread->describeRules(lApp->getHandle());
+  if(!lCurrent.isNull()){
+    int lChoice = QMessageBox::information(this, "Steering rules",
+					   lCurrent, "&Close", "&Load...",
+					   "C&lear", 0, 0);
+    if(lChoice == 2){
+      mCommsThread->setRules(lApp->getHandle(), kNULL);
+    }
+    if(lChoice != 1){
+      return;
+    }
+  }
+
+  QString lFileName =
+    Q3FileDialog::getOpenFileName(QString::null,
+				  "Steering rules (*.txt);;All files (*)",
+				  this, "rules dialog",
+				  "Choose steering rules");
+  if(lFileName.isEmpty()){
+    return;
+  }
+
+  SteeringRules *lRules = new SteeringRules(lFileName, lApp->getHandle(),
+					    &mReGMutex);
+  if(!lRules->load()){
+    QMessageBox::warning(this, "Steering rules", lRules->errorString());
+    delete lRules;
+    return;
+  }
+
+  mCommsThread->setRules(lApp->getHandle(), lRules);
+  statusBar()->message(QString("Loaded %1 steering rules").
+		       arg(lRules->count()), 5000);
+}
+
+void
+SteererMainWindow::broadcastSlot()
+{
+  unsigned int i;
+  QList<Application *> lApps;
+  QStringList lNames;
+  QStringList lLabels;
+
+  // Offer every application that can be steered, and every label
+  // any of them steers
+  for(i=0; i<mAppList.count(); i++){
+    Application *lApp = mAppList.at(i);
+    SteeredParameterTable *lTable =
+      lApp->getControlForm()->getSteeredParamTable();
+
+    if(lApp->isReplay() || !lTable || !lTable->getAppAttached()){
+      continue;
+    }
+    lApps.append(lApp);
+    lNames.append(mAppTabs->tabLabel(lApp));
+
+    QStringList lAppLabels = lTable->getParameterLabels();
+    for(int j=0; j<lAppLabels.count(); j++){
+      if(!lLabels.contains(lAppLabels[j])){
+	lLabels.append(lAppLabels[j]);
+      }
+    }
+  }
+
+  if(lLabels.isEmpty()){
+    QMessageBox::information(this, "Broadcast steering",
+			     "There are no steered parameters to set.");
+    return;
+  }
+  lLabels.sort();
+
+  BroadcastForm lForm(lNames, lLabels, this);
+  if(lForm.exec() != QDialog::Accepted){
+    return;
+  }
+
+  // Each application's values are checked and sent as soon as it's
+  // reached - one Emit_control each, with no GUI work in between
+  QList<int> lChosen = lForm.getSelectedApps();
+  QStringList lReport;
+  int lSentTo = 0;
+  QTime lTimer;
+  lTimer.start();
+
+  for(int j=0; j<lChosen.count(); j++){
+    Application *lApp = lApps[lChosen[j]];
+    QStringList lRejected;
+
+    if(lApp->getControlForm()->broadcastValues(lForm.getPreset(),
+					       lRejected) > 0){
+      lSentTo++;
+    }
+    for(int k=0; k<lRejected.count(); k++){
+      lReport.append(lNames[lChosen[j]] + ": " + lRejected[k]);
+    }
+  }
+
+  QString lMsg = QString("Broadcast to %1 of %2 applications in %3 ms").
+    arg(lSentTo).arg(lChosen.count()).arg(lTimer.elapsed());
+  statusBar()->message(lMsg, 5000);
+
+  if(!lReport.isEmpty()){
+    QMessageBox::warning(this, "Broadcast steering",
+			 lMsg + "\n\nNot sent:\n" + lReport.join("\n"));
+  }
+}
+
+void
+SteererMainWindow::steeringTimelineSlot()
+{
+  Application *lApp = (Application *)mAppTabs->currentPage();
+
+  if(mAppList.count() == 0 || !lApp || lApp->isReplay() || !mCommsThread){
+    QMessageBox::information(this, "Steering timeline",
+			     "There is no application to steer.");
+    return;
+  }
+
+  // The comms thread runs the timeline so it's the one to ask
+  QString lCurrent = mCommsThread->describeTimeline(lApp->getHandle());
+  if(!lCurrent.isNull()){
+    int lChoice = QMessageBox::information(this, "Steering timeline",
+					   lCurrent, "&Close", "&Load...",
+					   "C&lear", 0, 0);
+    if(lChoice == 2){
+      mCommsThread->setTimeline(lApp->getHandle(), kNULL);
+    }
+    if(lChoice != 1){
+      return;
+    }
+  }
+
+  QString lFileName =
+    Q3FileDialog::getOpenFileName(QString::null,
+				  "Steering timelines (*.txt);;All files (*)",
+				  this, "timeline dialog",
+				  "Choose a steering timeline");
+  if(lFileName.isEmpty()){
+    return;
+  }
+
+  SteeringTimeline *lTimeline = new SteeringTimeline(lFileName,
+						     lApp->getHandle(),
+						     &mReGMutex);
+  if(!lTimeline->load()){
+    QMessageBox::warning(this, "Steering timeline", lTimeline->errorString());
+    delete lTimeline;
+    return;
+  }
+
+  mCommsThread->setTimeline(lApp->getHandle(), lTimeline);
+  statusBar()->message(QString("Loaded steering timeline of %1 actions").
+		       arg(lTimeline->count()), 5000);
+}
+
 void
 SteererMainWindow::quitSlot()
 {
@@ -640,6 +1116,7 @@ SteererMainWindow::configureSteererSlot()
 {
 
   ConfigForm *lConfigForm = new ConfigForm(mCommsThread->getCheckInterval(),
+					   mSteererConfig->mDisplayRefreshRate,
 					   this);
 
   if ( lConfigForm->exec() == QDialog::Accepted )
@@ -647,6 +1124,13 @@ SteererMainWindow::configureSteererSlot()
     REG_DBGMSG1("config applied, interval= ", lConfigForm->getIntervalValue());
      mCommsThread->setCheckInterval(lConfigForm->getIntervalValue());
 
+    // The refresh rate applies to every application attached to
+    mSteererConfig->mDisplayRefreshRate = lConfigForm->getRefreshRate();
+    for(unsigned int i=0; i<mAppList.count(); i++){
+      mAppList.at(i)->
+	setDisplayRefreshRate(mSteererConfig->mDisplayRefreshRate);
+    }
+
   }
   else {
     REG_DBGMSG("Config cancelled");
@@ -673,6 +1157,171 @@ void SteererMainWindow::toggleAutoPollSlot()
   return;
 }
 
+void SteererMainWindow::replaySessionSlot()
+{
+  bool ok;
+
+  QString lFileName =
+    Q3FileDialog::getOpenFileName(mSteererConfig->mSessionDirectory,
+				  "Recorded sessions (*.rgs)", this,
+				  "replay dialog", "Choose a session");
+  if(lFileName.isEmpty()){
+    return;
+  }
+
+  SessionReader *lReader = new SessionReader(lFileName);
+  if(!lReader->open()){
+    delete lReader;
+    QMessageBox::warning(this, "Replay session",
+			 lFileName + " is not a recorded session.");
+    return;
+  }
+
+  QStringList lSpeeds;
+  lSpeeds << "Real time" << "2x" << "5x" << "10x" << "100x"
+	  << "As fast as possible";
+  QString lSpeed = QInputDialog::getItem("Replay session",
+					 "Replay speed:",
+					 lSpeeds, 0, false, &ok, this);
+  if(!ok){
+    delete lReader;
+    return;
+  }
+  double lFactor = 1.0;
+  if(lSpeed == lSpeeds.last()){
+    lFactor = 0.0;
+  }
+  else if(lSpeed.endsWith("x")){
+    lFactor = lSpeed.left(lSpeed.length() - 1).toDouble();
+  }
+
+  Application *lApp = new Application(this,
+				       lReader->applicationName().latin1(),
+				       mNextReplayHandle--, true,
+				       &mReGMutex, true);
+  mAppList.append(lApp);
+  mAppTabs->addTab(lApp, "Replay: " + lReader->applicationName());
+  mAppTabs->showPage(lApp);
+  mStack->setCurrentWidget(mAppTabs);
+  if(mAppList.count() == 1)resize(525, 700);
+
+  lApp->startReplay(lReader, lFactor);
+}
+
+/** The file is memory mapped and belongs to the plot - nothing is
+ *  read beyond the header until a column is plotted, and then only
+ *  the (compressed) chunks in the range of sequence numbers chosen */
+void SteererMainWindow::openHistoryFileSlot()
+{
+  bool ok;
+
+  QString lFileName =
+    Q3FileDialog::getOpenFileName(mSteererConfig->mSessionDirectory,
+				  "History files (*.bin *.binz *.rgs)", this,
+				  "history dialog", "Choose a history file");
+  if(lFileName.isEmpty()){
+    return;
+  }
+
+  HistoryFile *lFile = new HistoryFile(lFileName);
+  if(!lFile->open()){
+    QMessageBox::warning(this, "Open history file",
+			 "Cannot plot " + lFileName + ":\n" +
+			 lFile->errorString());
+    delete lFile;
+    return;
+  }
+
+  const QStringList &lLabels = lFile->labels();
+  if(lLabels.count() < 2){
+    QMessageBox::warning(this, "Open history file",
+			 lFileName + " has nothing to plot.");
+    delete lFile;
+    return;
+  }
+
+  // First column is the sequence number in both kinds of file
+  QString lXLabel = QInputDialog::getItem("Open history file",
+					  "Plot against:",
+					  lLabels, 0, false, &ok, this);
+  if(!ok){
+    delete lFile;
+    return;
+  }
+  QString lYLabel = QInputDialog::getItem("Open history file",
+					  "Column to plot:",
+					  lLabels, lLabels.count() - 1,
+					  false, &ok, this);
+  if(!ok){
+    delete lFile;
+    return;
+  }
+  int lX = lLabels.indexOf(lXLabel);
+  int lY = lLabels.indexOf(lYLabel);
+
+  // Only the chunks covering the range asked for are decompressed
+  if(lFile->isCompressed()){
+    double lFirst, lLast;
+    lFile->seqRange(lFirst, lLast);
+    int lFrom = QInputDialog::getInteger("Open history file",
+					 "First sequence number:",
+					 (int)lFirst, (int)lFirst, (int)lLast,
+					 1, &ok, this);
+    if(!ok){
+      delete lFile;
+      return;
+    }
+    int lTo = QInputDialog::getInteger("Open history file",
+				       "Last sequence number:",
+				       (int)lLast, lFrom, (int)lLast,
+				       1, &ok, this);
+    if(!ok){
+      delete lFile;
+      return;
+    }
+    lFile->setSeqRange(lFrom, lTo);
+  }
+
+  // Abscissa of SEQUENCE_NUM is what a HistoryPlot expects for
+  // 'against time' plots
+  HistoryPlot *lPlot =
+    new HistoryPlot(lFile->history(lX), lFile->history(lY),
+		    (lX == 0) ? "SEQUENCE_NUM" : lXLabel.latin1(),
+		    lYLabel.latin1(), lX, lY,
+		    QFileInfo(lFileName).fileName().latin1());
+  lPlot->setHistoryFile(lFile);
+  mFilePlotList.append(lPlot);
+  connect(lPlot, SIGNAL(plotClosedSignal(HistoryPlot *)), this,
+	  SLOT(filePlotClosedSlot(HistoryPlot *)));
+  lPlot->show();
+
+  statusBar()->message(QString("%1 rows in %2").arg(lFile->numRows())
+		       .arg(lFileName));
+}
+
+void
+SteererMainWindow::filePlotClosedSlot(HistoryPlot *ptr)
+{
+  // Auto delete means the plot (and its file) go once it's off the list
+  mFilePlotList.removeRef(ptr);
+}
+
+/** Only affects applications attached to from now on - those already
+ *  attached carry on as they are */
+void SteererMainWindow::toggleRecordSessionsSlot()
+{
+  mSteererConfig->mRecordSessions = !mSteererConfig->mRecordSessions;
+
+  if(mSteererConfig->mRecordSessions){
+    mToggleRecordAction->setMenuText(QString("Stop &recording sessions"));
+    statusBar()->message("Recording sessions to " +
+			 mSteererConfig->mSessionDirectory);
+  }
+  else{
+    mToggleRecordAction->setMenuText(QString("Start &recording sessions"));
+  }
+}
+
 void SteererMainWindow::statusBarMessageSlot(Application *aApp,
 					     QString &message){
 
@@ -696,9 +1345,25 @@ SteererMainWindow::tabChangedSlot(int index)
   // if index is out of range, then just return
   if(aApp == NULL) return;
 
+  // Only the application on show updates its tables - this one
+  // catches up now
+  for(unsigned int i=0; i<mAppList.count(); i++){
+    if(mAppList.at(i) != aApp){
+      mAppList.at(i)->getControlForm()->setDisplayActive(false);
+    }
+  }
+  aApp->getControlForm()->setDisplayActive(true);
+
   // Update the status bar so it is relevant to this tab
   statusBar()->message( aApp->getCurrentStatus() );
 
+  if(aApp->getControlForm()->getMonParamTable()->sparklinesShown()){
+    mToggleSparklinesAction->setMenuText("Hide &trend sparklines");
+  }
+  else{
+    mToggleSparklinesAction->setMenuText("Show &trend sparklines");
+  }
+
   // Ensure the View menu reflects what is being displayed on this
   // tab
   if(aApp->chkTableVisible()){
@@ -807,6 +1472,61 @@ void SteererMainWindow::hideMonTableSlot()
   }
 }
 
+void SteererMainWindow::toggleSparklinesSlot()
+{
+  Application *aApp;
+
+  if( (aApp = (Application *)(mAppTabs->currentPage())) ){
+    ParameterTable *lTable = aApp->getControlForm()->getMonParamTable();
+
+    if(lTable->sparklinesShown()){
+      lTable->setSparklinesShown(false);
+      mToggleSparklinesAction->setMenuText("Show &trend sparklines");
+    }
+    else{
+      lTable->setSparklinesShown(true);
+      mToggleSparklinesAction->setMenuText("Hide &trend sparklines");
+    }
+  }
+}
+
+void SteererMainWindow::displayStatisticsSlot()
+{
+  QString lText;
+  int lTotalMSecs = 0;
+  double lTotalSaved = 0.0;
+
+  for(unsigned int i=0; i<mAppList.count(); i++){
+    ControlForm *lForm = mAppList.at(i)->getControlForm();
+    int lCount = lForm->getRefreshCount();
+    int lSkipped = lForm->getSkippedRefreshCount();
+    int lMSecs = lForm->getRefreshMSecs();
+
+    // Assume that each skipped refresh would have taken as long as
+    // the average one that wasn't
+    double lSaved = lCount ? (double)lSkipped*lMSecs/lCount : 0.0;
+
+    lText += QString("%1: %2 refreshes (%3 ms), %4 skipped while hidden "
+		     "(~%5 ms)\n").arg(mAppTabs->tabLabel(mAppList.at(i))).
+      arg(lCount).arg(lMSecs).arg(lSkipped).arg(lSaved, 0, 'f', 0);
+    lTotalMSecs += lMSecs;
+    lTotalSaved += lSaved;
+  }
+
+  if(lText.isEmpty()){
+    lText = "No applications attached\n";
+  }
+  else if(lTotalMSecs + lTotalSaved > 0.0){
+    lText += QString("\nHidden tabs saved ~%1% of the time spent "
+		     "redrawing tables").
+      arg(100.0*lTotalSaved/(lTotalMSecs + lTotalSaved), 0, 'f', 1);
+  }
+
+  QMessageBox::information(this, "Display statistics", lText,
+			   QMessageBox::Ok, QMessageBox::NoButton,
+			   QMessageBox::NoButton);
+}
+
 bool SteererMainWindow::autoPollingOn()
 {
   return mSteererConfig->mAutoPollingOn;
@@ -0,0 +1,219 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file steeringcommandbuilder.cpp
+    @brief Implementation of the SteeringCommandBuilder class -
+    batching of everything sent to an application into one
+    Emit_control */
+
+#include <qmutex.h>
+
+#include "buildconfig.h"
+#include "steeringcommandbuilder.h"
+#include "marshalarena.h"
+#include "sessionrecorder.h"
+#include "exception.h"
+#include "types.h"
+#include "debug.h"
+
+#include "ReG_Steer_Steerside.h"
+
+SteeringCommandBuilder::SteeringCommandBuilder(int aSimHandle,
+					       QMutex *aMutex,
+					       MarshalArena *aArena)
+  : mSimHandle(aSimHandle), mMutexPtr(aMutex), mArena(aArena),
+    mRecorder(kNULL), mNumParams(0), mNumIOFreqs(0), mNumChkFreqs(0),
+    mNumCommands(0)
+{
+  REG_DBGCON("SteeringCommandBuilder");
+}
+
+//---------------------------------------------------------------------------
+SteeringCommandBuilder::~SteeringCommandBuilder()
+{
+  REG_DBGDST("SteeringCommandBuilder");
+}
+
+//---------------------------------------------------------------------------
+void SteeringCommandBuilder::setRecorder(SessionRecorder *aRecorder)
+{
+  mRecorder = aRecorder;
+}
+
+//---------------------------------------------------------------------------
+void SteeringCommandBuilder::reset()
+{
+  mNumParams = 0;
+  mNumIOFreqs = 0;
+  mNumChkFreqs = 0;
+  mNumCommands = 0;
+  mParamLabels.clear();
+}
+
+//---------------------------------------------------------------------------
+int SteeringCommandBuilder::count() const
+{
+  return mNumParams + mNumIOFreqs + mNumChkFreqs + mNumCommands;
+}
+
+//---------------------------------------------------------------------------
+void SteeringCommandBuilder::addParamValue(int aHandle,
+					   const QString &aLabel,
+					   const QString &aValue)
+{
+  int *lHandles = mArena->ints(MarshalArena::kPARAM_HANDLES, mNumParams + 1);
+  char **lVals = mArena->strings(MarshalArena::kPARAM_VALUES, mNumParams + 1);
+
+  // REG_MAX_STRING_LENGTH is the longest value the library will take
+  lHandles[mNumParams] = aHandle;
+  qstrncpy(lVals[mNumParams], aValue.latin1(), REG_MAX_STRING_LENGTH + 1);
+  mNumParams++;
+
+  if(mRecorder){
+    mParamLabels.append(aLabel);
+  }
+}
+
+//---------------------------------------------------------------------------
+void SteeringCommandBuilder::addFrequency(bool aChkType, int aHandle,
+					  int aFreq)
+{
+  int &lNum = aChkType ? mNumChkFreqs : mNumIOFreqs;
+  int *lHandles = mArena->ints(aChkType ? MarshalArena::kCHK_HANDLES :
+			       MarshalArena::kIO_HANDLES, lNum + 1);
+  int *lFreqs = mArena->ints(aChkType ? MarshalArena::kCHK_FREQS :
+			     MarshalArena::kIO_FREQS, lNum + 1);
+
+  lHandles[lNum] = aHandle;
+  lFreqs[lNum] = aFreq;
+  lNum++;
+}
+
+//---------------------------------------------------------------------------
+void SteeringCommandBuilder::addCommand(int aCmdId, const char *aParam)
+{
+  int *lCmds = mArena->ints(MarshalArena::kCOMMANDS, mNumCommands + 1);
+  char **lParams = mArena->strings(MarshalArena::kCMD_PARAMS,
+				   mNumCommands + 1, kCHKPT_PARAM_LEN);
+
+  lCmds[mNumCommands] = aCmdId;
+  qstrncpy(lParams[mNumCommands], aParam, kCHKPT_PARAM_LEN);
+  mNumCommands++;
+}
+
+//---------------------------------------------------------------------------
+void SteeringCommandBuilder::send()
+{
+  if(count() == 0){
+    return;
+  }
+
+  // The buffers are all big enough already so these just return them
+  int *lParamHandles = mArena->ints(MarshalArena::kPARAM_HANDLES, mNumParams);
+  char **lParamVals = mArena->strings(MarshalArena::kPARAM_VALUES,
+				      mNumParams);
+  int *lIOHandles = mArena->ints(MarshalArena::kIO_HANDLES, mNumIOFreqs);
+  int *lIOFreqs = mArena->ints(MarshalArena::kIO_FREQS, mNumIOFreqs);
+  int *lChkHandles = mArena->ints(MarshalArena::kCHK_HANDLES, mNumChkFreqs);
+  int *lChkFreqs = mArena->ints(MarshalArena::kCHK_FREQS, mNumChkFreqs);
+  int *lCmds = mArena->ints(MarshalArena::kCOMMANDS, mNumCommands);
+  char **lCmdParams = mArena->strings(MarshalArena::kCMD_PARAMS,
+				      mNumCommands, kCHKPT_PARAM_LEN);
+
+  // The values and frequencies only go into the library - it's
+  // Emit_control that sends them (and the commands) to the application
+  const char *lFailed = kNULL;
+
+  mMutexPtr->lock();
+  if(mNumParams > 0 &&
+     Set_param_values(mSimHandle, mNumParams, lParamHandles,  //ReG library
+		      lParamVals) != REG_SUCCESS){
+    lFailed = "Set_param_values";
+  }
+  else if(mNumIOFreqs > 0 &&
+	  Set_iotype_freq(mSimHandle, mNumIOFreqs, lIOHandles,  //ReG library
+			  lIOFreqs) != REG_SUCCESS){
+    lFailed = "Set_iotype_freq";
+  }
+  else if(mNumChkFreqs > 0 &&
+	  Set_chktype_freq(mSimHandle, mNumChkFreqs, lChkHandles, //ReG library
+			   lChkFreqs) != REG_SUCCESS){
+    lFailed = "Set_chktype_freq";
+  }
+  else if(Emit_control(mSimHandle, mNumCommands,		//ReG library
+		       mNumCommands ? lCmds : NULL,
+		       mNumCommands ? lCmdParams : NULL) != REG_SUCCESS){
+    lFailed = "Emit_control";
+  }
+  mMutexPtr->unlock();
+
+  if(lFailed){
+    reset();
+    THROWEXCEPTION(lFailed);
+  }
+
+  REG_DBGMSG1("Sent steering commands, count = ", count());
+
+  if(mRecorder){
+    for(int i=0; i<mNumParams; i++){
+      mRecorder->recordCommand("set " + mParamLabels[i] + " " +
+			       QString(lParamVals[i]));
+    }
+    for(int i=0; i<mNumIOFreqs; i++){
+      mRecorder->recordCommand(QString("frequency %1 %2").
+			       arg(lIOHandles[i]).arg(lIOFreqs[i]));
+    }
+    for(int i=0; i<mNumChkFreqs; i++){
+      mRecorder->recordCommand(QString("frequency %1 %2").
+			       arg(lChkHandles[i]).arg(lChkFreqs[i]));
+    }
+    for(int i=0; i<mNumCommands; i++){
+      mRecorder->recordCommand(QString("command %1 %2").arg(lCmds[i]).
+			       arg(QString(lCmdParams[i]).stripWhiteSpace()));
+    }
+  }
+
+  reset();
+}
@@ -0,0 +1,782 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file steeringrules.cpp
+    @brief Implementation of the SteeringRules class - rules applied
+    by the comms thread to steer an application automatically */
+
+#include <qfile.h>
+#include <qtextstream.h>
+#include <qmutex.h>
+#include <qregexp.h>
+#include <math.h>
+
+#include "buildconfig.h"
+#include "steeringrules.h"
+#include "steeringcommandbuilder.h"
+#include "marshalarena.h"
+#include "parameter.h"
+#include "exception.h"
+#include "types.h"
+#include "debug.h"
+
+#include "ReG_Steer_Steerside.h"
+
+//---------------------------------------------------------------------------
+/// Recursive descent parser for a rule.  Any error leaves a message
+/// in mError and makes the parse functions return null.
+class RuleParser
+{
+public:
+  RuleParser(const QString &aText);
+
+  /// Parse "when <condition> set <label> = <expression> [every <n>]"
+  bool parseRule(SteeringRules::Expr *&aCondition, QString &aTarget,
+		 SteeringRules::Expr *&aValue, int &aEvery);
+  QString errorString() const;
+
+private:
+  enum TokenType {kEND, kNUMBER, kNAME, kSYMBOL};
+
+  /// Move on to the next token
+  void next();
+  /// Whether the current token is the symbol or keyword aToken
+  bool at(const char *aToken) const;
+  /// Move past the symbol or keyword aToken if it's next
+  bool accept(const char *aToken);
+  bool expect(const char *aToken);
+  bool fail(const QString &aError);
+
+  SteeringRules::Expr *parseOr();
+  SteeringRules::Expr *parseAnd();
+  SteeringRules::Expr *parseNot();
+  SteeringRules::Expr *parseComparison();
+  SteeringRules::Expr *parseSum();
+  SteeringRules::Expr *parseProduct();
+  SteeringRules::Expr *parseUnary();
+  SteeringRules::Expr *parsePrimary();
+
+  QString   mText;
+  int       mPos;
+  TokenType mType;
+  QString   mToken;
+  /// Whether the current kNAME was in quotes (so isn't a keyword)
+  bool      mQuoted;
+  double    mNumber;
+  QString   mError;
+};
+
+RuleParser::RuleParser(const QString &aText)
+  : mText(aText), mPos(0), mType(kEND), mQuoted(false), mNumber(0.0)
+{
+  next();
+}
+
+QString RuleParser::errorString() const
+{
+  return mError;
+}
+
+bool RuleParser::fail(const QString &aError)
+{
+  if(mError.isEmpty()){
+    mError = aError;
+  }
+  return false;
+}
+
+void RuleParser::next()
+{
+  while(mPos < (int)mText.length() && mText[mPos].isSpace()){
+    mPos++;
+  }
+
+  mToken = QString::null;
+  mQuoted = false;
+  if(mPos >= (int)mText.length()){
+    mType = kEND;
+    return;
+  }
+
+  QChar lChar = mText[mPos];
+  int lStart = mPos;
+
+  QRegExp lNumberRx("(\\d+\\.?\\d*|\\.\\d+)([eE][-+]?\\d+)?");
+
+  if(lNumberRx.indexIn(mText, mPos) == mPos){
+    mPos += lNumberRx.matchedLength();
+    mNumber = lNumberRx.cap(0).toDouble();
+    mType = kNUMBER;
+  }
+  else if(lChar.isLetter() || lChar == '_'){
+    while(mPos < (int)mText.length() &&
+	  (mText[mPos].isLetterOrNumber() || mText[mPos] == '_')){
+      mPos++;
+    }
+    mType = kNAME;
+  }
+  else if(lChar == '"'){
+    int lEnd = mText.find('"', mPos + 1);
+    if(lEnd < 0){
+      fail("unterminated quoted label");
+      mType = kEND;
+      mPos = mText.length();
+      return;
+    }
+    mToken = mText.mid(mPos + 1, lEnd - mPos - 1);
+    mPos = lEnd + 1;
+    mType = kNAME;
+    mQuoted = true;
+    return;
+  }
+  else{
+    static const char *lSymbols[] = {"<=", ">=", "==", "!=", "&&", "||",
+				      "<", ">", "=", "!", "+", "-", "*", "/",
+				      "(", ")", ",", 0};
+    mType = kSYMBOL;
+    for(int i=0; lSymbols[i]; i++){
+      if(mText.mid(mPos, qstrlen(lSymbols[i])) == lSymbols[i]){
+	mPos += qstrlen(lSymbols[i]);
+	break;
+      }
+    }
+    if(mPos == lStart){
+      fail(QString("unexpected '%1'").arg(lChar));
+      mType = kEND;
+      mPos = mText.length();
+      return;
+    }
+  }
+
+  mToken = mText.mid(lStart, mPos - lStart);
+}
+
+bool RuleParser::at(const char *aToken) const
+{
+  if(mType == kSYMBOL){
+    return mToken == aToken;
+  }
+  return mType == kNAME && !mQuoted &&
+    mToken.lower() == QString(aToken);
+}
+
+bool RuleParser::accept(const char *aToken)
+{
+  if(at(aToken)){
+    next();
+    return true;
+  }
+  return false;
+}
+
+bool RuleParser::expect(const char *aToken)
+{
+  if(accept(aToken)){
+    return true;
+  }
+  return fail(QString("expected '%1'").arg(aToken));
+}
+
+bool RuleParser::parseRule(SteeringRules::Expr *&aCondition,
+			   QString &aTarget, SteeringRules::Expr *&aValue,
+			   int &aEvery)
+{
+  aCondition = kNULL;
+  aValue = kNULL;
+  aEvery = 1;
+
+  if(!expect("when") || !(aCondition = parseOr()) || !expect("set")){
+    return false;
+  }
+
+  if(mType != kNAME){
+    return fail("expected the label of a steered parameter after 'set'");
+  }
+  aTarget = mToken;
+  next();
+
+  if(!expect("=") || !(aValue = parseOr())){
+    return false;
+  }
+
+  if(accept("every")){
+    if(mType != kNUMBER || mNumber < 1 || mNumber != floor(mNumber)){
+      return fail("expected a whole number after 'every'");
+    }
+    aEvery = (int)mNumber;
+    next();
+  }
+
+  if(mType != kEND){
+    return fail("unexpected '" + mToken + "'");
+  }
+  return mError.isEmpty();
+}
+
+SteeringRules::Expr *RuleParser::parseOr()
+{
+  SteeringRules::Expr *lExpr = parseAnd();
+
+  while(lExpr && (accept("or") || accept("||"))){
+    SteeringRules::Expr *lRight = parseAnd();
+    if(!lRight){
+      delete lExpr;
+      return kNULL;
+    }
+    lExpr = new SteeringRules::Expr(SteeringRules::Expr::kOR, lExpr, lRight);
+  }
+  return lExpr;
+}
+
+SteeringRules::Expr *RuleParser::parseAnd()
+{
+  SteeringRules::Expr *lExpr = parseNot();
+
+  while(lExpr && (accept("and") || accept("&&"))){
+    SteeringRules::Expr *lRight = parseNot();
+    if(!lRight){
+      delete lExpr;
+      return kNULL;
+    }
+    lExpr = new SteeringRules::Expr(SteeringRules::Expr::kAND, lExpr, lRight);
+  }
+  return lExpr;
+}
+
+SteeringRules::Expr *RuleParser::parseNot()
+{
+  if(accept("not") || accept("!")){
+    SteeringRules::Expr *lExpr = parseNot();
+    return lExpr ? new SteeringRules::Expr(SteeringRules::Expr::kNOT, lExpr)
+      : kNULL;
+  }
+  return parseComparison();
+}
+
+SteeringRules::Expr *RuleParser::parseComparison()
+{
+  static const struct {
+    const char *mSymbol;
+    SteeringRules::Expr::Op mOp;
+  } lOps[] = {{"<=", SteeringRules::Expr::kLE},
+	      {">=", SteeringRules::Expr::kGE},
+	      {"==", SteeringRules::Expr::kEQ},
+	      {"!=", SteeringRules::Expr::kNE},
+	      {"<", SteeringRules::Expr::kLT},
+	      {">", SteeringRules::Expr::kGT},
+	      {0, SteeringRules::Expr::kLT}};
+
+  SteeringRules::Expr *lExpr = parseSum();
+  if(!lExpr){
+    return kNULL;
+  }
+
+  for(int i=0; lOps[i].mSymbol; i++){
+    if(accept(lOps[i].mSymbol)){
+      SteeringRules::Expr *lRight = parseSum();
+      if(!lRight){
+	delete lExpr;
+	return kNULL;
+      }
+      return new SteeringRules::Expr(lOps[i].mOp, lExpr, lRight);
+    }
+  }
+  return lExpr;
+}
+
+SteeringRules::Expr *RuleParser::parseSum()
+{
+  SteeringRules::Expr *lExpr = parseProduct();
+
+  while(lExpr && (at("+") || at("-"))){
+    SteeringRules::Expr::Op lOp = at("+") ? SteeringRules::Expr::kADD :
+      SteeringRules::Expr::kSUB;
+    next();
+    SteeringRules::Expr *lRight = parseProduct();
+    if(!lRight){
+      delete lExpr;
+      return kNULL;
+    }
+    lExpr = new SteeringRules::Expr(lOp, lExpr, lRight);
+  }
+  return lExpr;
+}
+
+SteeringRules::Expr *RuleParser::parseProduct()
+{
+  SteeringRules::Expr *lExpr = parseUnary();
+
+  while(lExpr && (at("*") || at("/"))){
+    SteeringRules::Expr::Op lOp = at("*") ? SteeringRules::Expr::kMUL :
+      SteeringRules::Expr::kDIV;
+    next();
+    SteeringRules::Expr *lRight = parseUnary();
+    if(!lRight){
+      delete lExpr;
+      return kNULL;
+    }
+    lExpr = new SteeringRules::Expr(lOp, lExpr, lRight);
+  }
+  return lExpr;
+}
+
+SteeringRules::Expr *RuleParser::parseUnary()
+{
+  if(accept("-")){
+    SteeringRules::Expr *lExpr = parseUnary();
+    return lExpr ? new SteeringRules::Expr(SteeringRules::Expr::kNEG, lExpr)
+      : kNULL;
+  }
+  return parsePrimary();
+}
+
+SteeringRules::Expr *RuleParser::parsePrimary()
+{
+  if(mType == kNUMBER){
+    SteeringRules::Expr *lExpr =
+      new SteeringRules::Expr(SteeringRules::Expr::kNUMBER);
+    lExpr->mValue = mNumber;
+    next();
+    return lExpr;
+  }
+
+  if(accept("(")){
+    SteeringRules::Expr *lExpr = parseOr();
+    if(lExpr && !expect(")")){
+      delete lExpr;
+      return kNULL;
+    }
+    return lExpr;
+  }
+
+  if(mType != kNAME || at("when") || at("set") || at("every") ||
+     at("and") || at("or") || at("not")){
+    fail(mType == kEND ? QString("unexpected end of rule") :
+	 "unexpected '" + mToken + "'");
+    return kNULL;
+  }
+
+  // A function call, or else the label of a parameter
+  QString lName = mToken;
+  bool lQuoted = mQuoted;
+  next();
+
+  if(!lQuoted && at("(")){
+    SteeringRules::Expr::Op lOp;
+    int lNumArgs = 2;
+    if(lName.lower() == "abs"){
+      lOp = SteeringRules::Expr::kABS;
+      lNumArgs = 1;
+    }
+    else if(lName.lower() == "min"){
+      lOp = SteeringRules::Expr::kMIN;
+    }
+    else if(lName.lower() == "max"){
+      lOp = SteeringRules::Expr::kMAX;
+    }
+    else{
+      fail("unknown function '" + lName + "'");
+      return kNULL;
+    }
+    next();
+
+    SteeringRules::Expr *lExpr = new SteeringRules::Expr(lOp);
+    if(!(lExpr->mLeft = parseOr()) ||
+       (lNumArgs == 2 && (!expect(",") || !(lExpr->mRight = parseOr()))) ||
+       !expect(")")){
+      delete lExpr;
+      return kNULL;
+    }
+    return lExpr;
+  }
+
+  SteeringRules::Expr *lExpr =
+    new SteeringRules::Expr(SteeringRules::Expr::kPARAM);
+  lExpr->mLabel = lName;
+  return lExpr;
+}
+
+//---------------------------------------------------------------------------
+SteeringRules::Expr::Expr(Op aOp, Expr *aLeft, Expr *aRight)
+  : mOp(aOp), mValue(0.0), mLeft(aLeft), mRight(aRight)
+{
+}
+
+//---------------------------------------------------------------------------
+SteeringRules::Expr::~Expr()
+{
+  delete mLeft;
+  delete mRight;
+}
+
+//---------------------------------------------------------------------------
+SteeringRules::Rule::Rule()
+  : mCondition(kNULL), mValue(kNULL), mEvery(1), mLastSeqNum(-1),
+    mTimesApplied(0)
+{
+}
+
+//---------------------------------------------------------------------------
+SteeringRules::Rule::~Rule()
+{
+  delete mCondition;
+  delete mValue;
+}
+
+//---------------------------------------------------------------------------
+SteeringRules::SteeringRules(const QString &aFileName, int aSimHandle,
+			     QMutex *aMutex)
+  : mFileName(aFileName), mSimHandle(aSimHandle), mMutexPtr(aMutex)
+{
+  REG_DBGCON("SteeringRules");
+  mArena = new MarshalArena();
+  mBuilder = new SteeringCommandBuilder(aSimHandle, aMutex, mArena);
+}
+
+//---------------------------------------------------------------------------
+SteeringRules::~SteeringRules()
+{
+  REG_DBGDST("SteeringRules");
+  qDeleteAll(mRules);
+  delete mBuilder;
+  delete mArena;
+}
+
+//---------------------------------------------------------------------------
+bool SteeringRules::load()
+{
+  QFile lFile(mFileName);
+  if(!lFile.open(QIODevice::ReadOnly)){
+    mError = "Failed to open " + mFileName;
+    return false;
+  }
+
+  QTextStream lStream(&lFile);
+  int lLineNum = 0;
+
+  qDeleteAll(mRules);
+  mRules.clear();
+  while(!lStream.atEnd()){
+    QString lLine = lStream.readLine().stripWhiteSpace();
+    lLineNum++;
+
+    if(lLine.isEmpty() || lLine.startsWith("#")){
+      continue;
+    }
+
+    Rule *lRule = new Rule();
+    RuleParser lParser(lLine);
+    lRule->mText = lLine;
+    if(!lParser.parseRule(lRule->mCondition, lRule->mTarget, lRule->mValue,
+			  lRule->mEvery)){
+      mError = QString("Line %1 of %2 isn't a steering rule (%3):\n%4").
+	arg(lLineNum).arg(mFileName).arg(lParser.errorString()).arg(lLine);
+      delete lRule;
+      qDeleteAll(mRules);
+      mRules.clear();
+      return false;
+    }
+    mRules.append(lRule);
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+QString SteeringRules::errorString() const
+{
+  return mError;
+}
+
+//---------------------------------------------------------------------------
+QString SteeringRules::fileName() const
+{
+  return mFileName;
+}
+
+//---------------------------------------------------------------------------
+int SteeringRules::count() const
+{
+  return mRules.count();
+}
+
+//---------------------------------------------------------------------------
+QString SteeringRules::describe() const
+{
+  QString lText;
+
+  for(int i=0; i<mRules.count(); i++){
+    const Rule *lRule = mRules[i];
+    lText += QString("%1: %2 - ").arg(i + 1).arg(lRule->mText);
+    if(lRule->mTimesApplied == 0){
+      lText += "not applied yet";
+    }
+    else{
+      lText += QString("applied %1 times, last at step %2").
+	arg(lRule->mTimesApplied).arg(lRule->mLastSeqNum);
+    }
+    if(!lRule->mLastProblem.isEmpty()){
+      lText += " (" + lRule->mLastProblem + ")";
+    }
+    lText += "\n";
+  }
+  return lText;
+}
+
+//---------------------------------------------------------------------------
+bool SteeringRules::evalExpr(const Expr *aExpr,
+			     const QHash<QString, double> &aValues,
+			     double &aResult, QString &aMissing)
+{
+  double lLeft = 0.0;
+  double lRight = 0.0;
+
+  switch(aExpr->mOp){
+
+  case Expr::kNUMBER:
+    aResult = aExpr->mValue;
+    return true;
+
+  case Expr::kPARAM:
+    if(!aValues.contains(aExpr->mLabel)){
+      aMissing = aExpr->mLabel;
+      return false;
+    }
+    aResult = aValues.value(aExpr->mLabel);
+    return true;
+
+  default:
+    break;
+  }
+
+  if(!evalExpr(aExpr->mLeft, aValues, lLeft, aMissing) ||
+     (aExpr->mRight &&
+      !evalExpr(aExpr->mRight, aValues, lRight, aMissing))){
+    return false;
+  }
+
+  switch(aExpr->mOp){
+  case Expr::kNEG: aResult = -lLeft;                 break;
+  case Expr::kNOT: aResult = (lLeft == 0.0);         break;
+  case Expr::kADD: aResult = lLeft + lRight;         break;
+  case Expr::kSUB: aResult = lLeft - lRight;         break;
+  case Expr::kMUL: aResult = lLeft * lRight;         break;
+  case Expr::kDIV: aResult = lLeft / lRight;         break;
+  case Expr::kLT:  aResult = (lLeft < lRight);       break;
+  case Expr::kLE:  aResult = (lLeft <= lRight);      break;
+  case Expr::kGT:  aResult = (lLeft > lRight);       break;
+  case Expr::kGE:  aResult = (lLeft >= lRight);      break;
+  case Expr::kEQ:  aResult = (lLeft == lRight);      break;
+  case Expr::kNE:  aResult = (lLeft != lRight);      break;
+  case Expr::kAND: aResult = (lLeft != 0.0 && lRight != 0.0); break;
+  case Expr::kOR:  aResult = (lLeft != 0.0 || lRight != 0.0); break;
+  case Expr::kABS: aResult = fabs(lLeft);            break;
+  case Expr::kMIN: aResult = qMin(lLeft, lRight);    break;
+  case Expr::kMAX: aResult = qMax(lLeft, lRight);    break;
+  default:         aResult = 0.0;                    break;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+void SteeringRules::getValues(QHash<QString, double> &aValues,
+			      QHash<QString, Steered> &aSteered)
+{
+  // Monitored then steered parameters - a steered parameter's value
+  // is used if both have the same label
+  for(int lSteered=0; lSteered<2; lSteered++){
+    int lNum = 0;
+    int lStatus;
+
+    mMutexPtr->lock();
+    lStatus = Get_param_number(mSimHandle,		//ReG library
+			       lSteered ? REG_TRUE : REG_FALSE, &lNum);
+    mMutexPtr->unlock();
+    if(lStatus != REG_SUCCESS){
+      THROWEXCEPTION("Get_param_number");
+    }
+    if(lNum == 0){
+      continue;
+    }
+
+    Param_details_struct *lDetails = mArena->paramDetails(lNum);
+    mMutexPtr->lock();
+    lStatus = Get_param_values(mSimHandle,		//ReG library
+			       lSteered ? REG_TRUE : REG_FALSE,
+			       lNum, lDetails);
+    mMutexPtr->unlock();
+    if(lStatus != REG_SUCCESS){
+      THROWEXCEPTION("Get_param_values");
+    }
+
+    for(int i=0; i<lNum; i++){
+      bool lOk = false;
+      double lVal = QString(lDetails[i].value).toDouble(&lOk);
+      if(lOk){
+	aValues.insert(QString(lDetails[i].label), lVal);
+      }
+
+      if(lSteered){
+	Steered lInfo;
+	lInfo.mHandle = lDetails[i].handle;
+	lInfo.mType = lDetails[i].type;
+	lInfo.mMin = lDetails[i].min_val;
+	lInfo.mMax = lDetails[i].max_val;
+	aSteered.insert(QString(lDetails[i].label), lInfo);
+      }
+    }
+  }
+}
+
+//---------------------------------------------------------------------------
+void SteeringRules::problem(Rule *aRule, int aIndex, int aSeqNum,
+			    const QString &aProblem, QStringList &aLog)
+{
+  if(aRule->mLastProblem != aProblem){
+    aRule->mLastProblem = aProblem;
+    aLog.append(QString("rule %1 step %2: %3").arg(aIndex + 1).
+		arg(aSeqNum).arg(aProblem));
+  }
+}
+
+//---------------------------------------------------------------------------
+int SteeringRules::evaluate(int aSeqNum, QStringList &aLog)
+{
+  QHash<QString, double> lValues;
+  QHash<QString, Steered> lSteered;
+  QStringList lApplied;
+  QList<Rule *> lAppliedRules;
+
+  try{
+    getValues(lValues, lSteered);
+
+    mBuilder->reset();
+    for(int i=0; i<mRules.count(); i++){
+      Rule *lRule = mRules[i];
+      double lCondition = 0.0;
+      double lNew = 0.0;
+      QString lMissing;
+
+      // rate limit
+      if(lRule->mLastSeqNum >= 0 &&
+	 aSeqNum - lRule->mLastSeqNum < lRule->mEvery){
+	continue;
+      }
+
+      if(!evalExpr(lRule->mCondition, lValues, lCondition, lMissing)){
+	problem(lRule, i, aSeqNum, "no value for " + lMissing, aLog);
+	continue;
+      }
+      if(lCondition == 0.0){
+	lRule->mLastProblem = QString::null;
+	continue;
+      }
+
+      if(!lSteered.contains(lRule->mTarget)){
+	problem(lRule, i, aSeqNum, "no steered parameter called " +
+		lRule->mTarget, aLog);
+	continue;
+      }
+      const Steered &lTarget = lSteered[lRule->mTarget];
+      if(lTarget.mType != REG_INT && lTarget.mType != REG_FLOAT &&
+	 lTarget.mType != REG_DBL){
+	problem(lRule, i, aSeqNum, lRule->mTarget + " is not a number",
+		aLog);
+	continue;
+      }
+      if(!evalExpr(lRule->mValue, lValues, lNew, lMissing)){
+	problem(lRule, i, aSeqNum, "no value for " + lMissing, aLog);
+	continue;
+      }
+
+      // catches NaN and infinity (e.g. from dividing by zero) - before
+      // clamping, which would turn infinity into a limit
+      if(!(lNew - lNew == 0.0)){
+	problem(lRule, i, aSeqNum, "value is not a finite number", aLog);
+	continue;
+      }
+      lRule->mLastProblem = QString::null;
+
+      bool lClamped = false;
+      lNew = Parameter::clampValue(lNew, lTarget.mMin, lTarget.mMax,
+				   &lClamped);
+
+      QString lNewStr = (lTarget.mType == REG_INT) ?
+	QString::number((int)floor(lNew + 0.5)) :
+	QString::number(lNew, 'g', 12);
+
+      // Nothing to do if it's already there (a clamped value often
+      // will be)
+      if(lValues.contains(lRule->mTarget) &&
+	 lNewStr.toDouble() == lValues.value(lRule->mTarget)){
+	continue;
+      }
+
+      mBuilder->addParamValue(lTarget.mHandle, lRule->mTarget, lNewStr);
+      lApplied.append(QString("rule %1 step %2: set %3 = %4%5").
+		      arg(i + 1).arg(aSeqNum).arg(lRule->mTarget).
+		      arg(lNewStr).arg(lClamped ? " (clamped)" : ""));
+      lAppliedRules.append(lRule);
+    }
+
+    mBuilder->send();
+  }
+  catch(SteererException StEx){
+    StEx.print();
+    aLog.append(QString("rules step %1: failed (%2)").arg(aSeqNum).
+		arg(StEx.getErrorMsg()));
+    return 0;
+  }
+
+  // Only counted once they've gone
+  for(int i=0; i<lAppliedRules.count(); i++){
+    lAppliedRules[i]->mLastSeqNum = aSeqNum;
+    lAppliedRules[i]->mTimesApplied++;
+  }
+  aLog += lApplied;
+
+  REG_DBGMSG1("SteeringRules::evaluate, values sent = ",
+	      lAppliedRules.count());
+  return lAppliedRules.count();
+}
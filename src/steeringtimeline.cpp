@@ -0,0 +1,404 @@
+/*
+  The RealityGrid Steerer
+
+  Copyright (c) 2002-2010, University of Manchester, United Kingdom.
+  All rights reserved.
+
+  This software is produced by Research Computing Services, University
+  of Manchester as part of the RealityGrid project and associated
+  follow on projects, funded by the EPSRC under grants GR/R67699/01,
+  GR/R67699/02, GR/T27488/01, EP/C536452/1, EP/D500028/1,
+  EP/F00561X/1.
+
+  LICENCE TERMS
+
+  Redistribution and use in source and binary forms, with or without
+  modification, are permitted provided that the following conditions
+  are met:
+
+    * Redistributions of source code must retain the above copyright
+       notice, this list of conditions and the following disclaimer.
+
+    * Redistributions in binary form must reproduce the above
+      copyright notice, this list of conditions and the following
+      disclaimer in the documentation and/or other materials provided
+      with the distribution.
+
+    * Neither the name of The University of Manchester nor the names
+      of its contributors may be used to endorse or promote products
+      derived from this software without specific prior written
+      permission.
+
+  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+  FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+  COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+  INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+  BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+  LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+  LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+  ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+  POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file steeringtimeline.cpp
+    @brief Implementation of the SteeringTimeline class - steering
+    actions sent by the comms thread at given sequence numbers */
+
+#include <qfile.h>
+#include <qtextstream.h>
+#include <qregexp.h>
+#include <qmutex.h>
+#include <QtAlgorithms>
+
+#include "buildconfig.h"
+#include "steeringtimeline.h"
+#include "steeringcommandbuilder.h"
+#include "marshalarena.h"
+#include "exception.h"
+#include "types.h"
+#include "debug.h"
+
+#include "ReG_Steer_Steerside.h"
+
+SteeringTimeline::SteeringTimeline(const QString &aFileName,
+				   int aSimHandle, QMutex *aMutex)
+  : mFileName(aFileName), mSimHandle(aSimHandle), mMutexPtr(aMutex),
+    mNext(0)
+{
+  REG_DBGCON("SteeringTimeline");
+  mArena = new MarshalArena();
+  mBuilder = new SteeringCommandBuilder(aSimHandle, aMutex, mArena);
+}
+
+//---------------------------------------------------------------------------
+SteeringTimeline::~SteeringTimeline()
+{
+  REG_DBGDST("SteeringTimeline");
+  delete mBuilder;
+  delete mArena;
+}
+
+//---------------------------------------------------------------------------
+bool SteeringTimeline::load()
+{
+  QFile lFile(mFileName);
+  if(!lFile.open(QIODevice::ReadOnly)){
+    mError = "Failed to open " + mFileName;
+    return false;
+  }
+
+  QTextStream lStream(&lFile);
+  int lLineNum = 0;
+
+  mActions.clear();
+  mNext = 0;
+  while(!lStream.atEnd()){
+    QString lLine = lStream.readLine().stripWhiteSpace();
+    lLineNum++;
+
+    if(lLine.isEmpty() || lLine.startsWith("#")){
+      continue;
+    }
+
+    Action lAction;
+    if(!parseLine(lLine, lAction)){
+      mError = QString("Line %1 of %2 isn't a steering action:\n%3").
+	arg(lLineNum).arg(mFileName).arg(lLine);
+      mActions.clear();
+      return false;
+    }
+    mActions.append(lAction);
+  }
+
+  // Actions due at the same step are sent in the order they're given
+  qStableSort(mActions.begin(), mActions.end(), seqNumLessThan);
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool SteeringTimeline::parseLine(const QString &aLine, Action &aAction)
+{
+  QRegExp lLineRx("^(\\d+)\\s+(\\S+)\\s*(.*)$");
+  if(!lLineRx.exactMatch(aLine)){
+    return false;
+  }
+
+  QString lVerb = lLineRx.cap(2).lower();
+  QString lArgs = lLineRx.cap(3);
+
+  aAction.mSeqNum = lLineRx.cap(1).toInt();
+  aAction.mCmdId = 0;
+  aAction.mFiredAt = -1;
+  aAction.mText = lVerb;
+  if(!lArgs.isEmpty()){
+    aAction.mText += " " + lArgs;
+  }
+
+  if(lVerb == "set" || lVerb == "frequency"){
+    // The label may contain spaces so the value is the last word
+    int lSplit = lArgs.findRev(QRegExp("\\s"));
+    if(lSplit < 0){
+      return false;
+    }
+    aAction.mType = (lVerb == "set") ? kSET : kFREQUENCY;
+    aAction.mLabel = lArgs.left(lSplit).stripWhiteSpace();
+    aAction.mValue = lArgs.mid(lSplit + 1);
+
+    if(aAction.mType == kFREQUENCY){
+      bool lOk = false;
+      if(aAction.mValue.toInt(&lOk) < 0 || !lOk){
+	return false;
+      }
+    }
+    return true;
+  }
+
+  if(!lArgs.isEmpty()){
+    return false;
+  }
+
+  aAction.mType = kCOMMAND;
+  if(lVerb == "pause"){
+    aAction.mCmdId = REG_STR_PAUSE;
+  }
+  else if(lVerb == "resume"){
+    aAction.mCmdId = REG_STR_RESUME;
+  }
+  else if(lVerb == "stop"){
+    aAction.mCmdId = REG_STR_STOP;
+  }
+  else{
+    return false;
+  }
+  return true;
+}
+
+//---------------------------------------------------------------------------
+bool SteeringTimeline::seqNumLessThan(const Action &aFirst,
+				      const Action &aSecond)
+{
+  return aFirst.mSeqNum < aSecond.mSeqNum;
+}
+
+//---------------------------------------------------------------------------
+QString SteeringTimeline::errorString() const
+{
+  return mError;
+}
+
+//---------------------------------------------------------------------------
+QString SteeringTimeline::fileName() const
+{
+  return mFileName;
+}
+
+//---------------------------------------------------------------------------
+int SteeringTimeline::count() const
+{
+  return mActions.count();
+}
+
+//---------------------------------------------------------------------------
+int SteeringTimeline::pendingCount() const
+{
+  return mActions.count() - mNext;
+}
+
+//---------------------------------------------------------------------------
+bool SteeringTimeline::isDue(int aSeqNum) const
+{
+  return mNext < mActions.count() && mActions[mNext].mSeqNum <= aSeqNum;
+}
+
+//---------------------------------------------------------------------------
+QString SteeringTimeline::describe() const
+{
+  QString lText;
+
+  for(int i=0; i<mActions.count(); i++){
+    const Action &lAction = mActions[i];
+    lText += QString("%1: %2").arg(lAction.mSeqNum).arg(lAction.mText);
+    if(lAction.mFiredAt < 0){
+      lText += " - pending\n";
+    }
+    else{
+      lText += QString(" - %1 (step %2)\n").arg(lAction.mResult).
+	arg(lAction.mFiredAt);
+    }
+  }
+  return lText;
+}
+
+//---------------------------------------------------------------------------
+QHash<QString, int> SteeringTimeline::handlesByLabel(ActionType aType,
+						     bool aChkType)
+{
+  QHash<QString, int> lHandles;
+  int lNum = 0;
+  int lStatus;
+
+  if(aType == kSET){
+    mMutexPtr->lock();
+    if(Get_param_number(mSimHandle, REG_TRUE, &lNum)	//ReG library
+       != REG_SUCCESS){
+      mMutexPtr->unlock();
+      THROWEXCEPTION("Get_param_number");
+    }
+    mMutexPtr->unlock();
+
+    if(lNum > 0){
+      Param_details_struct *lDetails = mArena->paramDetails(lNum);
+
+      mMutexPtr->lock();
+      lStatus = Get_param_values(mSimHandle, REG_TRUE,	//ReG library
+				 lNum, lDetails);
+      mMutexPtr->unlock();
+      if(lStatus != REG_SUCCESS){
+	THROWEXCEPTION("Get_param_values");
+      }
+
+      for(int i=0; i<lNum; i++){
+	lHandles.insert(QString(lDetails[i].label), lDetails[i].handle);
+      }
+    }
+    return lHandles;
+  }
+
+  mMutexPtr->lock();
+  lStatus = aChkType ?
+    Get_chktype_number(mSimHandle, &lNum) :		//ReG library
+    Get_iotype_number(mSimHandle, &lNum);		//ReG library
+  mMutexPtr->unlock();
+  if(lStatus != REG_SUCCESS){
+    THROWEXCEPTION("Get_iotype_number");
+  }
+
+  if(lNum > 0){
+    int *lIds = mArena->ints(MarshalArena::kHANDLES, lNum);
+    int *lTypes = mArena->ints(MarshalArena::kTYPES, lNum);
+    int *lFreqs = mArena->ints(MarshalArena::kVALUES, lNum);
+    char **lLabels = mArena->strings(MarshalArena::kLABELS, lNum);
+
+    mMutexPtr->lock();
+    lStatus = aChkType ?
+      Get_chktypes(mSimHandle, lNum, lIds, lLabels,	//ReG library
+		   lTypes, lFreqs) :
+      Get_iotypes(mSimHandle, lNum, lIds, lLabels,	//ReG library
+		  lTypes, lFreqs);
+    mMutexPtr->unlock();
+    if(lStatus != REG_SUCCESS){
+      THROWEXCEPTION("Get_iotypes");
+    }
+
+    for(int i=0; i<lNum; i++){
+      lHandles.insert(QString(lLabels[i]), lIds[i]);
+    }
+  }
+  return lHandles;
+}
+
+//---------------------------------------------------------------------------
+int SteeringTimeline::fire(int aSeqNum, QStringList &aLog, QList<int> &aCmds)
+{
+  int lFirst = mNext;
+  bool lNeedParams = false;
+  bool lNeedTypes = false;
+
+  while(isDue(aSeqNum)){
+    mActions[mNext].mFiredAt = aSeqNum;
+    lNeedParams |= (mActions[mNext].mType == kSET);
+    lNeedTypes |= (mActions[mNext].mType == kFREQUENCY);
+    mNext++;
+  }
+
+  if(mNext == lFirst){
+    return 0;
+  }
+
+  int lSent = 0;
+  QList<int> lCmds;
+
+  try{
+    // Labels are looked up now so that parameters and IOTypes
+    // registered after the timeline was loaded can be steered
+    QHash<QString, int> lParams, lIOTypes, lChkTypes;
+    if(lNeedParams){
+      lParams = handlesByLabel(kSET, false);
+    }
+    if(lNeedTypes){
+      lIOTypes = handlesByLabel(kFREQUENCY, false);
+      lChkTypes = handlesByLabel(kFREQUENCY, true);
+    }
+
+    mBuilder->reset();
+    for(int i=lFirst; i<mNext; i++){
+      Action &lAction = mActions[i];
+
+      switch(lAction.mType){
+
+      case kSET:
+	if(!lParams.contains(lAction.mLabel)){
+	  lAction.mResult = "skipped, no steered parameter called " +
+	    lAction.mLabel;
+	  continue;
+	}
+	mBuilder->addParamValue(lParams.value(lAction.mLabel),
+				lAction.mLabel, lAction.mValue);
+	break;
+
+      case kFREQUENCY:
+	if(lIOTypes.contains(lAction.mLabel)){
+	  mBuilder->addFrequency(false, lIOTypes.value(lAction.mLabel),
+				 lAction.mValue.toInt());
+	}
+	else if(lChkTypes.contains(lAction.mLabel)){
+	  mBuilder->addFrequency(true, lChkTypes.value(lAction.mLabel),
+				 lAction.mValue.toInt());
+	}
+	else{
+	  lAction.mResult = "skipped, no IOType or ChkType called " +
+	    lAction.mLabel;
+	  continue;
+	}
+	break;
+
+      case kCOMMAND:
+	mBuilder->addCommand(lAction.mCmdId, " ");
+	lCmds.append(lAction.mCmdId);
+	break;
+      }
+
+      lAction.mResult = "sent";
+      lSent++;
+    }
+
+    mBuilder->send();
+  }
+  catch(SteererException StEx){
+    StEx.print();
+    lSent = 0;
+    lCmds.clear();
+    for(int i=lFirst; i<mNext; i++){
+      if(mActions[i].mResult.isEmpty() || mActions[i].mResult == "sent"){
+	mActions[i].mResult = QString("failed (") + StEx.getErrorMsg() + ")";
+      }
+    }
+  }
+
+  for(int i=lFirst; i<mNext; i++){
+    const Action &lAction = mActions[i];
+    QString lEntry = QString("timeline step %1: %2 - %3").arg(aSeqNum).
+      arg(lAction.mText).arg(lAction.mResult);
+    if(lAction.mSeqNum != aSeqNum){
+      lEntry += QString(" (due at %1)").arg(lAction.mSeqNum);
+    }
+    aLog.append(lEntry);
+  }
+  aCmds += lCmds;
+
+  REG_DBGMSG1("SteeringTimeline::fire, actions sent = ", lSent);
+  return lSent;
+}
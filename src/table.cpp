@@ -61,7 +61,7 @@
 
 Table::Table(QWidget *aParent, const char *aName, int aSimHandle)
   : Q3Table(aParent, aName),  mSimHandle(aSimHandle), mInitNumRows(0),
-    mMaxRowIndex(0), mAppAttached(true)
+    mMaxRowIndex(0), mAppAttached(true), mCommandBuilder(NULL)
 {
   REG_DBGCON("Table");
 
@@ -131,3 +131,15 @@ Table::getSimHandle() const
 {
   return mSimHandle;
 }
+
+void
+Table::setCommandBuilder(SteeringCommandBuilder *aBuilder)
+{
+  mCommandBuilder = aBuilder;
+}
+
+SteeringCommandBuilder *
+Table::commandBuilder() const
+{
+  return mCommandBuilder;
+}